@@ -0,0 +1,164 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+
+#include "ImageDecoderBenchmark.h"
+#include "../Texture/ImageDecoder.h"
+#include "../Utility/MappedFile.h"
+
+namespace Benchmark {
+
+	static const int MEASURED_RUNS = 5;
+
+	// what one backend did over the images of one format
+	struct Totals {
+		size_t fileBytes = 0;
+		size_t pixelBytes = 0;
+		double milliseconds = 0.0;
+	};
+
+	// best of a few runs, in milliseconds
+	template <typename Function>
+	static double measureMs(Function function) {
+		double best = 0.0;
+		for (int run = 0; run < MEASURED_RUNS; run++) {
+			auto start = std::chrono::steady_clock::now();
+			function();
+			double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			if (run == 0 || ms < best) {
+				best = ms;
+			}
+		}
+		return best;
+	}
+
+	static bool isJpeg(const std::string& path) {
+		std::string extension = std::filesystem::path(path).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)tolower(c); });
+		return extension == ".jpg" || extension == ".jpeg";
+	}
+
+	std::vector<std::string> findImages(const std::string& directory) {
+		std::vector<std::string> paths;
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+			std::string extension = entry.path().extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)tolower(c); });
+			if (entry.is_regular_file() && (extension == ".jpg" || extension == ".jpeg" || extension == ".png")) {
+				paths.push_back(entry.path().generic_string());
+			}
+		}
+		std::sort(paths.begin(), paths.end());
+		return paths;
+	}
+
+	static void printRate(const char* name, size_t fileBytes, size_t pixelBytes, double ms) {
+		double seconds = ms / 1000.0;
+		std::cout << std::setw(16) << name << std::setw(10) << std::setprecision(2) << ms << std::setw(12) << std::setprecision(1)
+			<< fileBytes / (1024.0 * 1024.0) / seconds << std::setw(14) << pixelBytes / (1024.0 * 1024.0) / seconds;
+	}
+
+	// decodes one image with every backend that reads it and compares the results with stb's
+	static bool measureImage(const std::string& path, Totals (&totals)[2][ImageDecoder::BACKEND_COUNT]) {
+		MappedFile file;
+		if (!file.open(path.c_str())) {
+			return false;
+		}
+		ImageDecoder::Image reference;
+		std::string error;
+		if (!ImageDecoder::decode(ImageDecoder::BACKEND_STB, file.data(), file.size(), reference, error)) {
+			std::cout << "ERROR::BENCHMARK::IMAGE_DECODE_FAILED " << path << " (" << error << ")" << std::endl;
+			return false;
+		}
+		bool lossy = isJpeg(path);
+		std::cout << path << " (" << reference.width << "x" << reference.height << ", " << reference.channels << " channels, "
+			<< file.size() / 1024 << " KB, best of " << MEASURED_RUNS << ")" << std::endl;
+		bool passed = true;
+		for (int backend = 0; backend < ImageDecoder::BACKEND_COUNT; backend++) {
+			if (!ImageDecoder::canDecode((ImageDecoder::Backend)backend, file.data(), file.size())) {
+				continue;
+			}
+			ImageDecoder::Image image;
+			bool decoded = true;
+			double ms = measureMs([&]() {
+				decoded = ImageDecoder::decode((ImageDecoder::Backend)backend, file.data(), file.size(), image, error) && decoded;
+			});
+			if (!decoded) {
+				// a file the fast path refuses still loads, ImageDecoder::decode falls back to stb
+				std::cout << std::setw(16) << ImageDecoder::getName((ImageDecoder::Backend)backend) << "  refused (" << error << ")" << std::endl;
+				continue;
+			}
+			Totals& total = totals[lossy ? 0 : 1][backend];
+			total.fileBytes += file.size();
+			total.pixelBytes += image.pixels.size();
+			total.milliseconds += ms;
+			printRate(ImageDecoder::getName((ImageDecoder::Backend)backend), file.size(), image.pixels.size(), ms);
+
+			// same layout always, same pixels for lossless files
+			if (image.width != reference.width || image.height != reference.height || image.channels != reference.channels) {
+				std::cout << "  LAYOUT DIFFERS (" << image.width << "x" << image.height << ", " << image.channels << " channels)" << std::endl;
+				passed = false;
+				continue;
+			}
+			int largest = 0;
+			double sum = 0.0;
+			for (size_t i = 0; i < image.pixels.size(); i++) {
+				int difference = std::abs((int)image.pixels[i] - reference.pixels[i]);
+				largest = std::max(largest, difference);
+				sum += difference;
+			}
+			if (largest == 0) {
+				std::cout << "  identical" << std::endl;
+			}
+			else {
+				std::cout << "  max difference " << largest << ", mean " << std::setprecision(3) << sum / image.pixels.size() << std::endl;
+				passed = passed && lossy;
+			}
+		}
+		return passed;
+	}
+
+	bool runImageDecoders(const std::vector<std::string>& paths) {
+		std::cout << "Image decoder benchmark, backends:";
+		for (int backend = 0; backend < ImageDecoder::BACKEND_COUNT; backend++) {
+			std::cout << " " << ImageDecoder::getName((ImageDecoder::Backend)backend)
+				<< (ImageDecoder::isAvailable((ImageDecoder::Backend)backend) ? "" : " (not built)");
+		}
+		std::cout << std::endl;
+		std::cout << std::fixed << std::setw(16) << "backend" << std::setw(10) << "ms" << std::setw(12) << "file MB/s"
+			<< std::setw(14) << "pixel MB/s" << std::endl;
+		// JPEG and PNG per backend
+		Totals totals[2][ImageDecoder::BACKEND_COUNT];
+		bool passed = !paths.empty();
+		for (const std::string& path : paths) {
+			passed = measureImage(path, totals) && passed;
+		}
+
+		const char* formats[2] = { "JPEG", "PNG" };
+		for (int format = 0; format < 2; format++) {
+			const Totals& stb = totals[format][ImageDecoder::BACKEND_STB];
+			if (stb.milliseconds == 0.0) {
+				continue;
+			}
+			std::cout << formats[format] << " corpus" << std::endl;
+			for (int backend = 0; backend < ImageDecoder::BACKEND_COUNT; backend++) {
+				const Totals& total = totals[format][backend];
+				if (total.milliseconds == 0.0) {
+					continue;
+				}
+				printRate(ImageDecoder::getName((ImageDecoder::Backend)backend), total.fileBytes, total.pixelBytes, total.milliseconds);
+				// refused files drop out of a backend's totals, the speedup is only meaningful when they match
+				std::cout << std::setw(10) << std::setprecision(2) << stb.milliseconds / total.milliseconds << "x"
+					<< (total.fileBytes == stb.fileBytes ? "" : " (fewer files)") << std::endl;
+			}
+		}
+		std::cout.unsetf(std::ios::floatfield);
+		std::cout << std::setprecision(6);
+		return passed;
+	}
+}
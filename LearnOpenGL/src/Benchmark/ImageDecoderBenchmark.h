@@ -0,0 +1,19 @@
+#ifndef IMAGE_DECODER_BENCHMARK_H
+#define IMAGE_DECODER_BENCHMARK_H
+
+#include <string>
+#include <vector>
+
+namespace Benchmark {
+
+	// every .jpg, .jpeg and .png file in the directory, sorted
+	std::vector<std::string> findImages(const std::string& directory);
+
+	// decodes every image from memory with each backend that reads it and prints MB/s of file and of decoded
+	// pixels, per image and summed over the corpus per format. returns false if an image can not be decoded or a
+	// backend returns another layout than stb_image (or other pixels, for PNG)
+	bool runImageDecoders(const std::vector<std::string>& paths);
+
+}
+
+#endif // IMAGE_DECODER_BENCHMARK_H
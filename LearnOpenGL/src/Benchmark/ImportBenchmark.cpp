@@ -0,0 +1,175 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <filesystem>
+
+#include "ImportBenchmark.h"
+#include "../Mesh/Mesh.h"
+#include "../Mesh/ObjImporter.h"
+#include "../Mesh/GltfImporter.h"
+#include "../Utility/ThreadPool.h"
+
+namespace Benchmark {
+
+	static const int MEASURED_RUNS = 3;
+
+	static StandardVertex makeTerrainVertex(unsigned int x, unsigned int y, unsigned int gridSize) {
+		float u = (float)x / gridSize;
+		float v = (float)y / gridSize;
+		StandardVertex vertex = {
+			{ u * 2.0f - 1.0f, v * 2.0f - 1.0f, 0.1f * std::sin(u * 12.0f) * std::cos(v * 9.0f) },
+			{ u, v, 1.0f - u },
+			{ u, v }
+		};
+		return vertex;
+	}
+
+	// indexed grid, the way a scanner or terrain exporter lays it out
+	static void makeTerrain(unsigned int gridSize, Mesh& mesh) {
+		unsigned int side = gridSize + 1;
+		mesh.vertices.resize((size_t)side * side);
+		for (unsigned int y = 0; y < side; y++) {
+			for (unsigned int x = 0; x < side; x++) {
+				mesh.vertices[(size_t)y * side + x] = makeTerrainVertex(x, y, gridSize);
+			}
+		}
+		mesh.indices.clear();
+		mesh.indices.reserve((size_t)gridSize * gridSize * 6);
+		for (unsigned int y = 0; y < gridSize; y++) {
+			for (unsigned int x = 0; x < gridSize; x++) {
+				unsigned int corner = y * side + x;
+				const unsigned int quad[6] = { corner, corner + 1, corner + side, corner + 1, corner + side + 1, corner + side };
+				mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+			}
+		}
+	}
+
+	// every vertex carries a colour and a texture coordinate of the same index, so f lines are "i/i i/i i/i"
+	static bool writeObj(const std::string& path, const Mesh& mesh) {
+		std::ofstream file(path, std::ios::binary);
+		char line[256];
+		for (const StandardVertex& vertex : mesh.vertices) {
+			int length = snprintf(line, sizeof(line), "v %.6f %.6f %.6f %.4f %.4f %.4f\n", vertex.position[0], vertex.position[1],
+				vertex.position[2], vertex.color[0], vertex.color[1], vertex.color[2]);
+			file.write(line, length);
+		}
+		for (const StandardVertex& vertex : mesh.vertices) {
+			int length = snprintf(line, sizeof(line), "vt %.6f %.6f\n", vertex.texCoord[0], vertex.texCoord[1]);
+			file.write(line, length);
+		}
+		for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+			unsigned int a = mesh.indices[i] + 1, b = mesh.indices[i + 1] + 1, c = mesh.indices[i + 2] + 1;
+			int length = snprintf(line, sizeof(line), "f %u/%u %u/%u %u/%u\n", a, a, b, b, c, c);
+			file.write(line, length);
+		}
+		return (bool)file;
+	}
+
+	// one interleaved vertex buffer view and one index view in a separate .bin
+	static bool writeGltf(const std::string& path, const std::string& binaryPath, const Mesh& mesh) {
+		size_t vertexBytes = mesh.vertices.size() * sizeof(StandardVertex);
+		size_t indexBytes = mesh.indices.size() * sizeof(unsigned int);
+		std::ofstream binary(binaryPath, std::ios::binary);
+		binary.write((const char*)mesh.vertices.data(), (std::streamsize)vertexBytes);
+		binary.write((const char*)mesh.indices.data(), (std::streamsize)indexBytes);
+
+		std::string binaryName = std::filesystem::path(binaryPath).filename().string();
+		std::ofstream file(path, std::ios::binary);
+		file << "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+			<< "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"COLOR_0\":1,\"TEXCOORD_0\":2},\"indices\":3}]}],"
+			<< "\"buffers\":[{\"uri\":\"" << binaryName << "\",\"byteLength\":" << vertexBytes + indexBytes << "}],"
+			<< "\"bufferViews\":[{\"buffer\":0,\"byteLength\":" << vertexBytes << ",\"byteStride\":" << sizeof(StandardVertex) << "},"
+			<< "{\"buffer\":0,\"byteOffset\":" << vertexBytes << ",\"byteLength\":" << indexBytes << "}],"
+			<< "\"accessors\":["
+			<< "{\"bufferView\":0,\"byteOffset\":" << offsetof(StandardVertex, position) << ",\"componentType\":5126,\"count\":" << mesh.vertices.size() << ",\"type\":\"VEC3\"},"
+			<< "{\"bufferView\":0,\"byteOffset\":" << offsetof(StandardVertex, color) << ",\"componentType\":5126,\"count\":" << mesh.vertices.size() << ",\"type\":\"VEC3\"},"
+			<< "{\"bufferView\":0,\"byteOffset\":" << offsetof(StandardVertex, texCoord) << ",\"componentType\":5126,\"count\":" << mesh.vertices.size() << ",\"type\":\"VEC2\"},"
+			<< "{\"bufferView\":1,\"componentType\":5125,\"count\":" << mesh.indices.size() << ",\"type\":\"SCALAR\"}]}";
+		return (bool)file && (bool)binary;
+	}
+
+	static bool sameMesh(const Mesh& a, const Mesh& b) {
+		return a.vertices.size() == b.vertices.size() && a.indices == b.indices && a.submeshes.size() == b.submeshes.size() &&
+			memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(StandardVertex)) == 0;
+	}
+
+	typedef bool (*ImportFunction)(const char* path, Mesh& mesh, ThreadPool& pool);
+
+	// imports with growing thread counts, every result is compared against the single threaded one
+	static bool measureImporter(const char* name, ImportFunction import, const std::string& path, size_t bytes, unsigned int maxThreads) {
+		std::vector<unsigned int> threadCounts;
+		for (unsigned int threads = 1; threads < maxThreads; threads *= 2) {
+			threadCounts.push_back(threads);
+		}
+		threadCounts.push_back(maxThreads);
+
+		Mesh reference;
+		bool identical = true;
+		double singleThreadedMs = 0.0;
+		for (unsigned int threads : threadCounts) {
+			ThreadPool pool(threads);
+			double best = 0.0;
+			Mesh mesh;
+			for (int run = 0; run < MEASURED_RUNS; run++) {
+				auto start = std::chrono::steady_clock::now();
+				if (!import(path.c_str(), mesh, pool)) {
+					return false;
+				}
+				double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				if (run == 0 || ms < best) {
+					best = ms;
+				}
+			}
+			if (threads == 1) {
+				reference = std::move(mesh);
+				singleThreadedMs = best;
+			}
+			else if (!sameMesh(mesh, reference)) {
+				std::cout << "ERROR::BENCHMARK::IMPORT_MISMATCH " << name << " with " << threads << " threads" << std::endl;
+				identical = false;
+			}
+			std::cout << std::setw(6) << name << std::setw(9) << threads << std::setw(12) << std::fixed << std::setprecision(2) << best
+				<< std::setw(12) << std::setprecision(1) << bytes / (1024.0 * 1024.0) / (best / 1000.0)
+				<< std::setw(10) << std::setprecision(2) << singleThreadedMs / best << "x" << std::endl;
+		}
+		return identical;
+	}
+
+	bool runImport(unsigned int gridSize, unsigned int maxThreads) {
+		if (maxThreads == 0) {
+			maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		Mesh terrain;
+		makeTerrain(gridSize, terrain);
+		std::filesystem::path directory = std::filesystem::temp_directory_path();
+		std::string objPath = (directory / "learnopengl_import_benchmark.obj").string();
+		std::string gltfPath = (directory / "learnopengl_import_benchmark.gltf").string();
+		std::string binaryPath = (directory / "learnopengl_import_benchmark.bin").string();
+		if (!writeObj(objPath, terrain) || !writeGltf(gltfPath, binaryPath, terrain)) {
+			std::cout << "ERROR::BENCHMARK::WRITE_FAILED " << directory.string() << std::endl;
+			return false;
+		}
+		size_t objBytes = (size_t)std::filesystem::file_size(objPath);
+		size_t gltfBytes = (size_t)(std::filesystem::file_size(gltfPath) + std::filesystem::file_size(binaryPath));
+
+		std::cout << "Import benchmark (" << terrain.indices.size() / 3 << " triangles, OBJ " << objBytes / (1024 * 1024)
+			<< " MB, glTF " << gltfBytes / (1024 * 1024) << " MB, best of " << MEASURED_RUNS << ")" << std::endl;
+		std::cout << std::setw(6) << "format" << std::setw(9) << "threads" << std::setw(12) << "ms"
+			<< std::setw(12) << "MB/s" << std::setw(11) << "speedup" << std::endl;
+		bool passed = measureImporter("obj", ObjImporter::load, objPath, objBytes, maxThreads);
+		passed = measureImporter("gltf", GltfImporter::load, gltfPath, gltfBytes, maxThreads) && passed;
+
+		std::filesystem::remove(objPath);
+		std::filesystem::remove(gltfPath);
+		std::filesystem::remove(binaryPath);
+		return passed;
+	}
+}
@@ -0,0 +1,13 @@
+#ifndef IMPORT_BENCHMARK_H
+#define IMPORT_BENCHMARK_H
+
+namespace Benchmark {
+
+	// writes a gridSize x gridSize terrain as OBJ and as glTF with a .bin buffer into the temp directory, then
+	// imports both with 1, 2, 4 ... threads up to maxThreads (0 for the hardware thread count) and prints MB/s.
+	// returns false if a thread count produced a different mesh than the single threaded import
+	bool runImport(unsigned int gridSize, unsigned int maxThreads);
+
+}
+
+#endif // IMPORT_BENCHMARK_H
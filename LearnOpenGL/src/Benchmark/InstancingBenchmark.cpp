@@ -0,0 +1,131 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+
+#include "InstancingBenchmark.h"
+#include "../Renderer/GLState.h"
+
+namespace Benchmark {
+
+	// the per draw path is capped, a million draw calls per frame would take minutes to measure
+	static const unsigned int PER_DRAW_LIMIT = 100000;
+	static const int MEASURED_FRAMES = 5;
+
+	// lay count instances out on a square grid covering the screen
+	void makeInstanceGrid(unsigned int count, std::vector<InstanceData>& instances) {
+		instances.resize(count);
+		unsigned int side = (unsigned int)std::ceil(std::sqrt((double)count));
+		float cell = 2.0f / side;
+		for (unsigned int i = 0; i < count; i++) {
+			InstanceData& instance = instances[i];
+			instance.offset[0] = -1.0f + cell * (i % side + 0.5f);
+			instance.offset[1] = -1.0f + cell * (i / side + 0.5f);
+			// the hexagon is one unit wide
+			instance.scale = cell * 0.9f;
+			instance.layer = (float)(i % 2);
+			instance.color[0] = (unsigned char)(128 + (i * 37) % 128);
+			instance.color[1] = (unsigned char)(128 + (i * 59) % 128);
+			instance.color[2] = (unsigned char)(128 + (i * 83) % 128);
+			instance.color[3] = 255;
+			instance.texRect[0] = instance.texRect[1] = 0;
+			instance.texRect[2] = instance.texRect[3] = 65535;
+		}
+	}
+
+	// give the instances the atlas images in turn through their layer and texRect
+	void assignAtlasRegions(const TextureAtlas& atlas, std::vector<InstanceData>& instances) {
+		if (atlas.getRegionCount() == 0) {
+			return;
+		}
+		for (size_t i = 0; i < instances.size(); i++) {
+			const TextureAtlas::Region& region = atlas.getRegion(i % atlas.getRegionCount());
+			instances[i].layer = (float)region.layer;
+			for (int axis = 0; axis < 2; axis++) {
+				instances[i].texRect[axis] = (unsigned short)(region.offset[axis] * 65535.0f + 0.5f);
+				instances[i].texRect[2 + axis] = (unsigned short)(region.scale[axis] * 65535.0f + 0.5f);
+			}
+		}
+	}
+
+	// average wall time of one frame, glFinish makes sure the GPU work is included
+	template <typename DrawFunction>
+	static double measureFrameMs(DrawFunction drawFrame) {
+		// first frame warms caches and driver state up
+		glClear(GL_COLOR_BUFFER_BIT);
+		drawFrame();
+		glFinish();
+		auto start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < MEASURED_FRAMES; frame++) {
+			glClear(GL_COLOR_BUFFER_BIT);
+			drawFrame();
+		}
+		glFinish();
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / MEASURED_FRAMES;
+	}
+
+	// draws 1, 10, 100 ... maxInstances hexagons once with one draw call per hexagon and once
+	// with a single glDrawElementsInstanced, and prints instances/sec for both
+	void runInstancing(const Shader& instancedProgram, unsigned int instancedVAO, InstanceBuffer& instanceBuffer,
+		const TextureAtlas& atlas, unsigned int indexCount, GLenum indexType, unsigned int maxInstances) {
+		std::cout << "Instancing benchmark (" << MEASURED_FRAMES << " frames per size)" << std::endl;
+		std::cout << std::setw(10) << "instances" << std::setw(16) << "per draw ms" << std::setw(18) << "per draw inst/s"
+			<< std::setw(16) << "instanced ms" << std::setw(18) << "instanced inst/s" << std::setw(10) << "speedup" << std::endl;
+
+		GLState::useProgram(instancedProgram.getID());
+		GLState::bindVertexArray(instancedVAO);
+		// both paths sample the atlas like the render loop does, so the fragment work is the same
+		GLState::bindTexture(0, GL_TEXTURE_2D_ARRAY, atlas.getID());
+		std::vector<InstanceData> instances;
+
+		for (unsigned int count = 1; count <= maxInstances; count *= 10) {
+			makeInstanceGrid(count, instances);
+			assignAtlasRegions(atlas, instances);
+			instanceBuffer.upload(instances);
+
+			double instancedMs = measureFrameMs([&]() {
+				glDrawElementsInstanced(GL_TRIANGLES, indexCount, indexType, 0, count);
+			});
+
+			double perDrawMs = -1.0;
+			if (count <= PER_DRAW_LIMIT) {
+				// with the arrays disabled the shader reads the current generic attribute values,
+				// so the same program is fed one glVertexAttrib* set per draw call
+				for (unsigned int location = InstanceBuffer::FIRST_LOCATION; location < InstanceBuffer::FIRST_LOCATION + InstanceLayout::attributeCount; location++) {
+					glDisableVertexAttribArray(location);
+				}
+				perDrawMs = measureFrameMs([&]() {
+					const unsigned int first = InstanceBuffer::FIRST_LOCATION;
+					for (const InstanceData& instance : instances) {
+						glVertexAttrib2f(first + 0, instance.offset[0], instance.offset[1]);
+						glVertexAttrib1f(first + 1, instance.scale);
+						glVertexAttrib1f(first + 2, instance.layer);
+						glVertexAttrib4Nub(first + 3, instance.color[0], instance.color[1], instance.color[2], instance.color[3]);
+						glVertexAttrib4Nusv(first + 4, instance.texRect);
+						glDrawElements(GL_TRIANGLES, indexCount, indexType, 0);
+					}
+				});
+				for (unsigned int location = InstanceBuffer::FIRST_LOCATION; location < InstanceBuffer::FIRST_LOCATION + InstanceLayout::attributeCount; location++) {
+					glEnableVertexAttribArray(location);
+				}
+			}
+
+			std::cout << std::fixed << std::setprecision(3) << std::setw(10) << count;
+			if (perDrawMs >= 0.0) {
+				std::cout << std::setw(16) << perDrawMs << std::setw(18) << std::setprecision(0) << count / (perDrawMs / 1000.0);
+			}
+			else {
+				std::cout << std::setw(16) << "-" << std::setw(18) << "-";
+			}
+			std::cout << std::setprecision(3) << std::setw(16) << instancedMs
+				<< std::setw(18) << std::setprecision(0) << count / (instancedMs / 1000.0);
+			if (perDrawMs >= 0.0) {
+				std::cout << std::setw(9) << std::setprecision(1) << perDrawMs / instancedMs << "x";
+			}
+			std::cout << std::endl;
+		}
+		std::cout.unsetf(std::ios::floatfield);
+		std::cout << std::setprecision(6);
+	}
+
+}
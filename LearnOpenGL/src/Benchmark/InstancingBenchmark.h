@@ -0,0 +1,28 @@
+#ifndef INSTANCING_BENCHMARK_H
+#define INSTANCING_BENCHMARK_H
+
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "../ShaderManager/Shader.h"
+#include "../Renderer/InstanceBuffer.h"
+#include "../Texture/TextureAtlas.h"
+
+namespace Benchmark {
+
+	// lay count instances out on a square grid covering the screen
+	void makeInstanceGrid(unsigned int count, std::vector<InstanceData>& instances);
+
+	// give the instances the atlas images in turn through their layer and texRect
+	void assignAtlasRegions(const TextureAtlas& atlas, std::vector<InstanceData>& instances);
+
+	// draws 1, 10, 100 ... maxInstances hexagons once with one draw call per hexagon and once
+	// with a single glDrawElementsInstanced, and prints instances/sec for both.
+	// instancedVAO must have the mesh and the instance buffer attached, atlas is what the program samples
+	void runInstancing(const Shader& instancedProgram, unsigned int instancedVAO, InstanceBuffer& instanceBuffer,
+		const TextureAtlas& atlas, unsigned int indexCount, GLenum indexType, unsigned int maxInstances);
+
+}
+
+#endif // INSTANCING_BENCHMARK_H
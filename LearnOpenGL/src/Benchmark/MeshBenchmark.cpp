@@ -0,0 +1,97 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+#include "MeshBenchmark.h"
+#include "../Mesh/MeshOptimizer.h"
+
+namespace Benchmark {
+
+	// vertex on a gently rolling height field, everything is derived from the grid position so
+	// the copies of one corner are bit identical and can be welded
+	static StandardVertex makeGridVertex(unsigned int x, unsigned int y, unsigned int gridSize) {
+		float u = (float)x / gridSize;
+		float v = (float)y / gridSize;
+		StandardVertex vertex = {
+			{ u * 2.0f - 1.0f, v * 2.0f - 1.0f, 0.1f * std::sin(u * 12.0f) * std::cos(v * 9.0f) },
+			{ u, v, 1.0f - u },
+			{ u, v }
+		};
+		return vertex;
+	}
+
+	static void makeTriangleSoup(unsigned int gridSize, Mesh& mesh) {
+		std::vector<unsigned int> quads(gridSize * gridSize);
+		for (unsigned int i = 0; i < quads.size(); i++) {
+			quads[i] = i;
+		}
+		// fixed seed, what an exporter that does not care about order would produce
+		unsigned int state = 12345u;
+		for (size_t i = quads.size(); i > 1; i--) {
+			state = state * 1664525u + 1013904223u;
+			std::swap(quads[i - 1], quads[(state >> 8) % i]);
+		}
+		mesh.vertices.clear();
+		mesh.indices.clear();
+		for (unsigned int quad : quads) {
+			unsigned int x = quad % gridSize;
+			unsigned int y = quad / gridSize;
+			const unsigned int corners[6][2] = { { x, y }, { x + 1, y }, { x, y + 1 }, { x + 1, y }, { x + 1, y + 1 }, { x, y + 1 } };
+			for (int c = 0; c < 6; c++) {
+				mesh.indices.push_back((unsigned int)mesh.vertices.size());
+				mesh.vertices.push_back(makeGridVertex(corners[c][0], corners[c][1], gridSize));
+			}
+		}
+	}
+
+	static void printStage(const char* stage, double ms, const Mesh& mesh) {
+		MeshOptimizer::CacheStatistics statistics = MeshOptimizer::analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+		std::cout << std::setw(14) << stage << std::setw(12) << std::fixed << std::setprecision(2) << ms
+			<< std::setw(12) << mesh.vertices.size() << std::setw(10) << std::setprecision(3) << statistics.acmr
+			<< std::setw(10) << statistics.atvr << std::endl;
+	}
+
+	void runMeshOptimizer(unsigned int gridSize) {
+		Mesh mesh;
+		makeTriangleSoup(gridSize, mesh);
+		std::cout << "Mesh optimizer benchmark (" << mesh.indices.size() / 3 << " triangles, FIFO "
+			<< MeshOptimizer::ANALYZE_CACHE_SIZE << ")" << std::endl;
+		std::cout << std::setw(14) << "pass" << std::setw(12) << "ms" << std::setw(12) << "vertices"
+			<< std::setw(10) << "ACMR" << std::setw(10) << "ATVR" << std::endl;
+		printStage("input", 0.0, mesh);
+
+		auto start = std::chrono::steady_clock::now();
+		auto elapsedMs = [&]() {
+			auto now = std::chrono::steady_clock::now();
+			double ms = std::chrono::duration<double, std::milli>(now - start).count();
+			start = now;
+			return ms;
+		};
+
+		size_t vertexCount = MeshOptimizer::weldVertices(mesh.vertices.data(), mesh.vertices.size(), sizeof(StandardVertex),
+			mesh.indices.data(), mesh.indices.size());
+		mesh.vertices.resize(vertexCount);
+		printStage("weld", elapsedMs(), mesh);
+
+		MeshOptimizer::optimizeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+		printStage("vertex cache", elapsedMs(), mesh);
+
+		MeshOptimizer::optimizeOverdraw(mesh.indices.data(), mesh.indices.size(), mesh.vertices[0].position,
+			mesh.vertices.size(), sizeof(StandardVertex));
+		printStage("overdraw", elapsedMs(), mesh);
+
+		vertexCount = MeshOptimizer::optimizeVertexFetch(mesh.vertices.data(), mesh.vertices.size(), sizeof(StandardVertex),
+			mesh.indices.data(), mesh.indices.size());
+		mesh.vertices.resize(vertexCount);
+		printStage("vertex fetch", elapsedMs(), mesh);
+
+		MeshOptimizer::IndexData packed = MeshOptimizer::packIndices(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+		std::cout << "index buffer: " << (packed.type == GL_UNSIGNED_SHORT ? "16" : "32") << " bit, "
+			<< packed.bytes.size() / 1024 << " KB (" << mesh.indices.size() * sizeof(unsigned int) / 1024 << " KB as 32 bit)" << std::endl;
+		std::cout.unsetf(std::ios::floatfield);
+		std::cout << std::setprecision(6);
+	}
+
+}
@@ -0,0 +1,12 @@
+#ifndef MESH_BENCHMARK_H
+#define MESH_BENCHMARK_H
+
+namespace Benchmark {
+
+	// builds a gridSize x gridSize terrain as an unindexed triangle soup in random order and runs every
+	// MeshOptimizer pass over it, printing the time of each pass and ACMR/ATVR after it
+	void runMeshOptimizer(unsigned int gridSize);
+
+}
+
+#endif // MESH_BENCHMARK_H
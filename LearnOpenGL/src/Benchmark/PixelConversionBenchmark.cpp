@@ -0,0 +1,182 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <random>
+
+#include <glad/glad.h>
+#include <stb/stb_image.h>
+
+#include "PixelConversionBenchmark.h"
+#include "../Texture/PixelConverter.h"
+#include "../Renderer/GLState.h"
+
+namespace Benchmark {
+
+	static const int MEASURED_RUNS = 5;
+	static const int SYNTHETIC_SIZE = 2048;
+
+	// best of a few runs, in milliseconds
+	template <typename Function>
+	static double measureMs(Function function) {
+		double best = 0.0;
+		for (int run = 0; run < MEASURED_RUNS; run++) {
+			auto start = std::chrono::steady_clock::now();
+			function();
+			double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			if (run == 0 || ms < best) {
+				best = ms;
+			}
+		}
+		return best;
+	}
+
+	// stb's req_comp expansion and vertical flip against decoding the channels as they are and converting them
+	static bool measureImage(const std::string& path) {
+		int width = 0, height = 0, channels = 0;
+		unsigned char* reference = NULL;
+		double stbMs = measureMs([&]() {
+			stbi_image_free(reference);
+			stbi_set_flip_vertically_on_load_thread(1);
+			reference = stbi_load(path.c_str(), &width, &height, &channels, 4);
+		});
+		stbi_set_flip_vertically_on_load_thread(0);
+		if (!reference) {
+			std::cout << "ERROR::BENCHMARK::PIXEL_LOAD_FAILED " << path << " (" << stbi_failure_reason() << ")" << std::endl;
+			return false;
+		}
+		unsigned char* pixels = NULL;
+		double decodeMs = measureMs([&]() {
+			stbi_image_free(pixels);
+			pixels = stbi_load(path.c_str(), &width, &height, &channels, 0);
+		});
+		PixelConverter::Options options;
+		options.expandRgb = true;
+		options.flip = true;
+		std::vector<unsigned char> converted((size_t)width * height * PixelConverter::getChannels(channels, options));
+		double convertMs = measureMs([&]() {
+			PixelConverter::convert(pixels, width, height, channels, options, converted.data());
+		});
+		// grey images stay grey here, only RGB and RGBA can be compared with stb's RGBA output
+		bool identical = channels < 3 || memcmp(converted.data(), reference, converted.size()) == 0;
+
+		std::cout << path << " (" << width << "x" << height << ", " << channels << " channels, best of " << MEASURED_RUNS << ")" << std::endl;
+		std::cout << std::fixed << std::setprecision(2);
+		std::cout << "  stb RGBA + flip          " << std::setw(8) << stbMs << " ms" << std::endl;
+		std::cout << "  stb decode + converter   " << std::setw(8) << decodeMs + convertMs << " ms (decode " << decodeMs
+			<< ", convert " << convertMs << ")" << std::endl;
+		std::cout << "  output " << (identical ? "matches" : "DIFFERS FROM") << " stb's" << std::endl;
+		std::cout.unsetf(std::ios::floatfield);
+		std::cout << std::setprecision(6);
+		if (!identical) {
+			std::cout << "ERROR::BENCHMARK::PIXEL_CONVERSION_MISMATCH " << path << std::endl;
+		}
+		stbi_image_free(reference);
+		stbi_image_free(pixels);
+		return identical;
+	}
+
+	// one conversion of the synthetic image, scalar against SSE2
+	static bool measureConversion(const char* name, const std::vector<unsigned char>& pixels, int channels, const PixelConverter::Options& options) {
+		size_t targetBytes = (size_t)SYNTHETIC_SIZE * SYNTHETIC_SIZE * PixelConverter::getChannels(channels, options);
+		std::vector<unsigned char> scalar(targetBytes), simd(targetBytes);
+		double scalarMs = measureMs([&]() {
+			PixelConverter::convert(pixels.data(), SYNTHETIC_SIZE, SYNTHETIC_SIZE, channels, options, scalar.data(), false);
+		});
+		double simdMs = measureMs([&]() {
+			PixelConverter::convert(pixels.data(), SYNTHETIC_SIZE, SYNTHETIC_SIZE, channels, options, simd.data(), true);
+		});
+		double megabytes = (double)SYNTHETIC_SIZE * SYNTHETIC_SIZE * channels / (1024.0 * 1024.0);
+		bool identical = scalar == simd;
+		std::cout << std::fixed << std::setw(16) << name << std::setw(12) << std::setprecision(1) << megabytes / (scalarMs / 1000.0)
+			<< std::setw(12) << megabytes / (simdMs / 1000.0) << std::setw(10) << std::setprecision(2) << scalarMs / simdMs << "x"
+			<< (identical ? "" : "  DIFFERS") << std::endl;
+		if (!identical) {
+			std::cout << "ERROR::BENCHMARK::PIXEL_CONVERTER_MISMATCH " << name << std::endl;
+		}
+		return identical;
+	}
+
+	static double measureUpload(GLenum internalFormat, GLenum format, const std::vector<unsigned char>& pixels) {
+		return measureMs([&]() {
+			unsigned int texture;
+			glGenTextures(1, &texture);
+			GLState::bindTexture(0, GL_TEXTURE_2D, texture);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, SYNTHETIC_SIZE, SYNTHETIC_SIZE, 0, format, GL_UNSIGNED_BYTE, pixels.data());
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+			glFinish();
+			GLState::deleteTexture(texture);
+		});
+	}
+
+	bool runPixelConversion(const std::vector<std::string>& paths) {
+		std::cout << "Pixel conversion benchmark" << std::endl;
+		bool passed = true;
+		for (const std::string& path : paths) {
+			passed = measureImage(path) && passed;
+		}
+
+		// random texels, the conversions do not branch on the values
+		std::mt19937 random(1);
+		std::vector<unsigned char> rgb((size_t)SYNTHETIC_SIZE * SYNTHETIC_SIZE * 3), rgba((size_t)SYNTHETIC_SIZE * SYNTHETIC_SIZE * 4);
+		for (unsigned char& value : rgb) {
+			value = (unsigned char)random();
+		}
+		for (unsigned char& value : rgba) {
+			value = (unsigned char)random();
+		}
+		std::cout << SYNTHETIC_SIZE << "x" << SYNTHETIC_SIZE << " synthetic image, MB/s of source pixels" << std::endl;
+		std::cout << std::setw(16) << "conversion" << std::setw(12) << "scalar" << std::setw(12) << (PixelConverter::isSimd() ? "SSE2" : "scalar")
+			<< std::setw(11) << "speedup" << std::endl;
+		PixelConverter::Options options;
+		options.flip = true;
+		passed = measureConversion("flip", rgba, 4, options) && passed;
+		options.expandRgb = true;
+		passed = measureConversion("RGB to RGBA", rgb, 3, options) && passed;
+		options.bgra = true;
+		passed = measureConversion("RGB to BGRA", rgb, 3, options) && passed;
+		passed = measureConversion("RGBA to BGRA", rgba, 4, options) && passed;
+		options.bgra = false;
+		options.premultiply = true;
+		passed = measureConversion("premultiply", rgba, 4, options) && passed;
+		options.bgra = true;
+		passed = measureConversion("premultiply BGRA", rgba, 4, options) && passed;
+
+		std::vector<float> linear(rgba.size());
+		double powMs = measureMs([&]() {
+			for (size_t i = 0; i < rgba.size(); i++) {
+				float value = rgba[i] / 255.0f;
+				linear[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+			}
+		});
+		std::vector<float> table(rgba.size());
+		double tableMs = measureMs([&]() {
+			PixelConverter::srgbToLinear(rgba.data(), rgba.size(), table.data());
+		});
+		double megabytes = rgba.size() / (1024.0 * 1024.0);
+		bool identical = linear == table;
+		std::cout << std::setw(16) << "sRGB to linear" << std::setw(12) << std::setprecision(1) << megabytes / (powMs / 1000.0)
+			<< std::setw(12) << megabytes / (tableMs / 1000.0) << std::setw(10) << std::setprecision(2) << powMs / tableMs
+			<< "x  (std::pow against the table)" << (identical ? "" : "  DIFFERS") << std::endl;
+		passed = identical && passed;
+
+		// what the driver asks for, and what the alternatives cost it
+		PixelConverter::UploadFormat preferred = PixelConverter::queryUploadFormat();
+		std::cout << "driver prefers " << (preferred.expandRgb ? "RGBA" : "RGB") << " data for RGB8 and "
+			<< (preferred.bgra ? "GL_BGRA" : "GL_RGBA") << " for RGBA8, glTexImage2D of the synthetic image:" << std::endl;
+		std::vector<unsigned char> bgra(rgba.size());
+		PixelConverter::Options swizzle;
+		swizzle.bgra = true;
+		PixelConverter::convert(rgba.data(), SYNTHETIC_SIZE, SYNTHETIC_SIZE, 4, swizzle, bgra.data());
+		std::cout << "  RGB8 from GL_RGB   " << std::setw(8) << measureUpload(GL_RGB8, GL_RGB, rgb) << " ms" << std::endl;
+		std::cout << "  RGBA8 from GL_RGBA " << std::setw(8) << measureUpload(GL_RGBA8, GL_RGBA, rgba) << " ms" << std::endl;
+		std::cout << "  RGBA8 from GL_BGRA " << std::setw(8) << measureUpload(GL_RGBA8, GL_BGRA, bgra) << " ms" << std::endl;
+		std::cout.unsetf(std::ios::floatfield);
+		std::cout << std::setprecision(6);
+		return passed;
+	}
+}
@@ -0,0 +1,17 @@
+#ifndef PIXEL_CONVERSION_BENCHMARK_H
+#define PIXEL_CONVERSION_BENCHMARK_H
+
+#include <string>
+#include <vector>
+
+namespace Benchmark {
+
+	// loads every image the way TextureManager used to (stb expanding to RGBA and flipping on its own) and the way it
+	// does now (stb's channels as they are, then one PixelConverter pass), then times each conversion scalar against
+	// SSE2 on a synthetic image and uploads RGB, RGBA and BGRA data. returns false if an image failed to load or the
+	// converted pixels differ between the two paths or between scalar and SSE2
+	bool runPixelConversion(const std::vector<std::string>& paths);
+
+}
+
+#endif // PIXEL_CONVERSION_BENCHMARK_H
@@ -0,0 +1,204 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+#include <glad/glad.h>
+#include <stb/stb_image.h>
+
+#include "TextureCompressionBenchmark.h"
+#include "../Texture/BlockEncoder.h"
+#include "../Texture/BlockDecoder.h"
+#include "../Texture/CompressedTexture.h"
+#include "../Texture/MipGenerator.h"
+#include "../Renderer/GLState.h"
+#include "../Utility/ThreadPool.h"
+
+namespace Benchmark {
+
+	static const int MEASURED_RUNS = 5;
+
+	static const GLenum FORMATS[4] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+	static const GLenum INTERNAL_FORMATS[4] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+
+	// best of a few runs, in milliseconds
+	template <typename Function>
+	static double measureMs(Function function) {
+		double best = 0.0;
+		for (int run = 0; run < MEASURED_RUNS; run++) {
+			auto start = std::chrono::steady_clock::now();
+			function();
+			double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			if (run == 0 || ms < best) {
+				best = ms;
+			}
+		}
+		return best;
+	}
+
+	// decodes the blocks again and compares the channels the format keeps (RGB for BC1) with the source
+	static double computePsnr(const unsigned char* pixels, int width, int height, int channels, const unsigned char* blocks) {
+		CompressedTexture::Format format = BlockEncoder::getFormat(channels);
+		// BC1 and BC3 decode to RGBA, BC4 and BC5 to their own channels
+		int decodedChannels = channels >= 3 ? 4 : channels;
+		size_t blockBytes = (channels == 1 || channels == 3) ? 8 : 16;
+		double squaredError = 0.0;
+		for (int y = 0; y < height; y += 4) {
+			for (int x = 0; x < width; x += 4, blocks += blockBytes) {
+				unsigned char tile[4 * 4 * 4];
+				size_t tilePitch = 4 * (size_t)decodedChannels;
+				switch (format) {
+				case CompressedTexture::FORMAT_BC4: BlockDecoder::decodeBC4(blocks, tile, tilePitch, 1); break;
+				case CompressedTexture::FORMAT_BC5: BlockDecoder::decodeBC5(blocks, tile, tilePitch); break;
+				case CompressedTexture::FORMAT_BC1: BlockDecoder::decodeBC1(blocks, tile, tilePitch, false); break;
+				default: BlockDecoder::decodeBC3(blocks, tile, tilePitch); break;
+				}
+				for (int row = 0; row < 4 && y + row < height; row++) {
+					for (int column = 0; column < 4 && x + column < width; column++) {
+						const unsigned char* source = pixels + ((size_t)(y + row) * width + x + column) * channels;
+						const unsigned char* decoded = tile + row * tilePitch + column * decodedChannels;
+						for (int c = 0; c < channels; c++) {
+							double difference = (double)source[c] - decoded[c];
+							squaredError += difference * difference;
+						}
+					}
+				}
+			}
+		}
+		double meanSquaredError = squaredError / ((double)width * height * channels);
+		return meanSquaredError == 0.0 ? INFINITY : 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+	}
+
+	// what TextureManager does without compression: the decoded pixels plus glGenerateMipmap
+	static double measureUncompressedUpload(const unsigned char* pixels, int width, int height, int channels) {
+		return measureMs([&]() {
+			unsigned int texture;
+			glGenTextures(1, &texture);
+			GLState::bindTexture(0, GL_TEXTURE_2D, texture);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glTexImage2D(GL_TEXTURE_2D, 0, INTERNAL_FORMATS[channels - 1], width, height, 0, FORMATS[channels - 1], GL_UNSIGNED_BYTE, pixels);
+			glGenerateMipmap(GL_TEXTURE_2D);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+			glFinish();
+			GLState::deleteTexture(texture);
+		});
+	}
+
+	static double measureCompressedUpload(const TextureData& data) {
+		return measureMs([&]() {
+			unsigned int texture;
+			glGenTextures(1, &texture);
+			GLState::bindTexture(0, GL_TEXTURE_2D, texture);
+			for (size_t level = 0; level < data.levels.size(); level++) {
+				const TextureLevel& mip = data.levels[level];
+				glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, data.internalFormat, mip.width, mip.height, 0,
+					(GLsizei)mip.size, data.bytes.data() + mip.offset);
+			}
+			glFinish();
+			GLState::deleteTexture(texture);
+		});
+	}
+
+	static bool measureImage(const std::string& path, unsigned int maxThreads) {
+		int width = 0, height = 0, channels = 0;
+		unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 0);
+		if (!pixels) {
+			std::cout << "ERROR::BENCHMARK::TEXTURE_LOAD_FAILED " << path << " (" << stbi_failure_reason() << ")" << std::endl;
+			return false;
+		}
+		CompressedTexture::Format format = BlockEncoder::getFormat(channels);
+		size_t encodedBytes = CompressedTexture::levelSize(format, width, height);
+		double megabytes = (double)width * height * channels / (1024.0 * 1024.0);
+		std::cout << path << " (" << width << "x" << height << ", " << channels << " channels -> "
+			<< CompressedTexture::getName(format) << ", best of " << MEASURED_RUNS << ")" << std::endl;
+		std::cout << std::setw(10) << "encoder" << std::setw(9) << "threads" << std::setw(12) << "ms"
+			<< std::setw(12) << "MB/s" << std::setw(11) << "speedup" << std::endl;
+
+		std::vector<unsigned char> reference(encodedBytes);
+		double scalarMs;
+		{
+			ThreadPool pool(1);
+			scalarMs = measureMs([&]() {
+				BlockEncoder::encodeImage(pixels, width, height, channels, reference.data(), pool, false);
+			});
+		}
+		std::cout << std::fixed << std::setw(10) << "scalar" << std::setw(9) << 1 << std::setw(12) << std::setprecision(2) << scalarMs
+			<< std::setw(12) << std::setprecision(1) << megabytes / (scalarMs / 1000.0) << std::setw(10) << std::setprecision(2) << 1.0 << "x" << std::endl;
+
+		std::vector<unsigned int> threadCounts;
+		for (unsigned int threads = 1; threads < maxThreads; threads *= 2) {
+			threadCounts.push_back(threads);
+		}
+		threadCounts.push_back(maxThreads);
+		bool identical = true;
+		std::vector<unsigned char> encoded(encodedBytes);
+		for (unsigned int threads : threadCounts) {
+			ThreadPool pool(threads);
+			double ms = measureMs([&]() {
+				BlockEncoder::encodeImage(pixels, width, height, channels, encoded.data(), pool);
+			});
+			if (encoded != reference) {
+				std::cout << "ERROR::BENCHMARK::BLOCK_ENCODER_MISMATCH " << threads << " threads" << std::endl;
+				identical = false;
+			}
+			std::cout << std::setw(10) << (BlockEncoder::isSimd() ? "SSE2" : "scalar") << std::setw(9) << threads << std::setw(12)
+				<< std::setprecision(2) << ms << std::setw(12) << std::setprecision(1) << megabytes / (ms / 1000.0)
+				<< std::setw(10) << std::setprecision(2) << scalarMs / ms << "x" << std::endl;
+		}
+		std::cout << "  PSNR " << std::setprecision(2) << computePsnr(pixels, width, height, channels, reference.data()) << " dB, "
+			<< (double)width * height * channels / encodedBytes << ":1, SIMD output " << (identical ? "matches" : "DIFFERS FROM")
+			<< " the scalar encoder" << std::endl;
+
+		// the full load time path: uncompressed upload with generated mips against compressing the chain on the CPU
+		TextureData data;
+		data.width = width;
+		data.height = height;
+		data.internalFormat = INTERNAL_FORMATS[channels - 1];
+		data.format = FORMATS[channels - 1];
+		size_t size = (size_t)width * height * channels;
+		data.levels.assign(1, TextureLevel{ 0, size, width, height });
+		TextureData compressed;
+		MipGenerator::Options mipOptions;
+		mipOptions.colorSpace = COLOR_SPACE_SRGB;
+		double compressMs = measureMs([&]() {
+			compressed = data;
+			compressed.bytes.assign(pixels, pixels + size);
+			MipGenerator::generate(compressed, mipOptions);
+			CompressedTexture::compress(compressed);
+		});
+		// drivers pad RGB8 texels to 4 bytes, a full mip chain adds a third
+		size_t uncompressedBytes = (size_t)width * height * (channels == 3 ? 4 : channels) * 4 / 3;
+		double uncompressedMs = measureUncompressedUpload(pixels, width, height, channels);
+		std::cout << "  uncompressed upload + glGenerateMipmap " << std::setprecision(2) << uncompressedMs << " ms, "
+			<< uncompressedBytes / 1024 << " KB" << std::endl;
+		if (compressed.compressed) {
+			double compressedMs = measureCompressedUpload(compressed);
+			std::cout << "  " << CompressedTexture::getName(format) << " mip chain: filter and compress " << compressMs << " ms + upload "
+				<< compressedMs << " ms, " << compressed.bytes.size() / 1024 << " KB" << std::endl;
+		}
+		else {
+			std::cout << "  " << CompressedTexture::getName(format) << " is not supported by this context, upload skipped" << std::endl;
+		}
+		std::cout.unsetf(std::ios::floatfield);
+		std::cout << std::setprecision(6);
+		stbi_image_free(pixels);
+		return identical;
+	}
+
+	bool runTextureCompression(const std::vector<std::string>& paths, unsigned int maxThreads) {
+		if (maxThreads == 0) {
+			maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		std::cout << "Texture compression benchmark" << std::endl;
+		bool passed = true;
+		for (const std::string& path : paths) {
+			passed = measureImage(path, maxThreads) && passed;
+		}
+		return passed;
+	}
+}
@@ -0,0 +1,17 @@
+#ifndef TEXTURE_COMPRESSION_BENCHMARK_H
+#define TEXTURE_COMPRESSION_BENCHMARK_H
+
+#include <string>
+#include <vector>
+
+namespace Benchmark {
+
+	// compresses every image with BlockEncoder, scalar and SIMD with 1, 2, 4 ... threads up to maxThreads (0 for the
+	// hardware thread count), prints MB/s of source pixels and the PSNR of the decoded blocks. then compares the
+	// uncompressed upload with glGenerateMipmap against compressing the mip chain and uploading it compressed.
+	// returns false if an image failed to load or the SIMD output differs from the scalar encoder
+	bool runTextureCompression(const std::vector<std::string>& paths, unsigned int maxThreads);
+
+}
+
+#endif // TEXTURE_COMPRESSION_BENCHMARK_H
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "VertexCompressionBenchmark.h"
+#include "../Renderer/VertexCompression.h"
+
+namespace Benchmark {
+
+	static const int MEASURED_RUNS = 5;
+
+	// xorshift, the benchmark data has to be the same on every run
+	static unsigned int nextRandom(unsigned int& state) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	static float randomUnit(unsigned int& state) {
+		return (nextRandom(state) >> 8) / 16777215.0f;
+	}
+
+	// positions cover every half exponent from denormals up to 2^14 with both signs,
+	// colours and texture coordinates stay in [0, 1] like the format expects
+	static void makeVertices(size_t count, std::vector<StandardVertex>& vertices) {
+		unsigned int state = 0x9e3779b9u;
+		vertices.resize(count);
+		for (size_t i = 0; i < count; i++) {
+			StandardVertex& vertex = vertices[i];
+			for (int c = 0; c < 3; c++) {
+				int exponent = (int)(nextRandom(state) % 39) - 24;
+				float sign = (nextRandom(state) & 1) ? -1.0f : 1.0f;
+				vertex.position[c] = sign * std::ldexp(1.0f + randomUnit(state), exponent);
+				vertex.color[c] = randomUnit(state);
+			}
+			vertex.texCoord[0] = randomUnit(state);
+			vertex.texCoord[1] = randomUnit(state);
+		}
+		// the edges of the unorm ranges
+		if (count >= 2) {
+			vertices[0] = StandardVertex{ { 0.0f, -0.0f, 65504.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f } };
+			vertices[1] = StandardVertex{ { -65504.0f, 1.0f, -1.0f }, { 1.0f, 1.0f, 1.0f }, { 1.0f, 1.0f } };
+		}
+	}
+
+	// best of a few runs, in milliseconds
+	template <typename EncodeFunction>
+	static double measureEncodeMs(EncodeFunction encode) {
+		double best = 0.0;
+		for (int run = 0; run < MEASURED_RUNS; run++) {
+			auto start = std::chrono::steady_clock::now();
+			encode();
+			double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			if (run == 0 || ms < best) {
+				best = ms;
+			}
+		}
+		return best;
+	}
+
+	bool runVertexCompression(size_t vertexCount) {
+		std::vector<StandardVertex> vertices;
+		makeVertices(vertexCount, vertices);
+		std::vector<CompactVertex> scalar(vertexCount);
+		std::vector<CompactVertex> simd(vertexCount);
+
+		double scalarMs = measureEncodeMs([&]() {
+			VertexCompression::encodeVerticesScalar(vertices.data(), scalar.data(), vertexCount);
+		});
+		double simdMs = measureEncodeMs([&]() {
+			VertexCompression::encodeVertices(vertices.data(), simd.data(), vertexCount);
+		});
+		bool identical = memcmp(scalar.data(), simd.data(), vertexCount * sizeof(CompactVertex)) == 0;
+
+		VertexCompression::RoundTripError error;
+		bool accurate = VertexCompression::checkRoundTrip(vertices.data(), vertexCount, error);
+
+		double megabytes = vertexCount * sizeof(StandardVertex) / (1024.0 * 1024.0);
+		std::cout << "Vertex compression benchmark (" << vertexCount << " vertices, "
+			<< sizeof(StandardVertex) << " -> " << sizeof(CompactVertex) << " bytes per vertex)" << std::endl;
+		std::cout << std::fixed << std::setprecision(3);
+		std::cout << "  scalar: " << scalarMs << " ms (" << std::setprecision(0) << megabytes / (scalarMs / 1000.0) << " MB/s)" << std::endl;
+		std::cout << std::setprecision(3) << "  " << (VertexCompression::isSimd() ? "SSE2" : "scalar") << ":   " << simdMs << " ms ("
+			<< std::setprecision(0) << megabytes / (simdMs / 1000.0) << " MB/s, " << std::setprecision(1) << scalarMs / simdMs << "x)" << std::endl;
+		std::cout.unsetf(std::ios::floatfield);
+		std::cout << std::setprecision(6);
+		std::cout << "  SIMD output " << (identical ? "matches" : "DIFFERS FROM") << " the scalar encoder" << std::endl;
+		std::cout << "  round trip error: position " << error.position << " (relative), colour " << error.color
+			<< ", texture coordinates " << error.texCoord << (accurate ? "" : " FAILED") << std::endl;
+		if (!identical) {
+			std::cout << "ERROR::VERTEX_COMPRESSION::SIMD_MISMATCH" << std::endl;
+		}
+		return identical && accurate;
+	}
+
+}
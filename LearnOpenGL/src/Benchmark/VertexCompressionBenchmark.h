@@ -0,0 +1,15 @@
+#ifndef VERTEX_COMPRESSION_BENCHMARK_H
+#define VERTEX_COMPRESSION_BENCHMARK_H
+
+#include <cstddef>
+
+namespace Benchmark {
+
+	// encodes vertexCount pseudo random vertices with the scalar and the SIMD encoder, checks that both produce
+	// the same bytes and that decoding stays within the precision of CompactVertex, prints MB/s for both.
+	// returns false if any of the checks failed
+	bool runVertexCompression(size_t vertexCount);
+
+}
+
+#endif // VERTEX_COMPRESSION_BENCHMARK_H
@@ -1,27 +1,133 @@
 
-// include the stb_image.h file
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb/stb_image.h>
-
 #include <iostream>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <cmath>
 
 #include "Window/Window.h"
+#include "Offscreen/Offscreen.h"
 #include "ShaderManager/Shader.h"
+#include "ShaderManager/ProgramCache.h"
+#include "ShaderManager/ShaderCompiler.h"
+#include "ShaderManager/ShaderWatcher.h"
+#include "Profiler/GpuProfiler.h"
+#include "Renderer/GLState.h"
+#include "Renderer/RenderQueue.h"
+#include "Renderer/VertexFormats.h"
+#include "Renderer/VertexCompression.h"
+#include "Renderer/InstanceBuffer.h"
+#include "Renderer/StreamBuffer.h"
+#include "Texture/TextureManager.h"
+#include "Texture/TextureAtlas.h"
+#include "Mesh/MeshOptimizer.h"
+#include "Mesh/MeshFile.h"
+#include "Mesh/MeshConverter.h"
+#include "Utility/MappedFile.h"
+#include "Benchmark/InstancingBenchmark.h"
+#include "Benchmark/MeshBenchmark.h"
+#include "Benchmark/VertexCompressionBenchmark.h"
+#include "Benchmark/ImportBenchmark.h"
+#include "Benchmark/TextureCompressionBenchmark.h"
+#include "Benchmark/PixelConversionBenchmark.h"
+#include "Benchmark/ImageDecoderBenchmark.h"
 #include "Utility/Utility.h"
 
+// drawn with the vertex colours until the real shader program has finished compiling
+static const char* fallbackVertexCode =
+	"#version 330 core\n"
+	"layout (location = 0) in vec3 aPos;\n"
+	"layout (location = 1) in vec3 aColor;\n"
+	"out vec3 ourColor;\n"
+	"void main() {\n"
+	"	gl_Position = vec4(aPos.x, aPos.y, aPos.z, 1.0);\n"
+	"	ourColor = aColor;\n"
+	"}\n";
+static const char* fallbackFragmentCode =
+	"#version 330 core\n"
+	"in vec3 ourColor;\n"
+	"out vec4 FragColor;\n"
+	"void main() {\n"
+	"	FragColor = vec4(ourColor * 0.5, 1.0);\n"
+	"}\n";
 
-int main() {
-	
-	// initialize OpenGL version and the glfw window
-	GLFWwindow* window = Window::initializeWindow(1280, 720, "LearnOpenGL", 3);
-	if (window == NULL) {
-		return -1;
-	}
-	// link all the shader programs
-	Shader shaderProgram(
-		"src/ShaderPrograms/vertexShaderSource.vert",
-		"src/ShaderPrograms/fragmentShaderSource.frag"
-	);
+
+static const int screenWidth = 1280;
+static const int screenHeight = 720;
+
+// everything owning GL objects is a local of this function, so all of it is destroyed while the context is current
+static int run(int argc, char* argv[], GLFWwindow* window) {
+
+	// --benchmark instancing measures instanced against per draw call rendering and exits,
+	// --benchmark vertices times and checks the CompactVertex encoder, --benchmark mesh runs the mesh optimizer,
+	// --benchmark import measures the OBJ and glTF importers (--threads N caps the thread count),
+	// --benchmark textures the block encoder on both textures or on --image path, --benchmark pixels PixelConverter
+	// against stb's own conversions, --benchmark decoders every image decoder backend on the images in textures/ or in
+	// --corpus directory
+	std::string benchmark = Utility::getStringArgument(argc, argv, "--benchmark", "");
+	// main() made a headless context instead of a window
+	bool headless = window == NULL;
+	int headlessFrames = Utility::getIntArgument(argc, argv, "--frames", 600);
+	const char* headlessOutput = Utility::getStringArgument(argc, argv, "--output", NULL);
+	// --profile prints the GPU time of every render loop scope every few hundred frames
+	bool printProfile = Utility::hasArgument(argc, argv, "--profile");
+	// --instances N draws a grid of N hexagons with a single instanced draw call
+	int instanceCount = Utility::getIntArgument(argc, argv, "--instances", 0);
+	// --animate rewrites every instance each frame through the streaming ring buffer
+	bool animateInstances = Utility::hasArgument(argc, argv, "--animate");
+	// --compact-vertices stores the hexagon as 16 byte CompactVertex instead of 32 byte StandardVertex
+	bool compactVertices = Utility::hasArgument(argc, argv, "--compact-vertices");
+	// --mesh model.mesh draws a converted model instead of the hexagon
+	const char* meshPath = Utility::getStringArgument(argc, argv, "--mesh", NULL);
+
+	// link all the shader programs, the driver compiles them while the textures load
+	// and the tiny fallback program is drawn until they are ready
+	ShaderCompiler shaderCompiler;
+	Shader fallbackProgram(Shader::compileProgram(fallbackVertexCode, fallbackFragmentCode));
+	Shader shaderProgram(0u);
+	Shader* activeProgram = &fallbackProgram;
+	auto onShaderReady = [&](const Shader& shader) {
+		// replaces (and deletes) the previous program, both on startup and on hot reload
+		shaderProgram.reload(shader);
+		if (compactVertices) {
+			VertexLayoutCheck::validate<CompactVertexLayout>(shaderProgram.getID(), "vertexShaderSource.vert");
+		}
+		else {
+			VertexLayoutCheck::validate<StandardVertexLayout>(shaderProgram.getID(), "vertexShaderSource.vert");
+		}
+		// set the textures
+		shaderProgram.use();
+		shaderProgram.setInt("ourTexture", 0);
+		shaderProgram.setInt("ourTexture2", 1);
+		activeProgram = &shaderProgram;
+		// startup cost of the shaders, warm starts should be all hits
+		ProgramCache::printStatistics();
+	};
+	const char* vertexShaderPath = "src/ShaderPrograms/vertexShaderSource.vert";
+	const char* fragmentShaderPath = "src/ShaderPrograms/fragmentShaderSource.frag";
+	shaderCompiler.submit(vertexShaderPath, fragmentShaderPath, onShaderReady);
+
+	// the vertex shader places every instance, the fragment shader reads the texture atlas
+	Shader instancedProgram(0u);
+	auto onInstancedShaderReady = [&](const Shader& shader) {
+		instancedProgram.reload(shader);
+		if (compactVertices) {
+			VertexLayoutCheck::validate<CompactVertexLayout, InstanceLayout>(instancedProgram.getID(), "instancedVertexShaderSource.vert");
+		}
+		else {
+			VertexLayoutCheck::validate<StandardVertexLayout, InstanceLayout>(instancedProgram.getID(), "instancedVertexShaderSource.vert");
+		}
+		instancedProgram.use();
+		instancedProgram.setInt("atlas", 0);
+	};
+	const char* instancedVertexShaderPath = "src/ShaderPrograms/instancedVertexShaderSource.vert";
+	const char* instancedFragmentShaderPath = "src/ShaderPrograms/instancedFragmentShaderSource.frag";
+	shaderCompiler.submit(instancedVertexShaderPath, instancedFragmentShaderPath, onInstancedShaderReady);
+
+	// saving one of the shader files rebuilds the program in the background and swaps it in
+	ShaderWatcher shaderWatcher(shaderCompiler, "src/ShaderPrograms");
+	shaderWatcher.watch(vertexShaderPath, fragmentShaderPath, onShaderReady);
+	shaderWatcher.watch(instancedVertexShaderPath, instancedFragmentShaderPath, onInstancedShaderReady);
 
 	// 3D coords for a triangle
 	//float vertices[] = {
@@ -33,14 +139,14 @@ int main() {
 	//};
 	
 	// vertices for a hexagon 
-	float vertices[] = {
-		// positions		 // colours         // texture coords
-		-0.50f,  0.0f, 0.0f,  1.0f, 0.0f, 0.0f,  0.00f, 0.5f,   // most left point
-		-0.20f,  0.5f, 0.0f,  1.0f, 1.0f, 0.0f,  0.33f, 1.0f,   // top left point
-		 0.20f,  0.5f, 0.0f,  0.0f, 1.0f, 0.0f,  0.66f, 1.0f,   // top right point
-		 0.50f,  0.0f, 0.0f,  0.0f, 1.0f, 1.0f,  1.00f, 0.5f,   // most right point
-		 0.20f, -0.5f, 0.0f,  0.0f, 0.0f, 1.0f,  0.66f, 0.0f,   // bottom right point
-		-0.20f, -0.5f, 0.0f,  1.0f, 0.0f, 1.0f,  0.33f, 0.0f    // bottom left point
+	StandardVertex vertices[] = {
+		// positions		      // colours            // texture coords
+		{ { -0.50f,  0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.00f, 0.5f } },   // most left point
+		{ { -0.20f,  0.5f, 0.0f }, { 1.0f, 1.0f, 0.0f }, { 0.33f, 1.0f } },   // top left point
+		{ {  0.20f,  0.5f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.66f, 1.0f } },   // top right point
+		{ {  0.50f,  0.0f, 0.0f }, { 0.0f, 1.0f, 1.0f }, { 1.00f, 0.5f } },   // most right point
+		{ {  0.20f, -0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.66f, 0.0f } },   // bottom right point
+		{ { -0.20f, -0.5f, 0.0f }, { 1.0f, 0.0f, 1.0f }, { 0.33f, 0.0f } }    // bottom left point
 	};
 
 	unsigned int indices[] = {
@@ -50,120 +156,375 @@ int main() {
 		2, 3, 4,  // fourth triangle
 	};
 
+	// the hand written order goes through the same passes as any other mesh, and gets 16 bit indices
+	Mesh hexagonMesh;
+	hexagonMesh.vertices.assign(vertices, vertices + sizeof(vertices) / sizeof(vertices[0]));
+	hexagonMesh.indices.assign(indices, indices + sizeof(indices) / sizeof(indices[0]));
+	MeshOptimizer::Report hexagonReport = MeshOptimizer::optimize(hexagonMesh);
+	MeshOptimizer::IndexData hexagonIndices = MeshOptimizer::packIndices(hexagonMesh.indices.data(),
+		hexagonMesh.indices.size(), hexagonMesh.vertices.size());
+	if (printProfile) {
+		MeshOptimizer::printReport("Hexagon", hexagonReport);
+	}
+
 	unsigned int EBO, VAO, VBO;
 	glGenVertexArrays(1, &VAO);
 	glGenBuffers(1, &VBO);
 	glGenBuffers(1, &EBO);
 
 	// bind the VAO
-	glBindVertexArray(VAO);	
+	GLState::bindVertexArray(VAO);	
 	// bind the newly created buffer to a VBO then copy the vertex data onto the buffer's memory
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
+	if (compactVertices) {
+		std::vector<CompactVertex> compact(hexagonMesh.vertices.size());
+		VertexCompression::encodeVertices(hexagonMesh.vertices.data(), compact.data(), compact.size());
+		glBufferData(GL_ARRAY_BUFFER, compact.size() * sizeof(CompactVertex), compact.data(), GL_STATIC_DRAW);
+	}
+	else {
+		glBufferData(GL_ARRAY_BUFFER, hexagonMesh.vertices.size() * sizeof(StandardVertex), hexagonMesh.vertices.data(), GL_STATIC_DRAW);
+	}
 
 	// bind the EBO
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	// position attribute
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-	// color attribute
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-	// texture coordinates attribute
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-	glEnableVertexAttribArray(2);
+	GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, hexagonIndices.bytes.size(), hexagonIndices.bytes.data(), GL_STATIC_DRAW);
 
-	// ==================== creating and loading a texture =======================
-	unsigned int texture, texture2;
-    // ----------------------------
-	glGenTextures(1, &texture);
-	// set texture wrapping and filtering options for the first texture
-	glBindTexture(GL_TEXTURE_2D, texture);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-	// load the texture from an image
-	int width,  height,  nrChannels;  // details for 1st image
-	int width2, height2, nrChannels2; // details for 2nd image
-	// load the first image
-	unsigned char* data = stbi_load("textures/container.jpg", &width, &height, &nrChannels, 0);
-	// load the second image
-	unsigned char* data2 = stbi_load("textures/awesomeface.png", &width2, &height2, &nrChannels2, 0);
-	// check if the data has loaded successfully
-	if (data) {
-		// generate first texture
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
+	// position, colour and texture coordinate attributes, all derived from the vertex struct
+	auto applyVertexLayout = [&]() {
+		if (compactVertices) {
+			CompactVertexLayout::apply();
+		}
+		else {
+			StandardVertexLayout::apply();
+		}
+	};
+	applyVertexLayout();
+
+	// the mesh file is mapped and its streams copied straight into the GPU buffers
+	MeshFile::GpuMesh loadedMesh;
+	if (meshPath) {
+		auto loadStart = std::chrono::steady_clock::now();
+		MappedFile meshMapping;
+		MeshFile::View meshView;
+		if (meshMapping.open(meshPath) && MeshFile::open(meshMapping, meshView) && MeshFile::upload(meshView, loadedMesh)) {
+			glFinish();
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+			std::cout << "Mesh: " << meshPath << ", " << loadedMesh.size / (1024 * 1024) << " MB in " << seconds * 1000.0 << " ms ("
+				<< (seconds > 0.0 ? loadedMesh.size / (1024.0 * 1024.0) / seconds : 0.0) << " MB/s)" << std::endl;
+		}
 	}
-	else {
-		std::cout << "ERROR: Failed to load the texture!" << std::endl;
-	}
-	stbi_image_free(data);
-
-	// Generate the 2nd texture
-	glGenTextures(1, &texture2);
-	// set texture wrapping and filtering options for the first texture
-	glBindTexture(GL_TEXTURE_2D, texture2);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	if (data2) {
-		// generate second texture
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width2, height2, 0, GL_RGBA, GL_UNSIGNED_BYTE, data2);
-		glGenerateMipmap(GL_TEXTURE_2D);
+
+	// a second VAO reads the same hexagon plus one InstanceData per instance
+	unsigned int instancedVAO;
+	InstanceBuffer instanceBuffer;
+	glGenVertexArrays(1, &instancedVAO);
+	GLState::bindVertexArray(instancedVAO);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
+	GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	applyVertexLayout();
+	instanceBuffer.attach();
+	std::vector<InstanceData> instances;
+	// the instances take their images from one texture array, both textures or the comma separated --atlas list.
+	// each one selects its image with the layer and texRect attributes, so they all share one bind and one draw
+	TextureAtlas textureAtlas;
+	if (instanceCount > 0 || benchmark == "instancing") {
+		std::vector<std::string> atlasImages = Utility::splitString(Utility::getStringArgument(argc, argv, "--atlas",
+			"textures/container.jpg,textures/awesomeface.png"), ',');
+		if (textureAtlas.build(atlasImages) && printProfile) {
+			textureAtlas.printStatistics();
+		}
 	}
-	else {
-		std::cout << "ERROR: Failed to load the texture!" << std::endl;
+	if (instanceCount > 0) {
+		Benchmark::makeInstanceGrid(instanceCount, instances);
+		Benchmark::assignAtlasRegions(textureAtlas, instances);
+		instanceBuffer.upload(instances);
 	}
-	stbi_image_free(data2);
+	// animated instances are written straight into mapped buffer memory every frame
+	StreamBuffer instanceStream(GL_ARRAY_BUFFER, animateInstances ? instanceCount * sizeof(InstanceData) : 0);
 
-	// set the textures
-	shaderProgram.use();
-	shaderProgram.setInt("ourTexture", 0);
-	shaderProgram.setInt("ourTexture2", 1);
+	// ==================== creating and loading a texture =======================
+	// textures are shared by path and sampler state, --texture-budget MB caps how much memory the unused ones may keep.
+	// they are decoded on worker threads and show a placeholder until the render loop has uploaded them,
+	// spending at most --texture-upload-ms per frame on it
+	TextureManager textureManager((size_t)Utility::getIntArgument(argc, argv, "--texture-budget", 0) * 1024 * 1024);
+	double textureUploadMs = Utility::getIntArgument(argc, argv, "--texture-upload-ms", 2);
+	// --compress-textures stores JPG/PNG images block compressed, encoded on the CPU after decoding
+	textureManager.setCompression(Utility::hasArgument(argc, argv, "--compress-textures"));
+	// --mip-filter box|kaiser picks the CPU mip filter, "driver" leaves uncompressed chains to glGenerateMipmap
+	std::string mipFilter = Utility::getStringArgument(argc, argv, "--mip-filter", "kaiser");
+	textureManager.setMipGeneration(mipFilter != "driver", mipFilter == "box" ? MipGenerator::FILTER_BOX : MipGenerator::FILTER_KAISER);
+	// decoded images and their filtered or compressed levels are kept in texturecache/, so the next start (a warm one)
+	// skips that work
+	if (Utility::hasArgument(argc, argv, "--no-texture-cache")) {
+		textureManager.setCacheDirectory("");
+	}
+	// --stream-textures keeps only the mip levels the textures' size on screen needs in video memory
+	textureManager.setStreaming(Utility::hasArgument(argc, argv, "--stream-textures"));
+	SamplerState containerSampler;
+	containerSampler.minFilter = GL_NEAREST_MIPMAP_NEAREST;
+	containerSampler.magFilter = GL_NEAREST;
+	auto textureLoadStart = std::chrono::steady_clock::now();
+	// both are colour images, their mip chains are filtered in linear light
+	TextureHandle texture = textureManager.loadAsync("textures/container.jpg", containerSampler, COLOR_SPACE_SRGB);
+	SamplerState faceSampler;
+	faceSampler.wrapS = GL_MIRRORED_REPEAT;
+	faceSampler.wrapT = GL_MIRRORED_REPEAT;
+	TextureHandle texture2 = textureManager.loadAsync("textures/awesomeface.png", faceSampler, COLOR_SPACE_SRGB);
+	bool texturesResident = false;
 
 	// uniform value for mixing texture 
 	float diffBetweenTextures = 0.2f;
+	// hashed at compile time, the render loop only does a table lookup
+	constexpr UniformId textureDiffUniform("textureDiff");
+
+	// without a window everything is drawn into an offscreen framebuffer
+	Offscreen::RenderTarget offscreenTarget;
+	if (headless) {
+		offscreenTarget = Offscreen::createRenderTarget(screenWidth, screenHeight);
+		Offscreen::bind(offscreenTarget);
+	}
+	if (benchmark == "instancing") {
+		shaderCompiler.finishAll();
+		Benchmark::runInstancing(instancedProgram, instancedVAO, instanceBuffer, textureAtlas, (unsigned int)hexagonIndices.count, hexagonIndices.type,
+			Utility::getIntArgument(argc, argv, "--max-instances", 1000000));
+	}
+	bool benchmarkPassed = true;
+	if (benchmark == "mesh") {
+		Benchmark::runMeshOptimizer(Utility::getIntArgument(argc, argv, "--grid", 1000));
+	}
+	if (benchmark == "vertices") {
+		benchmarkPassed = Benchmark::runVertexCompression((size_t)Utility::getIntArgument(argc, argv, "--vertices", 1000000));
+	}
+	if (benchmark == "import") {
+		benchmarkPassed = Benchmark::runImport(Utility::getIntArgument(argc, argv, "--grid", 1000),
+			Utility::getIntArgument(argc, argv, "--threads", 0));
+	}
+	if (benchmark == "textures" || benchmark == "pixels") {
+		const char* imagePath = Utility::getStringArgument(argc, argv, "--image", NULL);
+		std::vector<std::string> images;
+		if (imagePath) {
+			images.push_back(imagePath);
+		}
+		else {
+			images = { "textures/container.jpg", "textures/awesomeface.png" };
+		}
+		if (benchmark == "textures") {
+			benchmarkPassed = Benchmark::runTextureCompression(images, Utility::getIntArgument(argc, argv, "--threads", 0));
+		}
+		else {
+			benchmarkPassed = Benchmark::runPixelConversion(images);
+		}
+	}
+	if (benchmark == "decoders") {
+		const char* imagePath = Utility::getStringArgument(argc, argv, "--image", NULL);
+		std::vector<std::string> images = imagePath ? std::vector<std::string>{ imagePath } :
+			Benchmark::findImages(Utility::getStringArgument(argc, argv, "--corpus", "textures"));
+		benchmarkPassed = Benchmark::runImageDecoders(images);
+	}
+	if (!benchmark.empty()) {
+		Offscreen::destroyRenderTarget(offscreenTarget);
+		return benchmarkPassed ? 0 : -1;
+	}
+
+	// GPU timer queries around each part of the frame
+	GpuProfiler profiler;
+	// draws are collected during the frame and issued sorted by state
+	RenderQueue renderQueue;
+	int frameCount = 0;
+	auto loopStart = std::chrono::steady_clock::now();
 
 	// ============================== render loop ================================
-	while (!glfwWindowShouldClose(window)) {
+	while (headless ? frameCount < headlessFrames : !Window::shouldClose(window)) {
 		// ======================== Listening to Key Events ===========================
 		// listen to escape key being pressed to close the GLFW window
-		Window::processInput(window);
-		Utility::increaseTextureDiff(window, &diffBetweenTextures);
+		if (!headless) {
+			Window::processInput(window);
+			Utility::increaseTextureDiff(window, &diffBetweenTextures);
+		}
 		
 		// ============================================================================
+
+		// swap in any shader program the driver finished compiling
+		shaderWatcher.poll();
+		shaderCompiler.poll();
+		profiler.beginFrame();
+		// upload whatever the texture decoders finished, within this frame's budget
+		{
+			GpuScope scope(profiler, "textures");
+			textureManager.update(textureUploadMs);
+		}
+		if (!texturesResident && textureManager.getPendingCount() == 0) {
+			texturesResident = true;
+			if (printProfile) {
+				// a warm start found every image in the cache and decoded none
+				const TextureManager::Statistics& textureStatistics = textureManager.getStatistics();
+				double textureMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - textureLoadStart).count();
+				std::cout << "Textures resident after " << frameCount + 1 << " frames, " << textureMs << " ms ("
+					<< (textureStatistics.imagesDecoded == 0 ? "warm" : "cold") << " start: " << textureStatistics.cacheHits
+					<< " read from the cache, " << textureStatistics.imagesDecoded << " decoded)" << std::endl;
+			}
+		}
 		 
 		// rendering commands here
-		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT);
+		{
+			GpuScope scope(profiler, "clear");
+			glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+		}
 
 		// ====================== Drawing =======================		
 
-		// apply the first texture
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture);
-		// apply the second texture
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, texture2);
+		{
+			GpuScope scope(profiler, "draw");
+			// the hexagon spans one unit of normalized device coordinates each way with the whole texture on it, half
+			// the framebuffer. meshes could be any size, they ask for every level
+			int framebufferWidth = screenWidth;
+			int framebufferHeight = screenHeight;
+			if (!headless) {
+				Window::getFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+			}
+			float textureScreenWidth = loadedMesh.VAO != 0 ? 1e9f : framebufferWidth * 0.5f;
+			float textureScreenHeight = loadedMesh.VAO != 0 ? 1e9f : framebufferHeight * 0.5f;
+			texture.requestScreenSize(textureScreenWidth, textureScreenHeight);
+			texture2.requestScreenSize(textureScreenWidth, textureScreenHeight);
+			// the hexagon with both textures and the mix ratio between them
+			DrawPacket hexagon;
+			hexagon.shader = activeProgram;
+			hexagon.setTexture(0, texture.getID());
+			hexagon.setTexture(1, texture2.getID());
+			hexagon.vertexArray = VAO;
+			hexagon.indexType = hexagonIndices.type;
+			hexagon.indexCount = (unsigned int)hexagonIndices.count;
+			hexagon.setFloat(textureDiffUniform, diffBetweenTextures);
+			// the animated grid is regenerated into this frame's region of the stream buffer
+			if (animateInstances && instanceCount > 0) {
+				instanceStream.beginFrame();
+				StreamBuffer::Allocation allocation = instanceStream.allocate(instances.size() * sizeof(InstanceData));
+				if (allocation.pointer) {
+					InstanceData* streamed = (InstanceData*)allocation.pointer;
+					float time = frameCount / 60.0f;
+					for (size_t i = 0; i < instances.size(); i++) {
+						streamed[i] = instances[i];
+						streamed[i].offset[1] += 0.02f * std::sin(time * 3.0f + instances[i].offset[0] * 6.0f);
+					}
+					instanceStream.finishWrites();
+					GLState::bindVertexArray(instancedVAO);
+					InstanceBuffer::attachBuffer(instanceStream.getID(), allocation.offset);
+				}
+			}
+			// or a whole grid of them in one draw call
+			if (instanceCount > 0 && instancedProgram.getID() != 0) {
+				hexagon.shader = &instancedProgram;
+				hexagon.vertexArray = instancedVAO;
+				hexagon.instanceCount = instanceCount;
+				hexagon.textureCount = 0;
+				hexagon.setTexture(0, textureAtlas.getID(), GL_TEXTURE_2D_ARRAY);
+			}
+			if (loadedMesh.VAO != 0) {
+				// one draw per submesh, all sharing the hexagon's program and textures
+				for (const Submesh& submesh : loadedMesh.submeshes) {
+					DrawPacket packet = hexagon;
+					packet.shader = activeProgram;
+					packet.instanceCount = 1;
+					packet.textureCount = 0;
+					packet.setTexture(0, texture.getID());
+					packet.setTexture(1, texture2.getID());
+					packet.vertexArray = loadedMesh.VAO;
+					packet.indexType = loadedMesh.indexType;
+					packet.indexOffset = (size_t)submesh.firstIndex * loadedMesh.indexSize;
+					packet.indexCount = submesh.indexCount;
+					renderQueue.submit(packet);
+				}
+			}
+			else {
+				renderQueue.submit(hexagon);
+			}
 
-		// apply the mix ratio between the textures
-		shaderProgram.setFloat("textureDiff", diffBetweenTextures);
+			// sorts by state and issues every draw of the frame
+			renderQueue.flush();
+			if (animateInstances && instanceCount > 0) {
+				instanceStream.endFrame();
+			}
+		}
 
-		// draw the object
-		glBindVertexArray(VAO);
-		glDrawElements(GL_TRIANGLES, 12, GL_UNSIGNED_INT, 0);
+		profiler.endFrame();
+		if (printProfile && frameCount % 600 == 599) {
+			profiler.printReport();
+			GLState::printCounters();
+		}
 	
 		// listen to events
-		glfwSwapBuffers(window);
-		glfwPollEvents();
+		if (!headless) {
+			Window::swapBuffers(window);
+		}
+		frameCount++;
 	}
-	// delete all GLFW resources before terminating the program
-	glfwTerminate();
+
+	if (headless) {
+		// read the last frame back, this also waits for every queued frame to finish
+		std::vector<unsigned char> pixels;
+		Offscreen::readPixels(offscreenTarget, pixels);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loopStart).count();
+		std::cout << "Headless: rendered " << frameCount << " frames in " << seconds * 1000.0 << " ms ("
+			<< (seconds > 0.0 ? frameCount / seconds : 0.0) << " fps)" << std::endl;
+		if (printProfile) {
+			profiler.printReport();
+			GLState::printCounters();
+			textureManager.printStatistics();
+			if (animateInstances) {
+				const StreamBuffer::Statistics& streamStatistics = instanceStream.getStatistics();
+				std::cout << "Instance stream (" << (instanceStream.isPersistent() ? "persistent" : "map range") << "): "
+					<< streamStatistics.bytes / (1024 * 1024) << " MB in " << streamStatistics.frames << " frames, "
+					<< streamStatistics.stalls << " stalls" << std::endl;
+			}
+		}
+		if (headlessOutput) {
+			Offscreen::writePPM(headlessOutput, pixels, offscreenTarget.width, offscreenTarget.height);
+		}
+		Offscreen::destroyRenderTarget(offscreenTarget);
+	}
+	MeshFile::destroy(loadedMesh);
+	GLState::deleteVertexArray(VAO);
+	GLState::deleteVertexArray(instancedVAO);
+	GLState::deleteBuffer(VBO);
+	GLState::deleteBuffer(EBO);
 	return 0;
 }
+
+
+int main(int argc, char* argv[]) {
+
+	// --headless renders a fixed number of frames into an offscreen framebuffer instead of a window, benchmarks
+	// always run headless
+	bool headless = Utility::hasArgument(argc, argv, "--headless") || Utility::hasArgument(argc, argv, "--benchmark");
+
+	// --convert model.obj|gltf|glb --to model.mesh writes the binary mesh format and exits, no OpenGL needed
+	const char* convertPath = Utility::getStringArgument(argc, argv, "--convert", NULL);
+	if (convertPath) {
+		return MeshConverter::convert(convertPath, Utility::getStringArgument(argc, argv, "--to", "model.mesh"),
+			Utility::hasArgument(argc, argv, "--compact-vertices")) ? 0 : -1;
+	}
+	
+	// initialize OpenGL version and the glfw window (or the headless context)
+	GLFWwindow* window = NULL;
+	if (headless) {
+		if (!Window::initializeHeadless(screenWidth, screenHeight, 3)) {
+			return -1;
+		}
+	}
+	else {
+		window = Window::initializeWindow(screenWidth, screenHeight, "LearnOpenGL", 3);
+		if (window == NULL) {
+			return -1;
+		}
+	}
+	int result = run(argc, argv, window);
+	// every GL object has been deleted by now, the context can go
+	if (headless) {
+		Window::terminateHeadless();
+	}
+	else {
+		Window::terminateWindow();
+	}
+	return result;
+}
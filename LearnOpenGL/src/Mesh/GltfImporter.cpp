@@ -0,0 +1,649 @@
+#include <iostream>
+#include <memory>
+#include <string>
+#include <cstring>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "GltfImporter.h"
+#include "../Utility/Json.h"
+#include "../Utility/MappedFile.h"
+
+namespace GltfImporter {
+
+	// glTF componentType values
+	const unsigned int COMPONENT_BYTE = 5120;
+	const unsigned int COMPONENT_UNSIGNED_BYTE = 5121;
+	const unsigned int COMPONENT_SHORT = 5122;
+	const unsigned int COMPONENT_UNSIGNED_SHORT = 5123;
+	const unsigned int COMPONENT_UNSIGNED_INT = 5125;
+	const unsigned int COMPONENT_FLOAT = 5126;
+	const int MODE_TRIANGLES = 4;
+
+	// a .glb starts with a 12 byte header followed by a JSON chunk and an optional binary chunk
+	const unsigned int GLB_MAGIC = 0x46546C67;
+	const unsigned int GLB_CHUNK_JSON = 0x4E4F534A;
+	const unsigned int GLB_CHUNK_BIN = 0x004E4942;
+
+	struct Buffer {
+		const unsigned char* data = NULL;
+		size_t size = 0;
+	};
+
+	// where the elements of an accessor live, already bounds checked against its buffer
+	struct Accessor {
+		const unsigned char* data = NULL;
+		size_t stride = 0;
+		size_t count = 0;
+		unsigned int componentType = 0;
+		int components = 0;
+		bool normalized = false;
+	};
+
+	struct Primitive {
+		Accessor position;
+		Accessor color;
+		Accessor texCoord;
+		Accessor indices;
+	};
+
+	// one primitive as placed by one node
+	struct Instance {
+		const Primitive* primitive;
+		float transform[16];
+		// mirroring transforms turn the triangles inside out, their winding is swapped to compensate
+		bool flipWinding;
+		size_t firstVertex;
+		size_t firstIndex;
+	};
+
+	// everything the buffers point into, kept alive until the mesh is built
+	struct Document {
+		Json::Value root;
+		std::vector<std::unique_ptr<MappedFile>> files;
+		std::vector<std::vector<unsigned char>> decoded;
+		std::vector<Buffer> buffers;
+		std::vector<std::vector<Primitive>> meshes;
+	};
+
+	static size_t componentSize(unsigned int componentType) {
+		switch (componentType) {
+		case COMPONENT_BYTE:
+		case COMPONENT_UNSIGNED_BYTE:
+			return 1;
+		case COMPONENT_SHORT:
+		case COMPONENT_UNSIGNED_SHORT:
+			return 2;
+		case COMPONENT_UNSIGNED_INT:
+		case COMPONENT_FLOAT:
+			return 4;
+		default:
+			return 0;
+		}
+	}
+
+	static int typeComponents(const std::string& type) {
+		if (type == "SCALAR") return 1;
+		if (type == "VEC2") return 2;
+		if (type == "VEC3") return 3;
+		if (type == "VEC4") return 4;
+		return 0;
+	}
+
+	// one component as float, normalized integers map to [0, 1] or [-1, 1]
+	static float readComponent(const unsigned char* source, unsigned int componentType, bool normalized) {
+		switch (componentType) {
+		case COMPONENT_FLOAT: {
+			float value;
+			memcpy(&value, source, sizeof(value));
+			return value;
+		}
+		case COMPONENT_UNSIGNED_BYTE:
+			return normalized ? *source / 255.0f : (float)*source;
+		case COMPONENT_BYTE: {
+			signed char value = (signed char)*source;
+			return normalized ? std::max(value / 127.0f, -1.0f) : (float)value;
+		}
+		case COMPONENT_UNSIGNED_SHORT: {
+			unsigned short value;
+			memcpy(&value, source, sizeof(value));
+			return normalized ? value / 65535.0f : (float)value;
+		}
+		case COMPONENT_SHORT: {
+			short value;
+			memcpy(&value, source, sizeof(value));
+			return normalized ? std::max(value / 32767.0f, -1.0f) : (float)value;
+		}
+		default:
+			return 0.0f;
+		}
+	}
+
+	// reads up to count components of element index, the rest of out is left alone
+	static void readElement(const Accessor& accessor, size_t index, float* out, int count) {
+		const unsigned char* element = accessor.data + index * accessor.stride;
+		size_t size = componentSize(accessor.componentType);
+		for (int i = 0; i < std::min(count, accessor.components); i++) {
+			out[i] = readComponent(element + i * size, accessor.componentType, accessor.normalized);
+		}
+	}
+
+	static unsigned int readIndex(const Accessor& accessor, size_t index) {
+		const unsigned char* element = accessor.data + index * accessor.stride;
+		switch (accessor.componentType) {
+		case COMPONENT_UNSIGNED_BYTE:
+			return *element;
+		case COMPONENT_UNSIGNED_SHORT: {
+			unsigned short value;
+			memcpy(&value, element, sizeof(value));
+			return value;
+		}
+		default: {
+			unsigned int value;
+			memcpy(&value, element, sizeof(value));
+			return value;
+		}
+		}
+	}
+
+	static int base64Value(char c) {
+		if (c >= 'A' && c <= 'Z') return c - 'A';
+		if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+		if (c >= '0' && c <= '9') return c - '0' + 52;
+		if (c == '+' || c == '-') return 62;
+		if (c == '/' || c == '_') return 63;
+		return -1;
+	}
+
+	static void decodeBase64(const std::string& text, size_t start, std::vector<unsigned char>& out) {
+		unsigned int bits = 0;
+		int bitCount = 0;
+		for (size_t i = start; i < text.size(); i++) {
+			int value = base64Value(text[i]);
+			if (value < 0) {
+				// padding
+				break;
+			}
+			bits = (bits << 6) | (unsigned int)value;
+			bitCount += 6;
+			if (bitCount >= 8) {
+				bitCount -= 8;
+				out.push_back((unsigned char)(bits >> bitCount));
+			}
+		}
+	}
+
+	// URIs are relative to the .gltf and may be percent encoded
+	static std::string resolveUri(const char* path, const std::string& uri) {
+		std::string decoded;
+		for (size_t i = 0; i < uri.size(); i++) {
+			if (uri[i] == '%' && i + 2 < uri.size()) {
+				decoded += (char)strtol(uri.substr(i + 1, 2).c_str(), NULL, 16);
+				i += 2;
+			}
+			else {
+				decoded += uri[i];
+			}
+		}
+		std::string directory(path);
+		size_t slash = directory.find_last_of("/\\");
+		directory = slash == std::string::npos ? "" : directory.substr(0, slash + 1);
+		return directory + decoded;
+	}
+
+	static bool fail(const char* error, const std::string& detail) {
+		std::cout << "ERROR::GLTF_IMPORTER::" << error << " " << detail << std::endl;
+		return false;
+	}
+
+	// a JSON number used as an index, count or byte size. false for negative, fractional and too large ones, casting
+	// those to size_t would be undefined
+	static bool toIndex(double value, size_t& out) {
+		// 2^64 (2^32) as a double, every integer below it fits. NaN fails the first comparison
+		static const double limit = std::ldexp(1.0, std::numeric_limits<size_t>::digits);
+		if (!(value >= 0.0) || value >= limit || value != std::floor(value)) {
+			return false;
+		}
+		out = (size_t)value;
+		return true;
+	}
+
+	// splits a .glb into its JSON text and binary chunk, or takes a .gltf as it is
+	static bool readContainer(const char* path, const MappedFile& file, const char*& json, size_t& jsonSize, Buffer& binary) {
+		unsigned int header[3] = {};
+		if (file.size() >= sizeof(header)) {
+			memcpy(header, file.data(), sizeof(header));
+		}
+		if (header[0] != GLB_MAGIC) {
+			json = (const char*)file.data();
+			jsonSize = file.size();
+			return true;
+		}
+		size_t offset = sizeof(header);
+		size_t length = std::min<size_t>(header[2], file.size());
+		json = NULL;
+		while (offset + 8 <= length) {
+			unsigned int chunk[2];
+			memcpy(chunk, file.data() + offset, sizeof(chunk));
+			offset += sizeof(chunk);
+			if (chunk[0] > length - offset) {
+				return fail("TRUNCATED", path);
+			}
+			if (chunk[1] == GLB_CHUNK_JSON && json == NULL) {
+				json = (const char*)file.data() + offset;
+				jsonSize = chunk[0];
+			}
+			else if (chunk[1] == GLB_CHUNK_BIN && binary.data == NULL) {
+				binary.data = file.data() + offset;
+				binary.size = chunk[0];
+			}
+			offset += chunk[0];
+		}
+		return json != NULL || fail("NO_JSON_CHUNK", path);
+	}
+
+	static bool loadBuffers(const char* path, const Buffer& binary, Document& document) {
+		const Json::Value* buffers = document.root.find("buffers");
+		size_t count = buffers != NULL ? buffers->size() : 0;
+		for (size_t i = 0; i < count; i++) {
+			const Json::Value& description = (*buffers)[i];
+			size_t byteLength;
+			if (!toIndex(description.getNumber("byteLength", 0.0), byteLength)) {
+				return fail("BAD_BUFFER", "byteLength of buffer " + std::to_string(i));
+			}
+			std::string uri = description.getString("uri", "");
+			Buffer buffer;
+			if (uri.empty()) {
+				// the .glb binary chunk, only valid for the first buffer
+				buffer = i == 0 ? binary : Buffer();
+			}
+			else if (uri.compare(0, 5, "data:") == 0) {
+				size_t comma = uri.find(";base64,");
+				if (comma == std::string::npos) {
+					return fail("UNSUPPORTED_URI", uri.substr(0, 32));
+				}
+				document.decoded.emplace_back();
+				decodeBase64(uri, comma + 8, document.decoded.back());
+				buffer.data = document.decoded.back().data();
+				buffer.size = document.decoded.back().size();
+			}
+			else {
+				std::string bufferPath = resolveUri(path, uri);
+				document.files.emplace_back(new MappedFile());
+				if (!document.files.back()->open(bufferPath.c_str())) {
+					return fail("MISSING_BUFFER", bufferPath);
+				}
+				buffer.data = document.files.back()->data();
+				buffer.size = document.files.back()->size();
+			}
+			if (buffer.size < byteLength) {
+				return fail("TRUNCATED", "buffer " + std::to_string(i));
+			}
+			document.buffers.push_back(buffer);
+		}
+		return true;
+	}
+
+	// looks up accessor index and checks every element lies inside its buffer
+	static bool resolveAccessor(const Document& document, double index, Accessor& accessor) {
+		const Json::Value* accessors = document.root.find("accessors");
+		const Json::Value* views = document.root.find("bufferViews");
+		size_t accessorIndex;
+		if (accessors == NULL || !toIndex(index, accessorIndex) || accessorIndex >= accessors->size()) {
+			return fail("BAD_ACCESSOR", std::to_string(index));
+		}
+		const Json::Value& description = (*accessors)[accessorIndex];
+		if (description.find("sparse") != NULL || description.find("bufferView") == NULL) {
+			return fail("UNSUPPORTED_ACCESSOR", "sparse or without a buffer view");
+		}
+		size_t viewIndex;
+		if (views == NULL || !toIndex(description.getNumber("bufferView", -1.0), viewIndex) || viewIndex >= views->size()) {
+			return fail("BAD_BUFFER_VIEW", "of accessor " + std::to_string(accessorIndex));
+		}
+		const Json::Value& view = (*views)[viewIndex];
+		size_t bufferIndex;
+		if (!toIndex(view.getNumber("buffer", -1.0), bufferIndex) || bufferIndex >= document.buffers.size()) {
+			return fail("BAD_BUFFER_VIEW", std::to_string(viewIndex));
+		}
+		const Buffer& buffer = document.buffers[bufferIndex];
+
+		size_t componentType;
+		size_t viewOffset;
+		size_t viewLength;
+		size_t offset;
+		if (!toIndex(description.getNumber("componentType", 0.0), componentType) || componentType > 0xFFFFFFFFu ||
+			!toIndex(description.getNumber("count", 0.0), accessor.count) ||
+			!toIndex(description.getNumber("byteOffset", 0.0), offset)) {
+			return fail("BAD_ACCESSOR", std::to_string(accessorIndex));
+		}
+		if (!toIndex(view.getNumber("byteOffset", 0.0), viewOffset) || !toIndex(view.getNumber("byteLength", 0.0), viewLength)) {
+			return fail("BAD_BUFFER_VIEW", std::to_string(viewIndex));
+		}
+		accessor.componentType = (unsigned int)componentType;
+		accessor.components = typeComponents(description.getString("type", ""));
+		accessor.normalized = description.find("normalized") != NULL && description.find("normalized")->boolean;
+		size_t elementSize = componentSize(accessor.componentType) * accessor.components;
+		if (elementSize == 0) {
+			return fail("UNSUPPORTED_ACCESSOR", description.getString("type", "?"));
+		}
+		// checked before it divides below, a stride of 0 or one shorter than an element is never valid
+		if (!toIndex(view.getNumber("byteStride", (double)elementSize), accessor.stride) || accessor.stride < elementSize) {
+			return fail("BAD_BUFFER_VIEW", "byteStride of buffer view " + std::to_string(viewIndex));
+		}
+		// the last element has to end inside the view, written so nothing can overflow
+		bool insideBuffer = viewOffset <= buffer.size && viewLength <= buffer.size - viewOffset;
+		bool insideView = accessor.count == 0 || (offset <= viewLength && elementSize <= viewLength - offset &&
+			accessor.count - 1 <= (viewLength - offset - elementSize) / accessor.stride);
+		if (!insideBuffer || !insideView) {
+			return fail("TRUNCATED", "accessor " + std::to_string(accessorIndex));
+		}
+		accessor.data = buffer.data + viewOffset + offset;
+		return true;
+	}
+
+	static bool loadMeshes(Document& document) {
+		const Json::Value* meshes = document.root.find("meshes");
+		size_t count = meshes != NULL ? meshes->size() : 0;
+		document.meshes.resize(count);
+		size_t skippedPrimitives = 0;
+		for (size_t i = 0; i < count; i++) {
+			const Json::Value* primitives = (*meshes)[i].find("primitives");
+			for (size_t p = 0; primitives != NULL && p < primitives->size(); p++) {
+				const Json::Value& description = (*primitives)[p];
+				const Json::Value* attributes = description.find("attributes");
+				if (description.getNumber("mode", MODE_TRIANGLES) != MODE_TRIANGLES || attributes == NULL ||
+					attributes->find("POSITION") == NULL) {
+					skippedPrimitives++;
+					continue;
+				}
+				Primitive primitive;
+				if (!resolveAccessor(document, attributes->getNumber("POSITION", -1.0), primitive.position) ||
+					(attributes->find("COLOR_0") != NULL && !resolveAccessor(document, attributes->getNumber("COLOR_0", -1.0), primitive.color)) ||
+					(attributes->find("TEXCOORD_0") != NULL && !resolveAccessor(document, attributes->getNumber("TEXCOORD_0", -1.0), primitive.texCoord)) ||
+					(description.find("indices") != NULL && !resolveAccessor(document, description.getNumber("indices", -1.0), primitive.indices))) {
+					return false;
+				}
+				if (primitive.position.count == 0) {
+					skippedPrimitives++;
+					continue;
+				}
+				bool validIndices = primitive.indices.data == NULL || (primitive.indices.components == 1 &&
+					(primitive.indices.componentType == COMPONENT_UNSIGNED_BYTE || primitive.indices.componentType == COMPONENT_UNSIGNED_SHORT ||
+						primitive.indices.componentType == COMPONENT_UNSIGNED_INT));
+				if (primitive.position.components != 3 || !validIndices ||
+					(primitive.color.data != NULL && primitive.color.count < primitive.position.count) ||
+					(primitive.texCoord.data != NULL && primitive.texCoord.count < primitive.position.count)) {
+					return fail("BAD_PRIMITIVE", "mesh " + std::to_string(i) + " primitive " + std::to_string(p));
+				}
+				document.meshes[i].push_back(primitive);
+			}
+		}
+		if (skippedPrimitives > 0) {
+			std::cout << "WARNING::GLTF_IMPORTER::SKIPPED_PRIMITIVES " << skippedPrimitives
+				<< " primitives are empty or not triangle lists" << std::endl;
+		}
+		return true;
+	}
+
+	// column major 4x4 matrices, like glTF stores them
+	static void multiply(const float* a, const float* b, float* out) {
+		float result[16];
+		for (int column = 0; column < 4; column++) {
+			for (int row = 0; row < 4; row++) {
+				float sum = 0.0f;
+				for (int k = 0; k < 4; k++) {
+					sum += a[k * 4 + row] * b[column * 4 + k];
+				}
+				result[column * 4 + row] = sum;
+			}
+		}
+		memcpy(out, result, sizeof(result));
+	}
+
+	static void readArray(const Json::Value& node, const char* key, float* out, size_t count) {
+		const Json::Value* values = node.find(key);
+		for (size_t i = 0; values != NULL && i < std::min(count, values->size()); i++) {
+			out[i] = (float)(*values)[i].number;
+		}
+	}
+
+	// the node's matrix, or translation * rotation * scale
+	static void localTransform(const Json::Value& node, float* out) {
+		static const float identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+		memcpy(out, identity, sizeof(identity));
+		if (node.find("matrix") != NULL) {
+			readArray(node, "matrix", out, 16);
+			return;
+		}
+		float t[3] = { 0.0f, 0.0f, 0.0f };
+		float q[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		float s[3] = { 1.0f, 1.0f, 1.0f };
+		readArray(node, "translation", t, 3);
+		readArray(node, "rotation", q, 4);
+		readArray(node, "scale", s, 3);
+		float x = q[0], y = q[1], z = q[2], w = q[3];
+		float rotation[9] = {
+			1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w),
+			2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w),
+			2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y)
+		};
+		for (int column = 0; column < 3; column++) {
+			for (int row = 0; row < 3; row++) {
+				out[column * 4 + row] = rotation[column * 3 + row] * s[column];
+			}
+			out[12 + column] = t[column];
+		}
+	}
+
+	static float determinant3x3(const float* m) {
+		return m[0] * (m[5] * m[10] - m[9] * m[6]) - m[4] * (m[1] * m[10] - m[9] * m[2]) + m[8] * (m[1] * m[6] - m[5] * m[2]);
+	}
+
+	static bool collectInstances(const Document& document, size_t nodeIndex, const float* parent, int depth, std::vector<Instance>& instances) {
+		const Json::Value* nodes = document.root.find("nodes");
+		if (nodes == NULL || nodeIndex >= nodes->size() || depth > (int)nodes->size()) {
+			return fail("BAD_NODE", std::to_string(nodeIndex));
+		}
+		const Json::Value& node = (*nodes)[nodeIndex];
+		float local[16];
+		float world[16];
+		localTransform(node, local);
+		multiply(parent, local, world);
+		bool hasMesh = node.find("mesh") != NULL;
+		size_t meshIndex = 0;
+		if (hasMesh && (!toIndex(node.getNumber("mesh", -1.0), meshIndex) || meshIndex >= document.meshes.size())) {
+			return fail("BAD_NODE", std::to_string(nodeIndex));
+		}
+		if (hasMesh) {
+			for (const Primitive& primitive : document.meshes[meshIndex]) {
+				Instance instance;
+				instance.primitive = &primitive;
+				memcpy(instance.transform, world, sizeof(world));
+				instance.flipWinding = determinant3x3(world) < 0.0f;
+				instances.push_back(instance);
+			}
+		}
+		const Json::Value* children = node.find("children");
+		for (size_t i = 0; children != NULL && i < children->size(); i++) {
+			size_t child;
+			if (!toIndex((*children)[i].number, child)) {
+				return fail("BAD_NODE", "child " + std::to_string(i) + " of node " + std::to_string(nodeIndex));
+			}
+			if (!collectInstances(document, child, world, depth + 1, instances)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// the default scene, or every mesh once when the file has no scenes
+	static bool collectScene(const Document& document, std::vector<Instance>& instances) {
+		static const float identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+		const Json::Value* scenes = document.root.find("scenes");
+		if (scenes == NULL || scenes->size() == 0) {
+			for (const std::vector<Primitive>& mesh : document.meshes) {
+				for (const Primitive& primitive : mesh) {
+					Instance instance;
+					instance.primitive = &primitive;
+					memcpy(instance.transform, identity, sizeof(identity));
+					instance.flipWinding = false;
+					instances.push_back(instance);
+				}
+			}
+			return true;
+		}
+		size_t sceneIndex;
+		if (!toIndex(document.root.getNumber("scene", 0.0), sceneIndex) || sceneIndex >= scenes->size()) {
+			return fail("BAD_SCENE", std::to_string(document.root.getNumber("scene", 0.0)));
+		}
+		const Json::Value* nodes = (*scenes)[sceneIndex].find("nodes");
+		for (size_t i = 0; nodes != NULL && i < nodes->size(); i++) {
+			size_t node;
+			if (!toIndex((*nodes)[i].number, node)) {
+				return fail("BAD_NODE", "node " + std::to_string(i) + " of scene " + std::to_string(sceneIndex));
+			}
+			if (!collectInstances(document, node, identity, 0, instances)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static void buildVertices(const Instance& instance, size_t begin, size_t end, Mesh& mesh) {
+		const Primitive& primitive = *instance.primitive;
+		const float* m = instance.transform;
+		for (size_t i = begin; i < end; i++) {
+			StandardVertex& vertex = mesh.vertices[instance.firstVertex + i];
+			float position[3] = { 0.0f, 0.0f, 0.0f };
+			readElement(primitive.position, i, position, 3);
+			for (int row = 0; row < 3; row++) {
+				vertex.position[row] = m[row] * position[0] + m[4 + row] * position[1] + m[8 + row] * position[2] + m[12 + row];
+			}
+			vertex.color[0] = vertex.color[1] = vertex.color[2] = 1.0f;
+			if (primitive.color.data != NULL) {
+				readElement(primitive.color, i, vertex.color, 3);
+			}
+			vertex.texCoord[0] = vertex.texCoord[1] = 0.0f;
+			if (primitive.texCoord.data != NULL) {
+				readElement(primitive.texCoord, i, vertex.texCoord, 2);
+				// glTF puts v = 0 at the top of the image, the textures are uploaded bottom row first
+				vertex.texCoord[1] = 1.0f - vertex.texCoord[1];
+			}
+		}
+	}
+
+	// returns false if an index points past the primitive's vertices
+	static bool buildIndices(const Instance& instance, size_t begin, size_t end, Mesh& mesh) {
+		const Primitive& primitive = *instance.primitive;
+		unsigned int vertexCount = (unsigned int)primitive.position.count;
+		unsigned int firstVertex = (unsigned int)instance.firstVertex;
+		unsigned int* out = mesh.indices.data() + instance.firstIndex;
+		bool valid = true;
+		for (size_t i = begin; i < end; i++) {
+			unsigned int index = primitive.indices.data != NULL ? readIndex(primitive.indices, i) : (unsigned int)i;
+			valid = valid && index < vertexCount;
+			out[i] = firstVertex + std::min(index, vertexCount - 1);
+		}
+		if (instance.flipWinding) {
+			for (size_t i = begin; i + 2 < end; i += 3) {
+				std::swap(out[i + 1], out[i + 2]);
+			}
+		}
+		return valid;
+	}
+
+	bool load(const char* path, Mesh& mesh, ThreadPool& pool) {
+		mesh.vertices.clear();
+		mesh.indices.clear();
+		mesh.submeshes.clear();
+
+		MappedFile file;
+		if (!file.open(path)) {
+			return false;
+		}
+		Document document;
+		const char* json = NULL;
+		size_t jsonSize = 0;
+		Buffer binary;
+		std::string error;
+		if (!readContainer(path, file, json, jsonSize, binary)) {
+			return false;
+		}
+		if (!Json::parse(json, jsonSize, document.root, error)) {
+			return fail("BAD_JSON", error);
+		}
+		std::string version = document.root.find("asset") != NULL ? document.root.find("asset")->getString("version", "") : "";
+		if (version.compare(0, 2, "2.") != 0) {
+			return fail("UNSUPPORTED_VERSION", version);
+		}
+		std::vector<Instance> instances;
+		if (!loadBuffers(path, binary, document) || !loadMeshes(document) || !collectScene(document, instances)) {
+			return false;
+		}
+
+		// lay the instances out one after the other, triangle lists only use whole triangles
+		size_t vertexCount = 0;
+		size_t indexCount = 0;
+		for (Instance& instance : instances) {
+			const Primitive& primitive = *instance.primitive;
+			size_t instanceIndices = primitive.indices.data != NULL ? primitive.indices.count : primitive.position.count;
+			instance.firstVertex = vertexCount;
+			instance.firstIndex = indexCount;
+			vertexCount += primitive.position.count;
+			if (instanceIndices >= 3) {
+				mesh.submeshes.push_back(Submesh{ (unsigned int)indexCount, (unsigned int)(instanceIndices / 3 * 3) });
+				indexCount += instanceIndices / 3 * 3;
+			}
+		}
+		if (indexCount == 0) {
+			return fail("NO_TRIANGLES", path);
+		}
+		if (vertexCount > 0xFFFFFFFFull || indexCount > 0xFFFFFFFFull) {
+			return fail("TOO_LARGE", path);
+		}
+		if (mesh.submeshes.size() == 1) {
+			mesh.submeshes.clear();
+		}
+		mesh.vertices.resize(vertexCount);
+		mesh.indices.resize(indexCount);
+
+		// big primitives are cut into blocks so a single huge scan still spreads over every thread
+		struct Task {
+			const Instance* instance;
+			bool indices;
+			size_t begin;
+			size_t end;
+		};
+		const size_t blockSize = 64 * 1024;
+		std::vector<Task> tasks;
+		for (size_t i = 0; i < instances.size(); i++) {
+			const Instance& instance = instances[i];
+			size_t instanceVertices = instance.primitive->position.count;
+			size_t nextIndex = i + 1 < instances.size() ? instances[i + 1].firstIndex : indexCount;
+			size_t instanceIndices = nextIndex - instance.firstIndex;
+			for (size_t begin = 0; begin < instanceVertices; begin += blockSize) {
+				tasks.push_back(Task{ &instance, false, begin, std::min(instanceVertices, begin + blockSize) });
+			}
+			// multiples of 3 so the winding flip never straddles two blocks
+			for (size_t begin = 0; begin < instanceIndices; begin += blockSize * 3) {
+				tasks.push_back(Task{ &instance, true, begin, std::min(instanceIndices, begin + blockSize * 3) });
+			}
+		}
+		std::atomic<bool> validIndices(true);
+		pool.run(tasks.size(), [&](size_t i) {
+			const Task& task = tasks[i];
+			if (!task.indices) {
+				buildVertices(*task.instance, task.begin, task.end, mesh);
+			}
+			else if (!buildIndices(*task.instance, task.begin, task.end, mesh)) {
+				validIndices = false;
+			}
+		});
+		if (!validIndices) {
+			std::cout << "WARNING::GLTF_IMPORTER::INDEX_OUT_OF_RANGE " << path << " indices were clamped" << std::endl;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,17 @@
+#ifndef GLTF_IMPORTER_H
+#define GLTF_IMPORTER_H
+
+#include "Mesh.h"
+#include "../Utility/ThreadPool.h"
+
+// glTF 2.0 reader for .gltf (with external .bin or data: URI buffers) and binary .glb files. the default scene is
+// flattened with the node transforms applied, every triangle primitive becomes a submesh. POSITION, COLOR_0 and
+// TEXCOORD_0 are read, other attributes, materials and animation are ignored
+namespace GltfImporter {
+
+	// buffers are memory mapped and the accessors are decoded in parallel blocks on the pool
+	bool load(const char* path, Mesh& mesh, ThreadPool& pool = ThreadPool::shared());
+
+}
+
+#endif // GLTF_IMPORTER_H
@@ -0,0 +1,23 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include <vector>
+
+#include "../Renderer/VertexFormats.h"
+
+// range of the index buffer drawn as one piece (one material or object of the source file)
+struct Submesh {
+	unsigned int firstIndex;
+	unsigned int indexCount;
+};
+
+// indexed triangle list in the standard vertex format, what importers produce and MeshOptimizer works on
+struct Mesh {
+	std::vector<StandardVertex> vertices;
+	// three per triangle
+	std::vector<unsigned int> indices;
+	// empty when the whole index buffer is one piece, triangles are never reordered across submeshes
+	std::vector<Submesh> submeshes;
+};
+
+#endif // MESH_H
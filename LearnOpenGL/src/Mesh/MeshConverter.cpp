@@ -0,0 +1,63 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <algorithm>
+
+#include "MeshConverter.h"
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "ObjImporter.h"
+#include "GltfImporter.h"
+
+namespace MeshConverter {
+
+	static std::string getExtension(const char* path) {
+		std::string extension(path);
+		size_t dot = extension.find_last_of('.');
+		extension = dot == std::string::npos ? "" : extension.substr(dot + 1);
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)tolower(c); });
+		return extension;
+	}
+
+	bool convert(const char* inputPath, const char* outputPath, bool compactVertices) {
+		auto start = std::chrono::steady_clock::now();
+		auto elapsedMs = [&]() {
+			auto now = std::chrono::steady_clock::now();
+			double ms = std::chrono::duration<double, std::milli>(now - start).count();
+			start = now;
+			return ms;
+		};
+
+		Mesh mesh;
+		std::string extension = getExtension(inputPath);
+		bool imported = false;
+		if (extension == "obj") {
+			imported = ObjImporter::load(inputPath, mesh);
+		}
+		else if (extension == "gltf" || extension == "glb") {
+			imported = GltfImporter::load(inputPath, mesh);
+		}
+		else {
+			std::cout << "ERROR::MESH_CONVERTER::UNSUPPORTED_FORMAT " << inputPath << std::endl;
+			return false;
+		}
+		if (!imported) {
+			return false;
+		}
+		double importMs = elapsedMs();
+
+		MeshOptimizer::Report report = MeshOptimizer::optimize(mesh);
+		double optimizeMs = elapsedMs();
+
+		if (!MeshFile::write(outputPath, mesh, compactVertices)) {
+			return false;
+		}
+		double writeMs = elapsedMs();
+
+		std::cout << "Converted " << inputPath << " -> " << outputPath << ": " << mesh.indices.size() / 3 << " triangles, "
+			<< std::max<size_t>(mesh.submeshes.size(), 1) << " submeshes" << std::endl;
+		std::cout << "  import " << importMs << " ms, optimize " << optimizeMs << " ms, write " << writeMs << " ms" << std::endl;
+		MeshOptimizer::printReport("  cache", report);
+		return true;
+	}
+}
@@ -0,0 +1,13 @@
+#ifndef MESH_CONVERTER_H
+#define MESH_CONVERTER_H
+
+// offline conversion of model files into the binary MeshFile format
+namespace MeshConverter {
+
+	// imports the model (picked by extension), optimizes it and writes it as a mesh file,
+	// printing how long each step took
+	bool convert(const char* inputPath, const char* outputPath, bool compactVertices);
+
+}
+
+#endif // MESH_CONVERTER_H
@@ -0,0 +1,191 @@
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "../Renderer/GLState.h"
+#include "../Renderer/VertexCompression.h"
+
+namespace MeshFile {
+
+	static const char MAGIC[4] = { 'L', 'O', 'M', 'S' };
+
+	static_assert(sizeof(Header) == 96, "the header is written as is, its size must not depend on the compiler");
+	static_assert(sizeof(Submesh) == 8, "the submesh table is written as is");
+
+	static unsigned long long alignUp(unsigned long long value) {
+		return (value + STREAM_ALIGNMENT - 1) & ~(unsigned long long)(STREAM_ALIGNMENT - 1);
+	}
+
+	// zero bytes up to the next stream boundary
+	static void writePadding(std::ofstream& file, unsigned long long written) {
+		static const char zeros[STREAM_ALIGNMENT] = {};
+		file.write(zeros, (std::streamsize)(alignUp(written) - written));
+	}
+
+	// writes the mesh, optionally encoding the vertices as CompactVertex
+	bool write(const char* path, const Mesh& mesh, bool compactVertices) {
+		MeshOptimizer::IndexData indices = MeshOptimizer::packIndices(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+		std::vector<Submesh> submeshes = mesh.submeshes;
+		if (submeshes.empty()) {
+			submeshes.push_back(Submesh{ 0, (unsigned int)mesh.indices.size() });
+		}
+
+		Header header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, MAGIC, sizeof(MAGIC));
+		header.version = VERSION;
+		header.vertexFormat = compactVertices ? VERTEX_COMPACT : VERTEX_STANDARD;
+		header.vertexStride = compactVertices ? sizeof(CompactVertex) : sizeof(StandardVertex);
+		header.vertexCount = mesh.vertices.size();
+		header.vertexOffset = alignUp(sizeof(Header));
+		header.indexType = indices.type;
+		header.indexSize = indices.type == GL_UNSIGNED_SHORT ? 2 : 4;
+		header.indexCount = indices.count;
+		header.indexOffset = alignUp(header.vertexOffset + header.vertexCount * header.vertexStride);
+		header.submeshCount = (unsigned int)submeshes.size();
+		header.submeshOffset = alignUp(header.indexOffset + indices.bytes.size());
+		for (int axis = 0; axis < 3; axis++) {
+			header.boundsMin[axis] = mesh.vertices.empty() ? 0.0f : mesh.vertices[0].position[axis];
+			header.boundsMax[axis] = header.boundsMin[axis];
+		}
+		for (const StandardVertex& vertex : mesh.vertices) {
+			for (int axis = 0; axis < 3; axis++) {
+				header.boundsMin[axis] = std::min(header.boundsMin[axis], vertex.position[axis]);
+				header.boundsMax[axis] = std::max(header.boundsMax[axis], vertex.position[axis]);
+			}
+		}
+
+		std::ofstream file(path, std::ios::binary);
+		if (!file) {
+			std::cout << "ERROR::MESH_FILE::WRITE_FAILED " << path << std::endl;
+			return false;
+		}
+		file.write((const char*)&header, sizeof(header));
+		writePadding(file, sizeof(header));
+		if (compactVertices) {
+			std::vector<CompactVertex> compact(mesh.vertices.size());
+			VertexCompression::encodeVertices(mesh.vertices.data(), compact.data(), compact.size());
+			file.write((const char*)compact.data(), (std::streamsize)(compact.size() * sizeof(CompactVertex)));
+		}
+		else {
+			file.write((const char*)mesh.vertices.data(), (std::streamsize)(mesh.vertices.size() * sizeof(StandardVertex)));
+		}
+		writePadding(file, header.vertexOffset + header.vertexCount * header.vertexStride);
+		file.write((const char*)indices.bytes.data(), (std::streamsize)indices.bytes.size());
+		writePadding(file, header.indexOffset + indices.bytes.size());
+		file.write((const char*)submeshes.data(), (std::streamsize)(submeshes.size() * sizeof(Submesh)));
+		if (!file) {
+			std::cout << "ERROR::MESH_FILE::WRITE_FAILED " << path << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	// true when [offset, offset + count * size) lies inside the file, without overflowing
+	static bool isInside(unsigned long long offset, unsigned long long count, unsigned long long size, size_t fileSize) {
+		if (offset > fileSize || offset % STREAM_ALIGNMENT != 0) {
+			return false;
+		}
+		return size == 0 || count <= (fileSize - offset) / size;
+	}
+
+	// checks the header and that every stream lies inside the file, then fills in the view
+	bool open(const MappedFile& file, View& view) {
+		view = View();
+		if (file.data() == NULL || file.size() < sizeof(Header)) {
+			std::cout << "ERROR::MESH_FILE::TOO_SMALL" << std::endl;
+			return false;
+		}
+		const Header* header = (const Header*)file.data();
+		if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION) {
+			std::cout << "ERROR::MESH_FILE::WRONG_VERSION expected " << VERSION << " got " << header->version << std::endl;
+			return false;
+		}
+		bool validFormat = (header->vertexFormat == VERTEX_STANDARD && header->vertexStride == sizeof(StandardVertex)) ||
+			(header->vertexFormat == VERTEX_COMPACT && header->vertexStride == sizeof(CompactVertex));
+		bool validIndices = (header->indexType == GL_UNSIGNED_SHORT && header->indexSize == 2) ||
+			(header->indexType == GL_UNSIGNED_INT && header->indexSize == 4);
+		if (!validFormat || !validIndices) {
+			std::cout << "ERROR::MESH_FILE::UNKNOWN_FORMAT" << std::endl;
+			return false;
+		}
+		if (!isInside(header->vertexOffset, header->vertexCount, header->vertexStride, file.size()) ||
+			!isInside(header->indexOffset, header->indexCount, header->indexSize, file.size()) ||
+			!isInside(header->submeshOffset, header->submeshCount, sizeof(Submesh), file.size())) {
+			std::cout << "ERROR::MESH_FILE::TRUNCATED" << std::endl;
+			return false;
+		}
+		const Submesh* submeshes = (const Submesh*)(file.data() + header->submeshOffset);
+		for (unsigned int i = 0; i < header->submeshCount; i++) {
+			if ((unsigned long long)submeshes[i].firstIndex + submeshes[i].indexCount > header->indexCount) {
+				std::cout << "ERROR::MESH_FILE::BAD_SUBMESH " << i << std::endl;
+				return false;
+			}
+		}
+		view.header = header;
+		view.vertices = file.data() + header->vertexOffset;
+		view.indices = file.data() + header->indexOffset;
+		view.submeshes = submeshes;
+		return true;
+	}
+
+	// allocates the bound buffer and copies the stream into it through a mapping, the driver may hand out
+	// memory it can DMA from directly. falls back to glBufferSubData (still straight from the file mapping)
+	static void streamBuffer(GLenum target, const void* source, size_t bytes) {
+		glBufferData(target, bytes, NULL, GL_STATIC_DRAW);
+		if (bytes == 0) {
+			return;
+		}
+		void* destination = glMapBufferRange(target, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (destination != NULL) {
+			memcpy(destination, source, bytes);
+			if (glUnmapBuffer(target) == GL_TRUE) {
+				return;
+			}
+			// the contents were lost (e.g. a display mode change), upload them again
+		}
+		glBufferSubData(target, 0, bytes, source);
+	}
+
+	// creates the buffers and copies the streams from the mapping straight into glMapBufferRange'd memory
+	bool upload(const View& view, GpuMesh& mesh) {
+		if (view.header == NULL) {
+			return false;
+		}
+		const Header& header = *view.header;
+		glGenVertexArrays(1, &mesh.VAO);
+		glGenBuffers(1, &mesh.VBO);
+		glGenBuffers(1, &mesh.EBO);
+		GLState::bindVertexArray(mesh.VAO);
+
+		size_t vertexBytes = (size_t)(header.vertexCount * header.vertexStride);
+		size_t indexBytes = (size_t)(header.indexCount * header.indexSize);
+		GLState::bindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+		streamBuffer(GL_ARRAY_BUFFER, view.vertices, vertexBytes);
+		GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+		streamBuffer(GL_ELEMENT_ARRAY_BUFFER, view.indices, indexBytes);
+
+		if (header.vertexFormat == VERTEX_COMPACT) {
+			CompactVertexLayout::apply();
+		}
+		else {
+			StandardVertexLayout::apply();
+		}
+		mesh.indexType = header.indexType;
+		mesh.indexSize = header.indexSize;
+		mesh.vertexFormat = header.vertexFormat;
+		mesh.submeshes.assign(view.submeshes, view.submeshes + header.submeshCount);
+		mesh.size = vertexBytes + indexBytes;
+		return true;
+	}
+
+	void destroy(GpuMesh& mesh) {
+		GLState::deleteVertexArray(mesh.VAO);
+		GLState::deleteBuffer(mesh.VBO);
+		GLState::deleteBuffer(mesh.EBO);
+		mesh = GpuMesh();
+	}
+}
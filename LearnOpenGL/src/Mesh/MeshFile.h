@@ -0,0 +1,83 @@
+#ifndef MESH_FILE_H
+#define MESH_FILE_H
+
+#include <vector>
+#include <cstddef>
+
+#include <glad/glad.h>
+
+#include "Mesh.h"
+#include "../Utility/MappedFile.h"
+
+// binary mesh container that is memory mapped and copied straight into mapped GPU buffers, no parsing at load time.
+// layout: Header, then the vertex stream, the index stream and the submesh table, each starting on a
+// STREAM_ALIGNMENT boundary so every stream can be handed to the GPU (or read as structs) where it lies
+namespace MeshFile {
+
+	// bumped whenever the layout of anything below changes, older files are rejected
+	const unsigned int VERSION = 1;
+	const size_t STREAM_ALIGNMENT = 256;
+
+	enum VertexFormat : unsigned int {
+		// StandardVertex
+		VERTEX_STANDARD = 0,
+		// CompactVertex
+		VERTEX_COMPACT = 1
+	};
+
+	// stored as is (little endian), offsets are from the start of the file
+	struct Header {
+		// "LOMS"
+		char magic[4];
+		unsigned int version;
+		unsigned int vertexFormat;
+		unsigned int vertexStride;
+		unsigned long long vertexCount;
+		unsigned long long vertexOffset;
+		// GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+		unsigned int indexType;
+		unsigned int indexSize;
+		unsigned long long indexCount;
+		unsigned long long indexOffset;
+		unsigned int submeshCount;
+		unsigned int reserved;
+		unsigned long long submeshOffset;
+		float boundsMin[3];
+		float boundsMax[3];
+	};
+
+	// pointers into a mapped file, valid as long as the MappedFile stays open
+	struct View {
+		const Header* header = NULL;
+		const void* vertices = NULL;
+		const void* indices = NULL;
+		const Submesh* submeshes = NULL;
+	};
+
+	// the buffers a mesh file was uploaded into, the vertex array has the matching layout applied
+	struct GpuMesh {
+		unsigned int VAO = 0;
+		unsigned int VBO = 0;
+		unsigned int EBO = 0;
+		GLenum indexType = GL_UNSIGNED_INT;
+		unsigned int indexSize = 4;
+		unsigned int vertexFormat = VERTEX_STANDARD;
+		std::vector<Submesh> submeshes;
+		// bytes uploaded
+		size_t size = 0;
+	};
+
+	// writes the mesh, optionally encoding the vertices as CompactVertex. the mesh should already be optimized,
+	// indices are stored as 16 bit whenever possible
+	bool write(const char* path, const Mesh& mesh, bool compactVertices);
+
+	// checks the header and that every stream lies inside the file, then fills in the view
+	bool open(const MappedFile& file, View& view);
+
+	// creates the buffers and copies the streams from the mapping straight into glMapBufferRange'd memory
+	bool upload(const View& view, GpuMesh& mesh);
+	void destroy(GpuMesh& mesh);
+
+}
+
+#endif // MESH_FILE_H
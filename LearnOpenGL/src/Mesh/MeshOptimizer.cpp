@@ -0,0 +1,446 @@
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+#include "MeshOptimizer.h"
+
+namespace MeshOptimizer {
+
+	// LRU cache size Forsyth's scoring models
+	static const int FORSYTH_CACHE_SIZE = 32;
+	// valence scores are tabulated up to here, vertices used by more triangles share the last entry
+	static const unsigned int FORSYTH_MAX_VALENCE = 32;
+	static const unsigned int NO_VERTEX = ~0u;
+
+	// FNV-1a over the vertex, a word at a time, with a final mix so the low bits used by the table are well spread
+	static unsigned int hashBytes(const unsigned char* bytes, size_t length) {
+		unsigned int hash = 2166136261u;
+		size_t i = 0;
+		for (; i + 4 <= length; i += 4) {
+			unsigned int word;
+			memcpy(&word, bytes + i, sizeof(word));
+			hash = (hash ^ word) * 16777619u;
+		}
+		for (; i < length; i++) {
+			hash = (hash ^ bytes[i]) * 16777619u;
+		}
+		hash ^= hash >> 16;
+		hash *= 0x85ebca6bu;
+		hash ^= hash >> 13;
+		return hash;
+	}
+
+	static size_t nextPowerOfTwo(size_t value) {
+		size_t result = 1;
+		while (result < value) {
+			result <<= 1;
+		}
+		return result;
+	}
+
+	// merges vertices whose bytes are identical and rewrites the indices
+	size_t weldVertices(void* vertices, size_t vertexCount, size_t vertexSize, unsigned int* indices, size_t indexCount) {
+		unsigned char* data = (unsigned char*)vertices;
+		// open addressing, at most half full, holds indices into the already compacted vertices
+		size_t tableSize = nextPowerOfTwo(vertexCount * 2 + 1);
+		std::vector<unsigned int> table(tableSize, NO_VERTEX);
+		std::vector<unsigned int> remap(vertexCount);
+		size_t unique = 0;
+
+		for (size_t v = 0; v < vertexCount; v++) {
+			const unsigned char* vertex = data + v * vertexSize;
+			size_t slot = hashBytes(vertex, vertexSize) & (tableSize - 1);
+			while (table[slot] != NO_VERTEX && memcmp(data + table[slot] * vertexSize, vertex, vertexSize) != 0) {
+				slot = (slot + 1) & (tableSize - 1);
+			}
+			if (table[slot] == NO_VERTEX) {
+				// first time this vertex is seen, move it down to the end of the unique ones
+				if (unique != v) {
+					memcpy(data + unique * vertexSize, vertex, vertexSize);
+				}
+				table[slot] = (unsigned int)unique;
+				unique++;
+			}
+			remap[v] = table[slot];
+		}
+		for (size_t i = 0; i < indexCount; i++) {
+			indices[i] = remap[indices[i]];
+		}
+		return unique;
+	}
+
+	// reorders the triangles for the post transform vertex cache
+	void optimizeVertexCache(unsigned int* indices, size_t indexCount, size_t vertexCount) {
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0) {
+			return;
+		}
+
+		// score tables: recently used vertices score high, the last triangle's vertices a little less so the
+		// next triangle does not just reuse the same edge, and vertices with few triangles left get a boost
+		float cacheScores[FORSYTH_CACHE_SIZE];
+		for (int position = 0; position < FORSYTH_CACHE_SIZE; position++) {
+			if (position < 3) {
+				cacheScores[position] = 0.75f;
+			}
+			else {
+				float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+				cacheScores[position] = std::pow(1.0f - (position - 3) * scaler, 1.5f);
+			}
+		}
+		float valenceScores[FORSYTH_MAX_VALENCE + 1];
+		valenceScores[0] = 0.0f;
+		for (unsigned int valence = 1; valence <= FORSYTH_MAX_VALENCE; valence++) {
+			valenceScores[valence] = 2.0f / std::sqrt((float)valence);
+		}
+		auto vertexScore = [&](int cachePosition, unsigned int remaining) {
+			if (remaining == 0) {
+				// never used again, it does not matter where it is
+				return -1.0f;
+			}
+			float score = cachePosition >= 0 ? cacheScores[cachePosition] : 0.0f;
+			return score + valenceScores[std::min(remaining, FORSYTH_MAX_VALENCE)];
+		};
+
+		// triangles using each vertex, packed into one array
+		std::vector<unsigned int> remaining(vertexCount, 0);
+		for (size_t i = 0; i < triangleCount * 3; i++) {
+			remaining[indices[i]]++;
+		}
+		std::vector<unsigned int> adjacencyOffsets(vertexCount + 1, 0);
+		for (size_t v = 0; v < vertexCount; v++) {
+			adjacencyOffsets[v + 1] = adjacencyOffsets[v] + remaining[v];
+		}
+		std::vector<unsigned int> adjacency(triangleCount * 3);
+		{
+			std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t t = 0; t < triangleCount; t++) {
+				for (int corner = 0; corner < 3; corner++) {
+					adjacency[fill[indices[t * 3 + corner]]++] = (unsigned int)t;
+				}
+			}
+		}
+
+		std::vector<float> vertexScores(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++) {
+			vertexScores[v] = vertexScore(-1, remaining[v]);
+		}
+		std::vector<float> triangleScores(triangleCount);
+		std::vector<bool> emitted(triangleCount, false);
+		long long bestTriangle = -1;
+		float bestScore = -1.0f;
+		for (size_t t = 0; t < triangleCount; t++) {
+			triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+			if (triangleScores[t] > bestScore) {
+				bestScore = triangleScores[t];
+				bestTriangle = (long long)t;
+			}
+		}
+
+		std::vector<unsigned int> output(triangleCount * 3);
+		unsigned int cache[FORSYTH_CACHE_SIZE + 3];
+		unsigned int newCache[FORSYTH_CACHE_SIZE + 3];
+		int cacheCount = 0;
+		size_t inputCursor = 0;
+
+		for (size_t outputTriangle = 0; outputTriangle < triangleCount; outputTriangle++) {
+			// nothing in the cache has triangles left, continue with the first triangle that was not emitted yet
+			if (bestTriangle < 0) {
+				while (emitted[inputCursor]) {
+					inputCursor++;
+				}
+				bestTriangle = (long long)inputCursor;
+			}
+			size_t triangle = (size_t)bestTriangle;
+			const unsigned int* corners = &indices[triangle * 3];
+			memcpy(&output[outputTriangle * 3], corners, 3 * sizeof(unsigned int));
+			emitted[triangle] = true;
+
+			// the triangle no longer needs its vertices
+			for (int corner = 0; corner < 3; corner++) {
+				unsigned int vertex = corners[corner];
+				unsigned int* begin = &adjacency[adjacencyOffsets[vertex]];
+				unsigned int* end = begin + remaining[vertex];
+				unsigned int* found = std::find(begin, end, (unsigned int)triangle);
+				*found = *(end - 1);
+				remaining[vertex]--;
+			}
+
+			// the triangle's vertices move to the front of the LRU cache
+			int newCount = 0;
+			for (int corner = 0; corner < 3; corner++) {
+				// degenerate triangles name a vertex twice
+				if (std::find(newCache, newCache + newCount, corners[corner]) == newCache + newCount) {
+					newCache[newCount++] = corners[corner];
+				}
+			}
+			for (int i = 0; i < cacheCount; i++) {
+				unsigned int vertex = cache[i];
+				if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2]) {
+					newCache[newCount++] = vertex;
+				}
+			}
+
+			// rescore every vertex whose position changed, including the ones that just fell out,
+			// and pass the difference on to their remaining triangles
+			bestTriangle = -1;
+			bestScore = -1.0f;
+			for (int i = 0; i < newCount; i++) {
+				unsigned int vertex = newCache[i];
+				int position = i < FORSYTH_CACHE_SIZE ? i : -1;
+				float score = vertexScore(position, remaining[vertex]);
+				float difference = score - vertexScores[vertex];
+				vertexScores[vertex] = score;
+				const unsigned int* begin = &adjacency[adjacencyOffsets[vertex]];
+				for (unsigned int a = 0; a < remaining[vertex]; a++) {
+					triangleScores[begin[a]] += difference;
+				}
+			}
+			// the best candidate is one of the triangles that use a cached vertex
+			for (int i = 0; i < std::min(newCount, FORSYTH_CACHE_SIZE); i++) {
+				unsigned int vertex = newCache[i];
+				const unsigned int* begin = &adjacency[adjacencyOffsets[vertex]];
+				for (unsigned int a = 0; a < remaining[vertex]; a++) {
+					if (triangleScores[begin[a]] > bestScore) {
+						bestScore = triangleScores[begin[a]];
+						bestTriangle = begin[a];
+					}
+				}
+			}
+
+			cacheCount = std::min(newCount, FORSYTH_CACHE_SIZE);
+			memcpy(cache, newCache, cacheCount * sizeof(unsigned int));
+		}
+		memcpy(indices, output.data(), triangleCount * 3 * sizeof(unsigned int));
+	}
+
+	// FIFO cache simulation shared by the overdraw pass and the analyzer, a vertex is cached
+	// when fewer than cacheSize misses happened since it was last transformed
+	class FifoCache {
+	private:
+		std::vector<unsigned int> timestamps;
+		unsigned int time;
+		unsigned int size;
+
+	public:
+		FifoCache(size_t vertexCount, size_t cacheSize) : timestamps(vertexCount, 0), time((unsigned int)cacheSize + 1), size((unsigned int)cacheSize) {}
+
+		// forget everything, the next triangles start with a cold cache
+		void clear() {
+			time += size + 1;
+		}
+
+		// returns 1 on a miss (the vertex gets transformed), 0 on a hit
+		unsigned int access(unsigned int vertex) {
+			if (time - timestamps[vertex] > size) {
+				timestamps[vertex] = time++;
+				return 1;
+			}
+			return 0;
+		}
+	};
+
+	// splits the cache optimized order into clusters and sorts them front to back from the outside
+	void optimizeOverdraw(unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount,
+		size_t positionStride, float threshold) {
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0) {
+			return;
+		}
+		size_t floatStride = positionStride / sizeof(float);
+
+		// hard boundaries are triangles where all three vertices miss, the cache starts over there anyway
+		FifoCache cache(vertexCount, ANALYZE_CACHE_SIZE);
+		std::vector<size_t> hardBoundaries;
+		size_t totalMisses = 0;
+		for (size_t t = 0; t < triangleCount; t++) {
+			unsigned int misses = cache.access(indices[t * 3]) + cache.access(indices[t * 3 + 1]) + cache.access(indices[t * 3 + 2]);
+			if (misses == 3 || t == 0) {
+				hardBoundaries.push_back(t);
+			}
+			totalMisses += misses;
+		}
+		hardBoundaries.push_back(triangleCount);
+		float targetRatio = threshold * totalMisses / triangleCount;
+
+		// soft boundaries inside them wherever the cluster so far already beats the target, restarting
+		// the cache there costs at most the threshold
+		std::vector<size_t> clusters;
+		for (size_t h = 0; h + 1 < hardBoundaries.size(); h++) {
+			cache.clear();
+			size_t clusterMisses = 0;
+			size_t clusterStart = hardBoundaries[h];
+			clusters.push_back(clusterStart);
+			for (size_t t = hardBoundaries[h]; t < hardBoundaries[h + 1]; t++) {
+				clusterMisses += cache.access(indices[t * 3]) + cache.access(indices[t * 3 + 1]) + cache.access(indices[t * 3 + 2]);
+				size_t clusterTriangles = t + 1 - clusterStart;
+				if (t + 1 < hardBoundaries[h + 1] && (float)clusterMisses / clusterTriangles <= targetRatio) {
+					clusterStart = t + 1;
+					clusterMisses = 0;
+					clusters.push_back(clusterStart);
+					cache.clear();
+				}
+			}
+		}
+		clusters.push_back(triangleCount);
+		size_t clusterCount = clusters.size() - 1;
+
+		// area weighted centroid and normal of every cluster and of the whole mesh
+		std::vector<float> clusterData(clusterCount * 6, 0.0f);
+		std::vector<float> clusterArea(clusterCount, 0.0f);
+		float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+		float meshArea = 0.0f;
+		for (size_t c = 0; c < clusterCount; c++) {
+			float* centroid = &clusterData[c * 6];
+			float* normal = centroid + 3;
+			for (size_t t = clusters[c]; t < clusters[c + 1]; t++) {
+				const float* a = positions + indices[t * 3] * floatStride;
+				const float* b = positions + indices[t * 3 + 1] * floatStride;
+				const float* d = positions + indices[t * 3 + 2] * floatStride;
+				float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+				float ad[3] = { d[0] - a[0], d[1] - a[1], d[2] - a[2] };
+				float cross[3] = { ab[1] * ad[2] - ab[2] * ad[1], ab[2] * ad[0] - ab[0] * ad[2], ab[0] * ad[1] - ab[1] * ad[0] };
+				float area = std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+				for (int axis = 0; axis < 3; axis++) {
+					float triangleCentroid = (a[axis] + b[axis] + d[axis]) / 3.0f;
+					centroid[axis] += triangleCentroid * area;
+					normal[axis] += cross[axis];
+					meshCentroid[axis] += triangleCentroid * area;
+				}
+				clusterArea[c] += area;
+			}
+			meshArea += clusterArea[c];
+		}
+		for (int axis = 0; axis < 3; axis++) {
+			meshCentroid[axis] = meshArea > 0.0f ? meshCentroid[axis] / meshArea : 0.0f;
+		}
+
+		// sort key: how far the cluster lies out along its own normal
+		std::vector<float> sortKeys(clusterCount);
+		std::vector<size_t> order(clusterCount);
+		for (size_t c = 0; c < clusterCount; c++) {
+			const float* centroid = &clusterData[c * 6];
+			const float* normal = centroid + 3;
+			float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			float key = 0.0f;
+			if (clusterArea[c] > 0.0f && length > 0.0f) {
+				for (int axis = 0; axis < 3; axis++) {
+					key += (centroid[axis] / clusterArea[c] - meshCentroid[axis]) * normal[axis] / length;
+				}
+			}
+			sortKeys[c] = key;
+			order[c] = c;
+		}
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			return sortKeys[a] > sortKeys[b];
+		});
+
+		std::vector<unsigned int> output;
+		output.reserve(triangleCount * 3);
+		for (size_t c : order) {
+			output.insert(output.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+		}
+		memcpy(indices, output.data(), output.size() * sizeof(unsigned int));
+	}
+
+	// renumbers the vertices in the order the index buffer first uses them
+	size_t optimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexSize, unsigned int* indices, size_t indexCount) {
+		std::vector<unsigned int> remap(vertexCount, NO_VERTEX);
+		unsigned int next = 0;
+		for (size_t i = 0; i < indexCount; i++) {
+			unsigned int& target = remap[indices[i]];
+			if (target == NO_VERTEX) {
+				target = next++;
+			}
+			indices[i] = target;
+		}
+		unsigned char* data = (unsigned char*)vertices;
+		std::vector<unsigned char> original(data, data + vertexCount * vertexSize);
+		for (size_t v = 0; v < vertexCount; v++) {
+			if (remap[v] != NO_VERTEX) {
+				memcpy(data + remap[v] * vertexSize, original.data() + v * vertexSize, vertexSize);
+			}
+		}
+		return next;
+	}
+
+	// simulates a FIFO post transform cache over the index buffer
+	CacheStatistics analyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, size_t cacheSize) {
+		CacheStatistics statistics = { 0.0f, 0.0f, 0 };
+		if (indexCount < 3) {
+			return statistics;
+		}
+		FifoCache cache(vertexCount, cacheSize);
+		std::vector<bool> used(vertexCount, false);
+		size_t unique = 0;
+		for (size_t i = 0; i < indexCount; i++) {
+			statistics.transformed += cache.access(indices[i]);
+			if (!used[indices[i]]) {
+				used[indices[i]] = true;
+				unique++;
+			}
+		}
+		statistics.acmr = (float)statistics.transformed / (indexCount / 3);
+		statistics.atvr = (float)statistics.transformed / unique;
+		return statistics;
+	}
+
+	// 16 bit indices when every vertex can be addressed with them, 32 bit otherwise
+	IndexData packIndices(const unsigned int* indices, size_t indexCount, size_t vertexCount) {
+		IndexData data;
+		data.count = indexCount;
+		if (vertexCount <= 65536) {
+			data.type = GL_UNSIGNED_SHORT;
+			data.bytes.resize(indexCount * sizeof(unsigned short));
+			unsigned short* shorts = (unsigned short*)data.bytes.data();
+			for (size_t i = 0; i < indexCount; i++) {
+				shorts[i] = (unsigned short)indices[i];
+			}
+		}
+		else {
+			data.type = GL_UNSIGNED_INT;
+			data.bytes.resize(indexCount * sizeof(unsigned int));
+			memcpy(data.bytes.data(), indices, data.bytes.size());
+		}
+		return data;
+	}
+
+	// welding, vertex cache, overdraw and vertex fetch optimisation in that order
+	Report optimize(Mesh& mesh) {
+		Report report;
+		report.verticesBefore = mesh.vertices.size();
+		report.before = analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+		if (mesh.vertices.empty() || mesh.indices.empty()) {
+			report.verticesAfter = report.verticesBefore;
+			report.after = report.before;
+			return report;
+		}
+
+		size_t vertexCount = weldVertices(mesh.vertices.data(), mesh.vertices.size(), sizeof(StandardVertex),
+			mesh.indices.data(), mesh.indices.size());
+		mesh.vertices.resize(vertexCount);
+		std::vector<Submesh> ranges = mesh.submeshes;
+		if (ranges.empty()) {
+			ranges.push_back(Submesh{ 0, (unsigned int)mesh.indices.size() });
+		}
+		for (const Submesh& range : ranges) {
+			unsigned int* indices = mesh.indices.data() + range.firstIndex;
+			optimizeVertexCache(indices, range.indexCount, vertexCount);
+			optimizeOverdraw(indices, range.indexCount, mesh.vertices[0].position, vertexCount, sizeof(StandardVertex));
+		}
+		vertexCount = optimizeVertexFetch(mesh.vertices.data(), vertexCount, sizeof(StandardVertex),
+			mesh.indices.data(), mesh.indices.size());
+		mesh.vertices.resize(vertexCount);
+
+		report.verticesAfter = vertexCount;
+		report.after = analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+		return report;
+	}
+
+	void printReport(const char* name, const Report& report) {
+		std::cout << name << ": " << report.verticesBefore << " -> " << report.verticesAfter << " vertices, ACMR "
+			<< report.before.acmr << " -> " << report.after.acmr << ", ATVR "
+			<< report.before.atvr << " -> " << report.after.atvr << " (FIFO " << ANALYZE_CACHE_SIZE << ")" << std::endl;
+	}
+}
@@ -0,0 +1,73 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <vector>
+#include <cstddef>
+
+#include <glad/glad.h>
+
+#include "Mesh.h"
+
+// reorders indexed triangle lists so the GPU transforms, shades and fetches as little as possible.
+// the passes work on raw vertex bytes so they run on any vertex format, optimize() runs all of them on a Mesh
+namespace MeshOptimizer {
+
+	// post transform cache efficiency of an index buffer
+	struct CacheStatistics {
+		// average cache miss ratio, transformed vertices per triangle (0.5 is the best a regular grid can do, 3 the worst)
+		float acmr;
+		// average transformed to vertex ratio, transformed vertices per unique vertex (1 is perfect)
+		float atvr;
+		size_t transformed;
+	};
+
+	// what optimize() did to a mesh
+	struct Report {
+		CacheStatistics before;
+		CacheStatistics after;
+		size_t verticesBefore;
+		size_t verticesAfter;
+	};
+
+	// index buffer contents in the smallest type that can address every vertex
+	struct IndexData {
+		std::vector<unsigned char> bytes;
+		// GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+		GLenum type;
+		size_t count;
+	};
+
+	// FIFO cache size used to report ACMR/ATVR, roughly what current GPUs reuse
+	const size_t ANALYZE_CACHE_SIZE = 16;
+
+	// merges vertices whose bytes are identical and rewrites the indices,
+	// the unique vertices are moved to the front of the array and their count is returned
+	size_t weldVertices(void* vertices, size_t vertexCount, size_t vertexSize, unsigned int* indices, size_t indexCount);
+
+	// reorders the triangles for the post transform vertex cache (Tom Forsyth's linear speed vertex cache optimisation)
+	void optimizeVertexCache(unsigned int* indices, size_t indexCount, size_t vertexCount);
+
+	// splits the cache optimized order into clusters and sorts them so triangles facing away from the centre of
+	// the mesh are drawn first, which lets early depth testing reject more of what is behind them.
+	// clusters are only split where the cache miss ratio stays within threshold of the current one
+	void optimizeOverdraw(unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount,
+		size_t positionStride, float threshold = 1.05f);
+
+	// renumbers the vertices in the order the index buffer first uses them so vertex fetch walks memory linearly,
+	// unused vertices are dropped, returns the number of vertices left
+	size_t optimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexSize, unsigned int* indices, size_t indexCount);
+
+	// simulates a FIFO post transform cache over the index buffer
+	CacheStatistics analyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount,
+		size_t cacheSize = ANALYZE_CACHE_SIZE);
+
+	// 16 bit indices when every vertex can be addressed with them, 32 bit otherwise
+	IndexData packIndices(const unsigned int* indices, size_t indexCount, size_t vertexCount);
+
+	// welding, vertex cache, overdraw and vertex fetch optimisation in that order
+	Report optimize(Mesh& mesh);
+	void printReport(const char* name, const Report& report);
+
+}
+
+#endif // MESH_OPTIMIZER_H
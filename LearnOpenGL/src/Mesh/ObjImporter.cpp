@@ -0,0 +1,359 @@
+#include <iostream>
+#include <unordered_map>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "ObjImporter.h"
+#include "../Utility/MappedFile.h"
+
+namespace ObjImporter {
+
+	// the mapped file is not null terminated, so the parsers take the end of the line explicitly
+	static bool isSpace(char c) {
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	static const char* skipSpaces(const char* cursor, const char* end) {
+		while (cursor < end && isSpace(*cursor)) {
+			cursor++;
+		}
+		return cursor;
+	}
+
+	// decimal float with optional sign, fraction and exponent, returns false if there was no number
+	static bool parseFloat(const char*& cursor, const char* end, float& value) {
+		cursor = skipSpaces(cursor, end);
+		const char* start = cursor;
+		bool negative = false;
+		if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+			negative = *cursor == '-';
+			cursor++;
+		}
+		double result = 0.0;
+		while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+			result = result * 10.0 + (*cursor - '0');
+			cursor++;
+		}
+		if (cursor < end && *cursor == '.') {
+			cursor++;
+			double scale = 0.1;
+			while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+				result += (*cursor - '0') * scale;
+				scale *= 0.1;
+				cursor++;
+			}
+		}
+		if (cursor < end && (*cursor == 'e' || *cursor == 'E')) {
+			cursor++;
+			bool negativeExponent = false;
+			if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+				negativeExponent = *cursor == '-';
+				cursor++;
+			}
+			int exponent = 0;
+			while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+				exponent = exponent * 10 + (*cursor - '0');
+				cursor++;
+			}
+			result *= std::pow(10.0, negativeExponent ? -exponent : exponent);
+		}
+		value = (float)(negative ? -result : result);
+		return cursor != start;
+	}
+
+	static bool parseInt(const char*& cursor, const char* end, long long& value) {
+		const char* start = cursor;
+		bool negative = false;
+		if (cursor < end && *cursor == '-') {
+			negative = true;
+			cursor++;
+		}
+		long long result = 0;
+		while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+			result = result * 10 + (*cursor - '0');
+			cursor++;
+		}
+		value = negative ? -result : result;
+		return cursor != start;
+	}
+
+	// OBJ indices are 1 based, negative ones count back from the last element read so far
+	static bool resolveIndex(long long index, size_t count, size_t& resolved) {
+		if (index > 0 && (size_t)index <= count) {
+			resolved = (size_t)index - 1;
+			return true;
+		}
+		if (index < 0 && (size_t)(-index) <= count) {
+			resolved = count - (size_t)(-index);
+			return true;
+		}
+		return false;
+	}
+
+	// a line split into its keyword and the rest
+	struct Line {
+		const char* token;
+		size_t tokenLength;
+		const char* arguments;
+		const char* end;
+	};
+
+	static const char* readLine(const char* cursor, const char* fileEnd, Line& line) {
+		line.end = (const char*)memchr(cursor, '\n', fileEnd - cursor);
+		if (line.end == NULL) {
+			line.end = fileEnd;
+		}
+		line.token = skipSpaces(cursor, line.end);
+		line.tokenLength = 0;
+		while (line.token + line.tokenLength < line.end && !isSpace(line.token[line.tokenLength])) {
+			line.tokenLength++;
+		}
+		line.arguments = line.token + line.tokenLength;
+		return line.end + 1;
+	}
+
+	static bool isKeyword(const Line& line, const char* keyword, size_t length) {
+		return line.tokenLength == length && memcmp(line.token, keyword, length) == 0;
+	}
+
+	// the file is cut into line aligned chunks that are parsed independently. the first pass only counts
+	// v and vt lines, which gives every chunk the global index of its first position, so the second pass can
+	// write positions in place and resolve (also negative) face indices exactly like a sequential reader would
+	struct Chunk {
+		const char* begin;
+		const char* end;
+		size_t positionCount = 0;
+		size_t texCoordCount = 0;
+		size_t positionBase = 0;
+		size_t texCoordBase = 0;
+		// two values per triangle corner: position and texture coordinate + 1 (0 when the corner has none)
+		std::vector<unsigned int> corners;
+		// corner count at each o, g or usemtl line
+		std::vector<size_t> submeshBreaks;
+		size_t skippedFaces = 0;
+	};
+
+	// aim for a few chunks per thread so a chunk that is all faces does not hold everyone up
+	static const size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+	static std::vector<Chunk> splitChunks(const char* data, size_t size, unsigned int threadCount) {
+		size_t chunkSize = std::max(MIN_CHUNK_SIZE, size / (threadCount * 4) + 1);
+		std::vector<Chunk> chunks;
+		const char* cursor = data;
+		const char* fileEnd = data + size;
+		while (cursor < fileEnd) {
+			const char* end = cursor + std::min(chunkSize, (size_t)(fileEnd - cursor));
+			const char* newline = end < fileEnd ? (const char*)memchr(end, '\n', fileEnd - end) : NULL;
+			end = newline != NULL ? newline + 1 : fileEnd;
+			Chunk chunk;
+			chunk.begin = cursor;
+			chunk.end = end;
+			chunks.push_back(std::move(chunk));
+			cursor = end;
+		}
+		return chunks;
+	}
+
+	static void countElements(Chunk& chunk) {
+		Line line;
+		const char* cursor = chunk.begin;
+		while (cursor < chunk.end) {
+			cursor = readLine(cursor, chunk.end, line);
+			if (isKeyword(line, "v", 1)) {
+				chunk.positionCount++;
+			}
+			else if (isKeyword(line, "vt", 2)) {
+				chunk.texCoordCount++;
+			}
+		}
+	}
+
+	static void parseChunk(Chunk& chunk, float* positions, float* colors, float* texCoords) {
+		float* position = positions + chunk.positionBase * 3;
+		float* color = colors + chunk.positionBase * 3;
+		float* texCoord = texCoords + chunk.texCoordBase * 2;
+		size_t positionsRead = chunk.positionBase;
+		size_t texCoordsRead = chunk.texCoordBase;
+		std::vector<unsigned int> polygon;
+
+		Line line;
+		const char* cursor = chunk.begin;
+		while (cursor < chunk.end) {
+			cursor = readLine(cursor, chunk.end, line);
+			if (isKeyword(line, "v", 1)) {
+				float values[6] = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+				int count = 0;
+				while (count < 6 && parseFloat(line.arguments, line.end, values[count])) {
+					count++;
+				}
+				// without vertex colours the mesh is white, four values are x y z w
+				if (count < 6) {
+					values[3] = values[4] = values[5] = 1.0f;
+				}
+				memcpy(position, values, sizeof(float) * 3);
+				memcpy(color, values + 3, sizeof(float) * 3);
+				position += 3;
+				color += 3;
+				positionsRead++;
+			}
+			else if (isKeyword(line, "vt", 2)) {
+				texCoord[0] = texCoord[1] = 0.0f;
+				parseFloat(line.arguments, line.end, texCoord[0]);
+				parseFloat(line.arguments, line.end, texCoord[1]);
+				texCoord += 2;
+				texCoordsRead++;
+			}
+			else if (isKeyword(line, "f", 1)) {
+				polygon.clear();
+				bool valid = true;
+				const char* corner = skipSpaces(line.arguments, line.end);
+				while (corner < line.end && valid) {
+					long long positionIndex = 0, texCoordIndex = 0, normalIndex = 0;
+					size_t positionResolved = 0, texCoordResolved = 0;
+					bool hasTexCoord = false;
+					valid = parseInt(corner, line.end, positionIndex) && resolveIndex(positionIndex, positionsRead, positionResolved);
+					if (corner < line.end && *corner == '/') {
+						corner++;
+						if (corner < line.end && *corner != '/') {
+							hasTexCoord = parseInt(corner, line.end, texCoordIndex) && resolveIndex(texCoordIndex, texCoordsRead, texCoordResolved);
+							valid = valid && hasTexCoord;
+						}
+						// normals are not part of StandardVertex
+						if (corner < line.end && *corner == '/') {
+							corner++;
+							parseInt(corner, line.end, normalIndex);
+						}
+					}
+					if (!valid) {
+						break;
+					}
+					polygon.push_back((unsigned int)positionResolved);
+					polygon.push_back(hasTexCoord ? (unsigned int)texCoordResolved + 1 : 0);
+					corner = skipSpaces(corner, line.end);
+				}
+				if (!valid || polygon.size() < 6) {
+					chunk.skippedFaces++;
+					continue;
+				}
+				// fan triangulation
+				for (size_t i = 2; i < polygon.size() / 2; i++) {
+					chunk.corners.insert(chunk.corners.end(), polygon.begin(), polygon.begin() + 2);
+					chunk.corners.insert(chunk.corners.end(), polygon.begin() + (i - 1) * 2, polygon.begin() + (i + 1) * 2);
+				}
+			}
+			else if (isKeyword(line, "o", 1) || isKeyword(line, "g", 1) || isKeyword(line, "usemtl", 6)) {
+				chunk.submeshBreaks.push_back(chunk.corners.size() / 2);
+			}
+		}
+	}
+
+	static const unsigned int NO_VERTEX = 0xFFFFFFFFu;
+
+	bool load(const char* path, Mesh& mesh, ThreadPool& pool) {
+		MappedFile file;
+		if (!file.open(path)) {
+			return false;
+		}
+		mesh.vertices.clear();
+		mesh.indices.clear();
+		mesh.submeshes.clear();
+
+		std::vector<Chunk> chunks = splitChunks((const char*)file.data(), file.size(), pool.concurrency());
+		pool.run(chunks.size(), [&](size_t i) { countElements(chunks[i]); });
+		size_t positionCount = 0;
+		size_t texCoordCount = 0;
+		for (Chunk& chunk : chunks) {
+			chunk.positionBase = positionCount;
+			chunk.texCoordBase = texCoordCount;
+			positionCount += chunk.positionCount;
+			texCoordCount += chunk.texCoordCount;
+		}
+		std::vector<float> positions(positionCount * 3);
+		std::vector<float> colors(positionCount * 3);
+		std::vector<float> texCoords(texCoordCount * 2);
+		pool.run(chunks.size(), [&](size_t i) { parseChunk(chunks[i], positions.data(), colors.data(), texCoords.data()); });
+
+		// shared corners are only emitted once. this runs in file order so the vertex order matches a sequential
+		// import, most positions are only ever used with one texture coordinate and never reach the map
+		std::vector<unsigned int> firstVertex(positionCount, NO_VERTEX);
+		std::unordered_map<unsigned long long, unsigned int> otherCorners;
+		// position and texture coordinate + 1 of every vertex
+		std::vector<unsigned int> sources;
+		size_t cornerCount = 0;
+		size_t skippedFaces = 0;
+		for (const Chunk& chunk : chunks) {
+			cornerCount += chunk.corners.size() / 2;
+			skippedFaces += chunk.skippedFaces;
+		}
+		mesh.indices.reserve(cornerCount);
+
+		unsigned int submeshStart = 0;
+		auto closeSubmesh = [&]() {
+			if (mesh.indices.size() > submeshStart) {
+				mesh.submeshes.push_back(Submesh{ submeshStart, (unsigned int)mesh.indices.size() - submeshStart });
+				submeshStart = (unsigned int)mesh.indices.size();
+			}
+		};
+		for (const Chunk& chunk : chunks) {
+			size_t nextBreak = 0;
+			for (size_t corner = 0; corner < chunk.corners.size() / 2; corner++) {
+				while (nextBreak < chunk.submeshBreaks.size() && chunk.submeshBreaks[nextBreak] == corner) {
+					closeSubmesh();
+					nextBreak++;
+				}
+				unsigned int position = chunk.corners[corner * 2];
+				unsigned int texCoord = chunk.corners[corner * 2 + 1];
+				unsigned int vertex = firstVertex[position];
+				if (vertex == NO_VERTEX) {
+					vertex = firstVertex[position] = (unsigned int)(sources.size() / 2);
+					sources.push_back(position);
+					sources.push_back(texCoord);
+				}
+				else if (sources[vertex * 2 + 1] != texCoord) {
+					unsigned long long key = ((unsigned long long)position << 32) | texCoord;
+					auto found = otherCorners.emplace(key, (unsigned int)(sources.size() / 2));
+					if (found.second) {
+						sources.push_back(position);
+						sources.push_back(texCoord);
+					}
+					vertex = found.first->second;
+				}
+				mesh.indices.push_back(vertex);
+			}
+			// breaks after the last face of the chunk
+			for (size_t i = nextBreak; i < chunk.submeshBreaks.size(); i++) {
+				closeSubmesh();
+			}
+		}
+		closeSubmesh();
+		if (mesh.submeshes.size() == 1) {
+			mesh.submeshes.clear();
+		}
+
+		mesh.vertices.resize(sources.size() / 2);
+		const size_t verticesPerTask = 64 * 1024;
+		pool.run((mesh.vertices.size() + verticesPerTask - 1) / verticesPerTask, [&](size_t task) {
+			size_t end = std::min(mesh.vertices.size(), (task + 1) * verticesPerTask);
+			for (size_t i = task * verticesPerTask; i < end; i++) {
+				StandardVertex& vertex = mesh.vertices[i];
+				unsigned int position = sources[i * 2];
+				unsigned int texCoord = sources[i * 2 + 1];
+				memcpy(vertex.position, &positions[(size_t)position * 3], sizeof(vertex.position));
+				memcpy(vertex.color, &colors[(size_t)position * 3], sizeof(vertex.color));
+				vertex.texCoord[0] = texCoord != 0 ? texCoords[(texCoord - 1) * 2] : 0.0f;
+				vertex.texCoord[1] = texCoord != 0 ? texCoords[(texCoord - 1) * 2 + 1] : 0.0f;
+			}
+		});
+
+		if (skippedFaces > 0) {
+			std::cout << "WARNING::OBJ_IMPORTER::SKIPPED_FACES " << skippedFaces << " faces in " << path
+				<< " reference missing vertices" << std::endl;
+		}
+		if (mesh.indices.empty()) {
+			std::cout << "ERROR::OBJ_IMPORTER::NO_TRIANGLES " << path << std::endl;
+			return false;
+		}
+		return true;
+	}
+}
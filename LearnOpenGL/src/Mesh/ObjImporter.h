@@ -0,0 +1,17 @@
+#ifndef OBJ_IMPORTER_H
+#define OBJ_IMPORTER_H
+
+#include "Mesh.h"
+#include "../Utility/ThreadPool.h"
+
+// Wavefront OBJ reader: v (with the optional "v x y z r g b" vertex colours), vt, f with any polygon size
+// (fan triangulated) and negative indices. o, g and usemtl start a new submesh, everything else is skipped.
+// the memory mapped file is parsed in line aligned chunks on the pool, the result is the same as a sequential read
+namespace ObjImporter {
+
+	// the vertices come out unwelded per distinct v/vt pair, run MeshOptimizer::optimize() afterwards
+	bool load(const char* path, Mesh& mesh, ThreadPool& pool = ThreadPool::shared());
+
+}
+
+#endif // OBJ_IMPORTER_H
@@ -0,0 +1,84 @@
+#include <iostream>
+#include <fstream>
+
+#include "Offscreen.h"
+
+namespace Offscreen {
+
+	// creates an RGBA8 + depth/stencil framebuffer of the given size
+	RenderTarget createRenderTarget(int width, int height) {
+		RenderTarget target;
+		target.width = width;
+		target.height = height;
+
+		glGenFramebuffers(1, &target.FBO);
+		glBindFramebuffer(GL_FRAMEBUFFER, target.FBO);
+
+		// renderbuffers are enough since the result is only ever read back
+		glGenRenderbuffers(1, &target.colorRBO);
+		glBindRenderbuffer(GL_RENDERBUFFER, target.colorRBO);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target.colorRBO);
+
+		glGenRenderbuffers(1, &target.depthRBO);
+		glBindRenderbuffer(GL_RENDERBUFFER, target.depthRBO);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, target.depthRBO);
+
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+			std::cout << "ERROR::OFFSCREEN::FRAMEBUFFER_INCOMPLETE" << std::endl;
+		}
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+		return target;
+	}
+
+	// bind the render target for drawing and set the viewport to its size
+	void bind(const RenderTarget& target) {
+		glBindFramebuffer(GL_FRAMEBUFFER, target.FBO);
+		glViewport(0, 0, target.width, target.height);
+		return;
+	}
+
+	// read the color attachment back into tightly packed RGBA8 rows (bottom row first)
+	void readPixels(const RenderTarget& target, std::vector<unsigned char>& pixels) {
+		pixels.resize((size_t)target.width * target.height * 4);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, target.FBO);
+		glReadBuffer(GL_COLOR_ATTACHMENT0);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(0, 0, target.width, target.height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+		return;
+	}
+
+	// write RGBA8 pixels read back from OpenGL into a binary PPM image
+	bool writePPM(const char* path, const std::vector<unsigned char>& pixels, int width, int height) {
+		std::ofstream file(path, std::ios::binary);
+		if (!file) {
+			std::cout << "ERROR::OFFSCREEN::FAILED_TO_OPEN " << path << std::endl;
+			return false;
+		}
+		file << "P6\n" << width << " " << height << "\n255\n";
+		// OpenGL rows start at the bottom, PPM rows start at the top
+		std::vector<unsigned char> row((size_t)width * 3);
+		for (int y = height - 1; y >= 0; y--) {
+			const unsigned char* src = &pixels[(size_t)y * width * 4];
+			for (int x = 0; x < width; x++) {
+				row[x * 3 + 0] = src[x * 4 + 0];
+				row[x * 3 + 1] = src[x * 4 + 1];
+				row[x * 3 + 2] = src[x * 4 + 2];
+			}
+			file.write((const char*)row.data(), row.size());
+		}
+		return (bool)file;
+	}
+
+	// delete the GL objects owned by the render target
+	void destroyRenderTarget(RenderTarget& target) {
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glDeleteRenderbuffers(1, &target.colorRBO);
+		glDeleteRenderbuffers(1, &target.depthRBO);
+		glDeleteFramebuffers(1, &target.FBO);
+		target = RenderTarget();
+		return;
+	}
+
+}
@@ -0,0 +1,36 @@
+#ifndef OFFSCREEN_H
+#define OFFSCREEN_H
+
+#include <vector>
+
+#include <glad/glad.h>
+
+namespace Offscreen {
+
+	// framebuffer object used as the render target when there is no window
+	struct RenderTarget {
+		unsigned int FBO = 0;
+		unsigned int colorRBO = 0;
+		unsigned int depthRBO = 0;
+		int width = 0;
+		int height = 0;
+	};
+
+	// creates an RGBA8 + depth/stencil framebuffer of the given size
+	RenderTarget createRenderTarget(int width, int height);
+
+	// bind the render target for drawing and set the viewport to its size
+	void bind(const RenderTarget& target);
+
+	// read the color attachment back into tightly packed RGBA8 rows (bottom row first)
+	void readPixels(const RenderTarget& target, std::vector<unsigned char>& pixels);
+
+	// write RGBA8 pixels read back from OpenGL into a binary PPM image
+	bool writePPM(const char* path, const std::vector<unsigned char>& pixels, int width, int height);
+
+	// delete the GL objects owned by the render target
+	void destroyRenderTarget(RenderTarget& target);
+
+}
+
+#endif // OFFSCREEN_H
@@ -0,0 +1,194 @@
+#include <iostream>
+#include <iomanip>
+
+#include "GpuProfiler.h"
+
+// constructor
+GpuProfiler::GpuProfiler()
+	: currentFrame(0), inFrame(false), frameBudgetMs(1000.0 / 60.0),
+	  framesResolved(0), framesDropped(0), framesOverBudget(0) {
+}
+
+// destructor
+GpuProfiler::~GpuProfiler() {
+	for (FrameQueries& frame : frames) {
+		if (!frame.queries.empty()) {
+			glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data());
+		}
+	}
+}
+
+// hand out the next unused query of the frame, growing the pool if needed
+unsigned int GpuProfiler::nextQuery(FrameQueries& frame) {
+	if (frame.usedQueries == frame.queries.size()) {
+		size_t oldSize = frame.queries.size();
+		size_t newSize = oldSize == 0 ? 16 : oldSize * 2;
+		frame.queries.resize(newSize);
+		glGenQueries((GLsizei)(newSize - oldSize), &frame.queries[oldSize]);
+	}
+	return frame.queries[frame.usedQueries++];
+}
+
+int GpuProfiler::findOrAddStat(const std::string& path, int depth) {
+	auto found = statLookup.find(path);
+	if (found != statLookup.end()) {
+		return found->second;
+	}
+	ScopeStats scope;
+	scope.path = path;
+	scope.depth = depth;
+	stats.push_back(scope);
+	statLookup[path] = (int)stats.size() - 1;
+	return (int)stats.size() - 1;
+}
+
+// read back the timestamps of an old frame, dropping it if the GPU is still not done
+void GpuProfiler::resolveFrame(FrameQueries& frame) {
+	if (!frame.pending) {
+		return;
+	}
+	frame.pending = false;
+
+	// the last query issued finishes last, so it tells whether the whole frame is ready
+	GLint available = 0;
+	glGetQueryObjectiv(frame.queries[frame.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available) {
+		framesDropped++;
+		return;
+	}
+
+	for (const ScopeRecord& record : frame.scopes) {
+		GLuint64 begin = 0, end = 0;
+		glGetQueryObjectui64v(record.beginQuery, GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(record.endQuery, GL_QUERY_RESULT, &end);
+		double milliseconds = end > begin ? (end - begin) / 1000000.0 : 0.0;
+
+		ScopeStats& scope = stats[record.statIndex];
+		scope.lastMs = milliseconds;
+		if (milliseconds > scope.maxMs) {
+			scope.maxMs = milliseconds;
+		}
+		scope.history[scope.historyNext] = milliseconds;
+		scope.historyNext = (scope.historyNext + 1) % HISTORY_SIZE;
+		if (scope.historyCount < HISTORY_SIZE) {
+			scope.historyCount++;
+		}
+	}
+	// the first record is always the whole frame
+	if (!frame.scopes.empty() && stats[frame.scopes[0].statIndex].lastMs > frameBudgetMs) {
+		framesOverBudget++;
+	}
+	framesResolved++;
+}
+
+// frame boundaries, everything between them is recorded under the "frame" scope
+void GpuProfiler::beginFrame() {
+	FrameQueries& frame = frames[currentFrame];
+	// this slot was last used FRAME_LATENCY frames ago
+	resolveFrame(frame);
+	frame.usedQueries = 0;
+	frame.scopes.clear();
+	scopeStack.clear();
+	currentPath.clear();
+	inFrame = true;
+	beginScope("frame");
+}
+
+void GpuProfiler::endFrame() {
+	if (!inFrame) {
+		return;
+	}
+	// close anything left open, including the frame scope itself
+	while (!scopeStack.empty()) {
+		endScope();
+	}
+	frames[currentFrame].pending = frames[currentFrame].usedQueries > 0;
+	currentFrame = (currentFrame + 1) % FRAME_LATENCY;
+	inFrame = false;
+}
+
+// named scopes, these can be nested
+void GpuProfiler::beginScope(const char* name) {
+	if (!inFrame) {
+		return;
+	}
+	FrameQueries& frame = frames[currentFrame];
+	if (!currentPath.empty()) {
+		currentPath += '/';
+	}
+	currentPath += name;
+
+	ScopeRecord record;
+	record.statIndex = findOrAddStat(currentPath, (int)scopeStack.size());
+	record.beginQuery = nextQuery(frame);
+	record.endQuery = 0;
+	// timestamps nest freely, unlike GL_TIME_ELAPSED which allows one active query
+	glQueryCounter(record.beginQuery, GL_TIMESTAMP);
+	frame.scopes.push_back(record);
+	scopeStack.push_back(frame.scopes.size() - 1);
+}
+
+void GpuProfiler::endScope() {
+	if (!inFrame || scopeStack.empty()) {
+		return;
+	}
+	FrameQueries& frame = frames[currentFrame];
+	ScopeRecord& record = frame.scopes[scopeStack.back()];
+	record.endQuery = nextQuery(frame);
+	glQueryCounter(record.endQuery, GL_TIMESTAMP);
+	scopeStack.pop_back();
+
+	size_t separator = currentPath.rfind('/');
+	currentPath.erase(separator == std::string::npos ? 0 : separator);
+}
+
+// rolling average of a scope in milliseconds, e.g. "frame/draw"
+double GpuProfiler::getAverageMs(const std::string& path) const {
+	auto found = statLookup.find(path);
+	if (found == statLookup.end()) {
+		return 0.0;
+	}
+	const ScopeStats& scope = stats[found->second];
+	if (scope.historyCount == 0) {
+		return 0.0;
+	}
+	double total = 0.0;
+	for (int i = 0; i < scope.historyCount; i++) {
+		total += scope.history[i];
+	}
+	return total / scope.historyCount;
+}
+
+// frames whose total GPU time went over the budget
+unsigned long GpuProfiler::getFramesOverBudget() const {
+	return framesOverBudget;
+}
+
+void GpuProfiler::setFrameBudget(double milliseconds) {
+	frameBudgetMs = milliseconds;
+}
+
+// print every scope with its last, average and max GPU time
+void GpuProfiler::printReport() const {
+	std::cout << "GPU profile (" << framesResolved << " frames, " << framesOverBudget << " over "
+		<< frameBudgetMs << " ms, " << framesDropped << " dropped)" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+	for (const ScopeStats& scope : stats) {
+		std::cout << "  " << std::string(scope.depth * 2, ' ') << std::left << std::setw(24 - scope.depth * 2)
+			<< scope.path.substr(scope.path.rfind('/') + 1) << std::right
+			<< " last " << std::setw(8) << scope.lastMs << " ms"
+			<< "  avg " << std::setw(8) << getAverageMs(scope.path) << " ms"
+			<< "  max " << std::setw(8) << scope.maxMs << " ms" << std::endl;
+	}
+	std::cout.unsetf(std::ios::floatfield);
+	std::cout << std::setprecision(6);
+}
+
+// opens a profiler scope for the lifetime of the object
+GpuScope::GpuScope(GpuProfiler& profiler, const char* name) : profiler(profiler) {
+	profiler.beginScope(name);
+}
+
+GpuScope::~GpuScope() {
+	profiler.endScope();
+}
@@ -0,0 +1,113 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include <glad/glad.h>
+
+// per-frame GPU timing built on GL_TIMESTAMP queries.
+// results are read back a few frames late from a ring of query sets,
+// so the CPU never waits on the GPU to finish a frame
+class GpuProfiler {
+private:
+	// number of frames in flight before a query set is reused
+	static const int FRAME_LATENCY = 4;
+	// number of samples used for the rolling average
+	static const int HISTORY_SIZE = 60;
+
+	// one begin/end pair recorded during a frame
+	struct ScopeRecord {
+		int statIndex;
+		unsigned int beginQuery;
+		unsigned int endQuery;
+	};
+
+	// the queries issued during one frame
+	struct FrameQueries {
+		std::vector<unsigned int> queries;
+		std::vector<ScopeRecord> scopes;
+		size_t usedQueries = 0;
+		bool pending = false;
+	};
+
+	// accumulated timings for one named scope
+	struct ScopeStats {
+		std::string path;
+		int depth = 0;
+		double lastMs = 0.0;
+		double maxMs = 0.0;
+		double history[HISTORY_SIZE] = {};
+		int historyCount = 0;
+		int historyNext = 0;
+	};
+
+	FrameQueries frames[FRAME_LATENCY];
+	int currentFrame;
+	bool inFrame;
+
+	// open scopes of the current frame, innermost last
+	std::vector<size_t> scopeStack;
+	std::string currentPath;
+
+	std::vector<ScopeStats> stats;
+	std::map<std::string, int> statLookup;
+
+	// frame accounting
+	double frameBudgetMs;
+	unsigned long framesResolved;
+	unsigned long framesDropped;
+	unsigned long framesOverBudget;
+
+	unsigned int nextQuery(FrameQueries& frame);
+	int findOrAddStat(const std::string& path, int depth);
+	void resolveFrame(FrameQueries& frame);
+
+public:
+
+	// constructor
+	GpuProfiler();
+
+	// destructor
+	~GpuProfiler();
+
+	GpuProfiler(const GpuProfiler&) = delete;
+	GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+	// frame boundaries, everything between them is recorded under the "frame" scope
+	void beginFrame();
+	void endFrame();
+
+	// named scopes, these can be nested
+	void beginScope(const char* name);
+	void endScope();
+
+	// getters
+
+	// rolling average of a scope in milliseconds, e.g. "frame/draw"
+	double getAverageMs(const std::string& path) const;
+	// frames whose total GPU time went over the budget
+	unsigned long getFramesOverBudget() const;
+
+	// setters
+	void setFrameBudget(double milliseconds);
+
+	// print every scope with its last, average and max GPU time
+	void printReport() const;
+};
+
+// opens a profiler scope for the lifetime of the object
+class GpuScope {
+private:
+	GpuProfiler& profiler;
+
+public:
+	GpuScope(GpuProfiler& profiler, const char* name);
+	~GpuScope();
+
+	GpuScope(const GpuScope&) = delete;
+	GpuScope& operator=(const GpuScope&) = delete;
+};
+
+#endif // GPU_PROFILER_H
@@ -0,0 +1,204 @@
+#include <iostream>
+
+#include "GLState.h"
+
+namespace GLState {
+
+	// sentinel for "not known", never a valid GL name
+	static const unsigned int UNKNOWN = 0xFFFFFFFFu;
+	static const unsigned int MAX_TEXTURE_UNITS = 32;
+
+	// texture targets with their own binding point on every unit
+	enum TextureTarget {
+		TARGET_2D,
+		TARGET_2D_ARRAY,
+		TARGET_3D,
+		TARGET_CUBE_MAP,
+		TARGET_COUNT
+	};
+
+	// buffer targets whose binding is not part of the vertex array state
+	enum BufferTarget {
+		BUFFER_ARRAY,
+		BUFFER_ELEMENT_ARRAY,
+		BUFFER_PIXEL_UNPACK,
+		BUFFER_PIXEL_PACK,
+		BUFFER_UNIFORM,
+		BUFFER_COPY_READ,
+		BUFFER_COPY_WRITE,
+		BUFFER_COUNT
+	};
+
+	static unsigned int currentProgram = UNKNOWN;
+	static unsigned int currentVertexArray = UNKNOWN;
+	static unsigned int currentActiveUnit = UNKNOWN;
+	static unsigned int currentBuffers[BUFFER_COUNT] = { UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN };
+	static unsigned int currentTextures[MAX_TEXTURE_UNITS][TARGET_COUNT];
+	static bool texturesKnown = false;
+	static Counters counters;
+
+	static int textureTargetIndex(GLenum target) {
+		switch (target) {
+		case GL_TEXTURE_2D: return TARGET_2D;
+		case GL_TEXTURE_2D_ARRAY: return TARGET_2D_ARRAY;
+		case GL_TEXTURE_3D: return TARGET_3D;
+		case GL_TEXTURE_CUBE_MAP: return TARGET_CUBE_MAP;
+		default: return -1;
+		}
+	}
+
+	static int bufferTargetIndex(GLenum target) {
+		switch (target) {
+		case GL_ARRAY_BUFFER: return BUFFER_ARRAY;
+		case GL_ELEMENT_ARRAY_BUFFER: return BUFFER_ELEMENT_ARRAY;
+		case GL_PIXEL_UNPACK_BUFFER: return BUFFER_PIXEL_UNPACK;
+		case GL_PIXEL_PACK_BUFFER: return BUFFER_PIXEL_PACK;
+		case GL_UNIFORM_BUFFER: return BUFFER_UNIFORM;
+		case GL_COPY_READ_BUFFER: return BUFFER_COPY_READ;
+		case GL_COPY_WRITE_BUFFER: return BUFFER_COPY_WRITE;
+		default: return -1;
+		}
+	}
+
+	static void forgetTextures() {
+		for (unsigned int unit = 0; unit < MAX_TEXTURE_UNITS; unit++) {
+			for (int target = 0; target < TARGET_COUNT; target++) {
+				currentTextures[unit][target] = UNKNOWN;
+			}
+		}
+		texturesKnown = true;
+	}
+
+	void useProgram(unsigned int program) {
+		if (program == currentProgram) {
+			counters.programsElided++;
+			return;
+		}
+		glUseProgram(program);
+		currentProgram = program;
+		counters.programsIssued++;
+	}
+
+	void bindVertexArray(unsigned int vertexArray) {
+		if (vertexArray == currentVertexArray) {
+			counters.vertexArraysElided++;
+			return;
+		}
+		glBindVertexArray(vertexArray);
+		currentVertexArray = vertexArray;
+		// the element array binding belongs to the vertex array
+		currentBuffers[BUFFER_ELEMENT_ARRAY] = UNKNOWN;
+		counters.vertexArraysIssued++;
+	}
+
+	void bindBuffer(GLenum target, unsigned int buffer) {
+		int index = bufferTargetIndex(target);
+		if (index >= 0 && currentBuffers[index] == buffer) {
+			counters.buffersElided++;
+			return;
+		}
+		glBindBuffer(target, buffer);
+		if (index >= 0) {
+			currentBuffers[index] = buffer;
+		}
+		counters.buffersIssued++;
+	}
+
+	void activeTexture(unsigned int unit) {
+		if (unit == currentActiveUnit) {
+			counters.activeTexturesElided++;
+			return;
+		}
+		glActiveTexture(GL_TEXTURE0 + unit);
+		currentActiveUnit = unit;
+		counters.activeTexturesIssued++;
+	}
+
+	// binds the texture to the unit, switching the active unit only if needed
+	void bindTexture(unsigned int unit, GLenum target, unsigned int texture) {
+		if (!texturesKnown) {
+			forgetTextures();
+		}
+		int index = textureTargetIndex(target);
+		bool cached = index >= 0 && unit < MAX_TEXTURE_UNITS;
+		if (cached && currentTextures[unit][index] == texture) {
+			counters.texturesElided++;
+			return;
+		}
+		activeTexture(unit);
+		glBindTexture(target, texture);
+		if (cached) {
+			currentTextures[unit][index] = texture;
+		}
+		counters.texturesIssued++;
+	}
+
+	// deletes that also forget the name, so a recycled name is never mistaken for bound
+	void deleteProgram(unsigned int program) {
+		glDeleteProgram(program);
+		if (program == currentProgram) {
+			currentProgram = UNKNOWN;
+		}
+	}
+
+	void deleteVertexArray(unsigned int vertexArray) {
+		glDeleteVertexArrays(1, &vertexArray);
+		// deleting the bound vertex array reverts to 0
+		if (vertexArray == currentVertexArray) {
+			currentVertexArray = 0;
+			currentBuffers[BUFFER_ELEMENT_ARRAY] = UNKNOWN;
+		}
+	}
+
+	void deleteBuffer(unsigned int buffer) {
+		glDeleteBuffers(1, &buffer);
+		for (int index = 0; index < BUFFER_COUNT; index++) {
+			if (currentBuffers[index] == buffer) {
+				currentBuffers[index] = 0;
+			}
+		}
+	}
+
+	void deleteTexture(unsigned int texture) {
+		glDeleteTextures(1, &texture);
+		if (!texturesKnown) {
+			return;
+		}
+		// deleted textures are unbound from every unit
+		for (unsigned int unit = 0; unit < MAX_TEXTURE_UNITS; unit++) {
+			for (int target = 0; target < TARGET_COUNT; target++) {
+				if (currentTextures[unit][target] == texture) {
+					currentTextures[unit][target] = 0;
+				}
+			}
+		}
+	}
+
+	// forget everything, the next call of each kind always reaches the driver
+	void invalidate() {
+		currentProgram = UNKNOWN;
+		currentVertexArray = UNKNOWN;
+		currentActiveUnit = UNKNOWN;
+		for (int index = 0; index < BUFFER_COUNT; index++) {
+			currentBuffers[index] = UNKNOWN;
+		}
+		forgetTextures();
+	}
+
+	const Counters& getCounters() {
+		return counters;
+	}
+
+	void resetCounters() {
+		counters = Counters();
+	}
+
+	void printCounters() {
+		std::cout << "GL state calls (issued/elided): programs " << counters.programsIssued << "/" << counters.programsElided
+			<< ", vertex arrays " << counters.vertexArraysIssued << "/" << counters.vertexArraysElided
+			<< ", buffers " << counters.buffersIssued << "/" << counters.buffersElided
+			<< ", active texture " << counters.activeTexturesIssued << "/" << counters.activeTexturesElided
+			<< ", textures " << counters.texturesIssued << "/" << counters.texturesElided << std::endl;
+	}
+
+}
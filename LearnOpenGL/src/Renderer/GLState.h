@@ -0,0 +1,48 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+// shadow copy of the bind state, every bind in the engine goes through here so calls that
+// would not change anything never reach the driver.
+// code that binds behind its back has to call invalidate() afterwards
+namespace GLState {
+
+	// calls per kind, issued reached the driver and elided were skipped
+	struct Counters {
+		unsigned long programsIssued = 0;
+		unsigned long programsElided = 0;
+		unsigned long vertexArraysIssued = 0;
+		unsigned long vertexArraysElided = 0;
+		unsigned long buffersIssued = 0;
+		unsigned long buffersElided = 0;
+		unsigned long activeTexturesIssued = 0;
+		unsigned long activeTexturesElided = 0;
+		unsigned long texturesIssued = 0;
+		unsigned long texturesElided = 0;
+	};
+
+	// binds
+	void useProgram(unsigned int program);
+	void bindVertexArray(unsigned int vertexArray);
+	void bindBuffer(GLenum target, unsigned int buffer);
+	void activeTexture(unsigned int unit);
+	// binds the texture to the unit, switching the active unit only if needed
+	void bindTexture(unsigned int unit, GLenum target, unsigned int texture);
+
+	// deletes that also forget the name, so a recycled name is never mistaken for bound
+	void deleteProgram(unsigned int program);
+	void deleteVertexArray(unsigned int vertexArray);
+	void deleteBuffer(unsigned int buffer);
+	void deleteTexture(unsigned int texture);
+
+	// forget everything, the next call of each kind always reaches the driver
+	void invalidate();
+
+	const Counters& getCounters();
+	void resetCounters();
+	void printCounters();
+
+}
+
+#endif // GL_STATE_H
@@ -0,0 +1,48 @@
+#include "InstanceBuffer.h"
+#include "GLState.h"
+
+// constructor
+InstanceBuffer::InstanceBuffer() : VBO(0), capacity(0), count(0) {
+	glGenBuffers(1, &VBO);
+}
+
+// destructor
+InstanceBuffer::~InstanceBuffer() {
+	GLState::deleteBuffer(VBO);
+}
+
+// add the per instance attributes to a vertex array, the vertex array must be bound
+void InstanceBuffer::attach() const {
+	attachBuffer(VBO, 0);
+}
+
+// same for instance data living in another buffer, e.g. streamed through a StreamBuffer
+void InstanceBuffer::attachBuffer(unsigned int buffer, size_t byteOffset) {
+	GLState::bindBuffer(GL_ARRAY_BUFFER, buffer);
+	// advance once per instance instead of once per vertex
+	InstanceLayout::apply(byteOffset, 1);
+}
+
+// replace the instance data, the buffer is reallocated (orphaned) every time
+void InstanceBuffer::upload(const std::vector<InstanceData>& instances) {
+	GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
+	size_t bytes = instances.size() * sizeof(InstanceData);
+	if (instances.size() > capacity) {
+		capacity = instances.size();
+		glBufferData(GL_ARRAY_BUFFER, bytes, instances.data(), GL_DYNAMIC_DRAW);
+	}
+	else {
+		// orphan the old storage so the GPU can keep reading it while we write
+		glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(InstanceData), NULL, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
+	}
+	count = instances.size();
+}
+
+unsigned int InstanceBuffer::getID() const {
+	return VBO;
+}
+
+size_t InstanceBuffer::size() const {
+	return count;
+}
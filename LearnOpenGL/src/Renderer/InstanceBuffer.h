@@ -0,0 +1,68 @@
+#ifndef INSTANCE_BUFFER_H
+#define INSTANCE_BUFFER_H
+
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "VertexLayout.h"
+
+// per instance data read by instancedVertexShaderSource.vert
+struct InstanceData {
+	float offset[2];
+	float scale;
+	// texture array layer
+	float layer;
+	// RGBA tint, normalized in the shader
+	unsigned char color[4];
+	// the image's rectangle inside the layer (see TextureAtlas::Region) as offset x, y and scale x, y,
+	// normalized to [0, 1]. { 0, 0, 65535, 65535 } samples the whole layer
+	unsigned short texRect[4];
+};
+
+// locations 3-7 follow the per vertex attributes of StandardVertexLayout
+typedef VertexLayout<InstanceData,
+	VERTEX_ATTRIBUTE(InstanceData, offset, 3),
+	VERTEX_ATTRIBUTE(InstanceData, scale, 4),
+	VERTEX_ATTRIBUTE(InstanceData, layer, 5),
+	VERTEX_ATTRIBUTE_NORMALIZED(InstanceData, color, 6),
+	VERTEX_ATTRIBUTE_NORMALIZED(InstanceData, texRect, 7)
+> InstanceLayout;
+
+// vertex buffer holding one InstanceData per instance, advanced once per instance
+// through glVertexAttribDivisor so a single glDrawElementsInstanced draws all of them
+class InstanceBuffer {
+private:
+	unsigned int VBO;
+	// in instances
+	size_t capacity;
+	size_t count;
+
+public:
+	// first attribute location used by the instance data (locations 3-7)
+	static const unsigned int FIRST_LOCATION = InstanceLayout::attributes[0].location;
+
+	// constructor
+	InstanceBuffer();
+
+	// destructor
+	~InstanceBuffer();
+
+	InstanceBuffer(const InstanceBuffer&) = delete;
+	InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+	// add the per instance attributes to a vertex array, the vertex array must be bound
+	void attach() const;
+
+	// same for instance data living in another buffer, e.g. streamed through a StreamBuffer
+	static void attachBuffer(unsigned int buffer, size_t byteOffset);
+
+	// replace the instance data, the buffer is reallocated (orphaned) every time
+	void upload(const std::vector<InstanceData>& instances);
+
+	// getters
+	unsigned int getID() const;
+	size_t size() const;
+};
+
+#endif // INSTANCE_BUFFER_H
@@ -0,0 +1,158 @@
+#include "RenderQueue.h"
+#include "GLState.h"
+
+void DrawPacket::setTexture(unsigned int unit, unsigned int texture, GLenum target) {
+	if (unit >= MAX_TEXTURES) {
+		return;
+	}
+	textures[unit] = texture;
+	textureTargets[unit] = target;
+	if (unit + 1 > textureCount) {
+		textureCount = unit + 1;
+	}
+}
+
+void DrawPacket::setFloat(UniformId uniform, float value) {
+	if (uniformCount == MAX_UNIFORMS) {
+		return;
+	}
+	UniformValue& entry = uniforms[uniformCount++];
+	entry.uniform = uniform;
+	entry.isFloat = true;
+	entry.floatValue = value;
+}
+
+void DrawPacket::setInt(UniformId uniform, int value) {
+	if (uniformCount == MAX_UNIFORMS) {
+		return;
+	}
+	UniformValue& entry = uniforms[uniformCount++];
+	entry.uniform = uniform;
+	entry.isFloat = false;
+	entry.intValue = value;
+}
+
+// key layout from the most significant bit:
+// layer (4) | program (12) | texture 0 (14) | texture 1 (14) | vertex array (12) | depth (8)
+uint64_t RenderQueue::makeSortKey(const DrawPacket& packet) {
+	// GL names are small integers, masking them only costs sort quality if they grow past the field
+	uint64_t program = packet.shader ? packet.shader->getID() & 0xFFF : 0;
+	uint64_t texture0 = packet.textureCount > 0 ? packet.textures[0] & 0x3FFF : 0;
+	uint64_t texture1 = packet.textureCount > 1 ? packet.textures[1] & 0x3FFF : 0;
+	return ((uint64_t)(packet.layer & 0xF) << 60)
+		| (program << 48)
+		| (texture0 << 34)
+		| (texture1 << 20)
+		| ((uint64_t)(packet.vertexArray & 0xFFF) << 8)
+		| (uint64_t)packet.depth;
+}
+
+// add a packet for this frame
+void RenderQueue::submit(const DrawPacket& packet) {
+	keys.push_back(makeSortKey(packet));
+	order.push_back((uint32_t)packets.size());
+	packets.push_back(packet);
+}
+
+// LSD radix sort of order[] by keys[], one byte per pass, skipping bytes that are all equal
+void RenderQueue::sort() {
+	size_t count = keys.size();
+	if (count < 2) {
+		return;
+	}
+	// one read over the keys builds the histograms of all eight bytes
+	uint32_t histograms[8][256] = {};
+	for (size_t i = 0; i < count; i++) {
+		uint64_t key = keys[i];
+		for (int pass = 0; pass < 8; pass++) {
+			histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+		}
+	}
+
+	sortKeys.resize(count);
+	sortOrder.resize(count);
+	for (int pass = 0; pass < 8; pass++) {
+		uint32_t* histogram = histograms[pass];
+		int shift = pass * 8;
+		// every key has the same byte here, the pass would not move anything
+		if (histogram[(keys[0] >> shift) & 0xFF] == count) {
+			continue;
+		}
+		uint32_t offset = 0;
+		for (int bucket = 0; bucket < 256; bucket++) {
+			uint32_t bucketSize = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucketSize;
+		}
+		// stable scatter, so equal keys keep their submission order
+		for (size_t i = 0; i < count; i++) {
+			uint32_t destination = histogram[(keys[i] >> shift) & 0xFF]++;
+			sortKeys[destination] = keys[i];
+			sortOrder[destination] = order[i];
+		}
+		keys.swap(sortKeys);
+		order.swap(sortOrder);
+	}
+}
+
+void RenderQueue::draw(const DrawPacket& packet, const DrawPacket* previous) {
+	if (!previous || previous->shader != packet.shader) {
+		statistics.programSwitches++;
+	}
+	if (packet.shader) {
+		// GLState drops the call when the program is already bound
+		GLState::useProgram(packet.shader->getID());
+	}
+	for (unsigned int unit = 0; unit < packet.textureCount; unit++) {
+		if (!previous || unit >= previous->textureCount || previous->textures[unit] != packet.textures[unit]) {
+			statistics.textureSwitches++;
+		}
+		GLState::bindTexture(unit, packet.textureTargets[unit], packet.textures[unit]);
+	}
+	if (!previous || previous->vertexArray != packet.vertexArray) {
+		statistics.vertexArraySwitches++;
+	}
+	GLState::bindVertexArray(packet.vertexArray);
+
+	if (packet.shader) {
+		for (unsigned int i = 0; i < packet.uniformCount; i++) {
+			const DrawPacket::UniformValue& value = packet.uniforms[i];
+			if (value.isFloat) {
+				packet.shader->setFloat(value.uniform, value.floatValue);
+			}
+			else {
+				packet.shader->setInt(value.uniform, value.intValue);
+			}
+		}
+	}
+
+	if (packet.instanceCount > 1) {
+		glDrawElementsInstanced(packet.mode, packet.indexCount, packet.indexType, (void*)packet.indexOffset, packet.instanceCount);
+	}
+	else {
+		glDrawElements(packet.mode, packet.indexCount, packet.indexType, (void*)packet.indexOffset);
+	}
+}
+
+// sort, draw and clear every submitted packet
+void RenderQueue::flush() {
+	statistics = Statistics();
+	statistics.packets = (unsigned int)packets.size();
+	sort();
+	const DrawPacket* previous = NULL;
+	for (uint32_t index : order) {
+		draw(packets[index], previous);
+		previous = &packets[index];
+	}
+	packets.clear();
+	keys.clear();
+	order.clear();
+}
+
+size_t RenderQueue::size() const {
+	return packets.size();
+}
+
+const RenderQueue::Statistics& RenderQueue::getStatistics() const {
+	return statistics;
+}
@@ -0,0 +1,95 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <vector>
+#include <cstdint>
+
+#include <glad/glad.h>
+
+#include "../ShaderManager/Shader.h"
+
+// everything needed to issue one draw call
+struct DrawPacket {
+	static const unsigned int MAX_TEXTURES = 4;
+	static const unsigned int MAX_UNIFORMS = 8;
+
+	// a uniform value set right before the draw
+	struct UniformValue {
+		UniformId uniform;
+		bool isFloat;
+		union {
+			float floatValue;
+			int intValue;
+		};
+	};
+
+	const Shader* shader = NULL;
+	// textures[i] is bound to unit i
+	unsigned int textures[MAX_TEXTURES] = {};
+	GLenum textureTargets[MAX_TEXTURES] = { GL_TEXTURE_2D, GL_TEXTURE_2D, GL_TEXTURE_2D, GL_TEXTURE_2D };
+	unsigned int textureCount = 0;
+	unsigned int vertexArray = 0;
+
+	GLenum mode = GL_TRIANGLES;
+	GLenum indexType = GL_UNSIGNED_INT;
+	unsigned int indexCount = 0;
+	// byte offset into the element array buffer
+	size_t indexOffset = 0;
+	unsigned int instanceCount = 1;
+
+	UniformValue uniforms[MAX_UNIFORMS];
+	unsigned int uniformCount = 0;
+
+	// coarse ordering that wins over state, e.g. opaque before transparent
+	unsigned char layer = 0;
+	// finest sort criteria inside equal state, e.g. quantized depth
+	unsigned char depth = 0;
+
+	void setTexture(unsigned int unit, unsigned int texture, GLenum target = GL_TEXTURE_2D);
+	void setFloat(UniformId uniform, float value);
+	void setInt(UniformId uniform, int value);
+};
+
+// collects draw packets during the frame, then sorts them by a packed 64-bit state key so
+// that packets sharing a program, textures and vertex array are drawn back to back
+class RenderQueue {
+public:
+	// what the last flush() had to change between draws
+	struct Statistics {
+		unsigned int packets = 0;
+		unsigned int programSwitches = 0;
+		unsigned int textureSwitches = 0;
+		unsigned int vertexArraySwitches = 0;
+	};
+
+private:
+	std::vector<DrawPacket> packets;
+	std::vector<uint64_t> keys;
+	std::vector<uint32_t> order;
+	// ping-pong buffers for the radix sort
+	std::vector<uint64_t> sortKeys;
+	std::vector<uint32_t> sortOrder;
+	Statistics statistics;
+
+	// LSD radix sort of order[] by keys[], one byte per pass, skipping bytes that are all equal
+	void sort();
+	void draw(const DrawPacket& packet, const DrawPacket* previous);
+
+public:
+
+	// key layout from the most significant bit:
+	// layer (4) | program (12) | texture 0 (14) | texture 1 (14) | vertex array (12) | depth (8)
+	static uint64_t makeSortKey(const DrawPacket& packet);
+
+	// add a packet for this frame
+	void submit(const DrawPacket& packet);
+
+	// sort, draw and clear every submitted packet
+	void flush();
+
+	// getters
+	size_t size() const;
+	const Statistics& getStatistics() const;
+};
+
+#endif // RENDER_QUEUE_H
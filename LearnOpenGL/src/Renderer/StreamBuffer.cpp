@@ -0,0 +1,150 @@
+#include <iostream>
+
+#include "StreamBuffer.h"
+#include "GLState.h"
+#include "../Utility/GLExtensions.h"
+
+// allocating, mapping and unmapping go through a binding no VAO or draw reads. binding GL_ELEMENT_ARRAY_BUFFER
+// would replace the index buffer of whatever VAO is bound, target is only bound by the code that draws
+static const GLenum WRITE_TARGET = GL_COPY_WRITE_BUFFER;
+
+// constructor, regionSize is the most that can be written per frame
+StreamBuffer::StreamBuffer(GLenum target, size_t regionSize)
+	: target(target), buffer(0), regionSize(regionSize), currentRegion(REGION_COUNT - 1),
+	  writeOffset(0), persistent(false), mapped(NULL), mappedStart(0) {
+	for (int region = 0; region < REGION_COUNT; region++) {
+		fences[region] = NULL;
+	}
+	// keep every region aligned for any attribute type
+	this->regionSize = ((regionSize > 0 ? regionSize : 1) + 255) & ~(size_t)255;
+	size_t totalSize = this->regionSize * REGION_COUNT;
+
+	glGenBuffers(1, &buffer);
+	GLState::bindBuffer(WRITE_TARGET, buffer);
+
+	bool bufferStorage = (GLExtensions::hasVersion(4, 4) || GLExtensions::has("GL_ARB_buffer_storage"))
+		&& GLExtensions::loadProc(glad_glBufferStorage, "glBufferStorage");
+	if (bufferStorage) {
+		// coherent, so writes need neither a flush nor a barrier before the draw
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(WRITE_TARGET, totalSize, NULL, flags);
+		mapped = (unsigned char*)glMapBufferRange(WRITE_TARGET, 0, totalSize, flags);
+		persistent = mapped != NULL;
+	}
+	if (!persistent) {
+		if (bufferStorage) {
+			// immutable storage can not be respecified, start over with a mutable buffer
+			GLState::deleteBuffer(buffer);
+			glGenBuffers(1, &buffer);
+			GLState::bindBuffer(WRITE_TARGET, buffer);
+		}
+		glBufferData(WRITE_TARGET, totalSize, NULL, GL_STREAM_DRAW);
+		mapped = NULL;
+	}
+}
+
+// destructor
+StreamBuffer::~StreamBuffer() {
+	for (int region = 0; region < REGION_COUNT; region++) {
+		if (fences[region]) {
+			glDeleteSync(fences[region]);
+		}
+	}
+	if (mapped) {
+		GLState::bindBuffer(WRITE_TARGET, buffer);
+		glUnmapBuffer(WRITE_TARGET);
+	}
+	GLState::deleteBuffer(buffer);
+}
+
+// move on to the next region, waiting only if the GPU is still reading it
+void StreamBuffer::beginFrame() {
+	currentRegion = (currentRegion + 1) % REGION_COUNT;
+	writeOffset = 0;
+	statistics.frames++;
+
+	GLsync& fence = fences[currentRegion];
+	if (fence) {
+		// with three regions the GPU is normally done long ago and this returns at once
+		GLenum result = glClientWaitSync(fence, 0, 0);
+		if (result == GL_TIMEOUT_EXPIRED) {
+			statistics.stalls++;
+			while (result == GL_TIMEOUT_EXPIRED) {
+				result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+			}
+		}
+		glDeleteSync(fence);
+		fence = NULL;
+	}
+}
+
+void StreamBuffer::mapRegion() {
+	// nothing the GPU may still read is touched: the region was fenced in beginFrame.
+	// only the unwritten rest is mapped, invalidating it must not lose earlier writes of this frame
+	GLState::bindBuffer(WRITE_TARGET, buffer);
+	mappedStart = writeOffset;
+	mapped = (unsigned char*)glMapBufferRange(WRITE_TARGET, currentRegion * regionSize + mappedStart, regionSize - mappedStart,
+		GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT);
+	if (mapped == NULL) {
+		std::cout << "ERROR::STREAM_BUFFER::MAP_FAILED" << std::endl;
+	}
+}
+
+// reserve bytes in the current region, pointer is NULL if the region is full
+StreamBuffer::Allocation StreamBuffer::allocate(size_t bytes, size_t alignment) {
+	Allocation allocation = { NULL, 0 };
+	size_t start = (writeOffset + alignment - 1) / alignment * alignment;
+	if (start + bytes > regionSize) {
+		statistics.overflows++;
+		return allocation;
+	}
+	if (!persistent && mapped == NULL) {
+		mapRegion();
+		if (mapped == NULL) {
+			return allocation;
+		}
+	}
+	size_t regionStart = currentRegion * regionSize;
+	// the persistent mapping covers the whole buffer, the fallback mapping only this region
+	allocation.pointer = persistent ? mapped + regionStart + start : mapped + (start - mappedStart);
+	allocation.offset = regionStart + start;
+	writeOffset = start + bytes;
+	statistics.bytes += bytes;
+	return allocation;
+}
+
+// make the writes visible to the GPU, call after writing and before drawing
+void StreamBuffer::finishWrites() {
+	if (persistent || mapped == NULL) {
+		return;
+	}
+	GLState::bindBuffer(WRITE_TARGET, buffer);
+	glFlushMappedBufferRange(WRITE_TARGET, 0, writeOffset - mappedStart);
+	glUnmapBuffer(WRITE_TARGET);
+	mapped = NULL;
+}
+
+// fence the region after the draws that read it were issued
+void StreamBuffer::endFrame() {
+	finishWrites();
+	if (fences[currentRegion]) {
+		glDeleteSync(fences[currentRegion]);
+	}
+	fences[currentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+GLenum StreamBuffer::getTarget() const {
+	return target;
+}
+
+unsigned int StreamBuffer::getID() const {
+	return buffer;
+}
+
+bool StreamBuffer::isPersistent() const {
+	return persistent;
+}
+
+const StreamBuffer::Statistics& StreamBuffer::getStatistics() const {
+	return statistics;
+}
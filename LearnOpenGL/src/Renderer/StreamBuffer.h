@@ -0,0 +1,81 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <cstddef>
+
+#include <glad/glad.h>
+
+// ring buffer for data that changes every frame (sprites, debug lines, particles, instances).
+// the buffer is split into one region per frame in flight; the CPU writes straight into the
+// mapped region of the current frame while the GPU reads the older ones, and a fence per
+// region tells when it can be written again.
+// with ARB_buffer_storage (core in 4.4) the whole buffer stays persistently mapped, otherwise
+// each frame's region is mapped with GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT
+class StreamBuffer {
+public:
+	// where an allocation can be written and where the GPU will find it
+	struct Allocation {
+		void* pointer;
+		// byte offset from the start of the buffer, use it for attribute pointers or index offsets
+		size_t offset;
+	};
+
+	struct Statistics {
+		unsigned long frames = 0;
+		unsigned long bytes = 0;
+		// times beginFrame() found the GPU still reading the region and had to wait
+		unsigned long stalls = 0;
+		// allocations that did not fit into the region
+		unsigned long overflows = 0;
+	};
+
+	static const int REGION_COUNT = 3;
+
+private:
+	// what the data is drawn from, never bound by the buffer itself
+	GLenum target;
+	unsigned int buffer;
+	size_t regionSize;
+	int currentRegion;
+	size_t writeOffset;
+	bool persistent;
+	// persistent mapping of the whole buffer, or the mapped part of the current region in the fallback path
+	unsigned char* mapped;
+	// fallback path only, offset inside the region where the mapping starts
+	size_t mappedStart;
+	GLsync fences[REGION_COUNT];
+	Statistics statistics;
+
+	void mapRegion();
+
+public:
+
+	// constructor, regionSize is the most that can be written per frame and target the binding draws read it through
+	StreamBuffer(GLenum target, size_t regionSize);
+
+	// destructor
+	~StreamBuffer();
+
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+	// move on to the next region, waiting only if the GPU is still reading it
+	void beginFrame();
+
+	// reserve bytes in the current region, pointer is NULL if the region is full
+	Allocation allocate(size_t bytes, size_t alignment = 16);
+
+	// make the writes visible to the GPU, call after writing and before drawing
+	void finishWrites();
+
+	// fence the region after the draws that read it were issued
+	void endFrame();
+
+	// getters
+	GLenum getTarget() const;
+	unsigned int getID() const;
+	bool isPersistent() const;
+	const Statistics& getStatistics() const;
+};
+
+#endif // STREAM_BUFFER_H
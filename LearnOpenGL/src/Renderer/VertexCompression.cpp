@@ -0,0 +1,253 @@
+#include <iostream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "VertexCompression.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VERTEX_COMPRESSION_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace VertexCompression {
+
+	// floats at or above 65536 (2^16) are out of the half range
+	static const unsigned int HALF_OVERFLOW = (127u + 16u) << 23;
+	// 2^-14, the smallest normal half
+	static const unsigned int HALF_SMALLEST_NORMAL = 113u << 23;
+	// 0.5, adding it leaves a float whose low mantissa bits are exactly the half denormal
+	static const unsigned int DENORMAL_MAGIC = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+	// moves the exponent bias from 127 to 15 (wraps around as intended)
+	static const unsigned int EXPONENT_REBIAS = (unsigned int)(15 - 127) << 23;
+
+	static unsigned int floatBits(float value) {
+		unsigned int bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	static float bitsFloat(unsigned int bits) {
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	// branchy version of floatToHalfSSE2, both produce the same bits. half denormals come from adding a magic
+	// float (the FPU does the rounding) instead of multiplying down, float denormals are very slow on x86
+	unsigned short floatToHalf(float value) {
+		unsigned int bits = floatBits(value);
+		unsigned int sign = bits & 0x80000000u;
+		bits ^= sign;
+		unsigned int half;
+		if (bits >= HALF_OVERFLOW) {
+			// NaN stays a (quiet) NaN, everything else becomes infinity
+			half = bits > 0x7f800000u ? 0x7e00 : 0x7c00;
+		}
+		else if (bits < HALF_SMALLEST_NORMAL) {
+			half = floatBits(bitsFloat(bits) + bitsFloat(DENORMAL_MAGIC)) - DENORMAL_MAGIC;
+		}
+		else {
+			// rebias the exponent and round to nearest even on the 13 dropped mantissa bits
+			unsigned int odd = (bits >> 13) & 1;
+			half = (bits + EXPONENT_REBIAS + 0xfffu + odd) >> 13;
+		}
+		return (unsigned short)(half | (sign >> 16));
+	}
+
+	float halfToFloat(unsigned short half) {
+		unsigned int bits = (half & 0x7fffu) << 13;
+		unsigned int exponent = bits & (0x7c00u << 13);
+		// rebias the exponent from 15 to 127
+		bits += (127 - 15) << 23;
+		float value;
+		if (exponent == (0x7c00u << 13)) {
+			// infinity and NaN
+			bits += (128 - 16) << 23;
+			value = bitsFloat(bits);
+		}
+		else if (exponent == 0) {
+			// zero and denormals, renormalized by subtracting the implicit one again
+			bits += 1 << 23;
+			value = bitsFloat(bits) - bitsFloat(113u << 23);
+		}
+		else {
+			value = bitsFloat(bits);
+		}
+		return (half & 0x8000u) ? -value : value;
+	}
+
+	static unsigned char toUnorm8(float value) {
+		return (unsigned char)(int)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+	}
+
+	static unsigned short toUnorm16(float value) {
+		return (unsigned short)(int)(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f + 0.5f);
+	}
+
+	void encodeVerticesScalar(const StandardVertex* vertices, CompactVertex* compact, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			const StandardVertex& vertex = vertices[i];
+			CompactVertex& out = compact[i];
+			for (int c = 0; c < 3; c++) {
+				out.position[c].bits = floatToHalf(vertex.position[c]);
+				out.color[c] = toUnorm8(vertex.color[c]);
+			}
+			out.padding = 0;
+			out.unused = 0;
+			out.texCoord[0] = toUnorm16(vertex.texCoord[0]);
+			out.texCoord[1] = toUnorm16(vertex.texCoord[1]);
+		}
+	}
+
+#ifdef VERTEX_COMPRESSION_SSE2
+	// four lanes of floatToHalf, the result is one half per 32 bit lane
+	static __m128i floatToHalfSSE2(__m128 value) {
+		const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000u));
+		const __m128i infinity = _mm_set1_epi32(0x7f800000);
+		const __m128i overflow = _mm_set1_epi32((int)HALF_OVERFLOW - 1);
+		const __m128i smallestNormal = _mm_set1_epi32((int)HALF_SMALLEST_NORMAL);
+		const __m128i denormalMagic = _mm_set1_epi32((int)DENORMAL_MAGIC);
+		const __m128i rebias = _mm_set1_epi32((int)(EXPONENT_REBIAS + 0xfffu));
+
+		__m128 sign = _mm_and_ps(value, signMask);
+		__m128i absolute = _mm_castps_si128(_mm_xor_ps(value, sign));
+		// all compares are on positive values so the signed integer compare works
+		__m128i isSpecial = _mm_cmpgt_epi32(absolute, overflow);
+		__m128i isNan = _mm_cmpgt_epi32(absolute, infinity);
+		__m128i isDenormal = _mm_cmpgt_epi32(smallestNormal, absolute);
+
+		__m128i special = _mm_or_si128(_mm_and_si128(isNan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00));
+		__m128i denormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(absolute), _mm_castsi128_ps(denormalMagic))), denormalMagic);
+		__m128i odd = _mm_and_si128(_mm_srli_epi32(absolute, 13), _mm_set1_epi32(1));
+		__m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(absolute, rebias), odd), 13);
+
+		__m128i half = _mm_or_si128(_mm_and_si128(isDenormal, denormal), _mm_andnot_si128(isDenormal, normal));
+		half = _mm_or_si128(_mm_and_si128(isSpecial, special), _mm_andnot_si128(isSpecial, half));
+		return _mm_or_si128(half, _mm_srli_epi32(_mm_castps_si128(sign), 16));
+	}
+
+	// packs 32 bit lanes holding 16 bit unsigned values into the low 64 bits (packs_epi32 saturates signed)
+	static __m128i packUnsigned16(__m128i value) {
+		value = _mm_srai_epi32(_mm_slli_epi32(value, 16), 16);
+		return _mm_packs_epi32(value, value);
+	}
+
+	// one vertex per iteration: [px py pz r] and [g b u v] are each one load, the 16 byte result is one store
+	static void encodeVerticesSSE2(const StandardVertex* vertices, CompactVertex* compact, size_t count) {
+		static_assert(sizeof(StandardVertex) == 32 && sizeof(CompactVertex) == 16, "encoder assumes the packed vertex formats");
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 colorScale = _mm_set1_ps(255.0f);
+		const __m128 texCoordScale = _mm_set1_ps(65535.0f);
+		// clears the padding half and the unused colour byte
+		const __m128i positionMask = _mm_set_epi32(0, 0, 0x0000ffff, -1);
+		const __m128i colorMask = _mm_set_epi32(0, 0, 0, 0x00ffffff);
+
+		for (size_t i = 0; i < count; i++) {
+			const float* in = &vertices[i].position[0];
+			__m128 low = _mm_loadu_ps(in);
+			__m128 high = _mm_loadu_ps(in + 4);
+
+			// half position, lane 3 (the red channel) is masked out afterwards
+			__m128i position = _mm_and_si128(packUnsigned16(floatToHalfSSE2(low)), positionMask);
+
+			// [r r g b] -> [r g b r]
+			__m128 color = _mm_shuffle_ps(low, high, _MM_SHUFFLE(1, 0, 3, 3));
+			color = _mm_shuffle_ps(color, color, _MM_SHUFFLE(0, 3, 2, 0));
+			color = _mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(color, zero), one), colorScale), half);
+			__m128i colorInt = _mm_cvttps_epi32(color);
+			colorInt = _mm_packs_epi32(colorInt, colorInt);
+			colorInt = _mm_and_si128(_mm_packus_epi16(colorInt, colorInt), colorMask);
+
+			// [u v u v]
+			__m128 texCoord = _mm_shuffle_ps(high, high, _MM_SHUFFLE(3, 2, 3, 2));
+			texCoord = _mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(texCoord, zero), one), texCoordScale), half);
+			__m128i texCoordInt = packUnsigned16(_mm_cvttps_epi32(texCoord));
+
+			__m128i packed = _mm_unpacklo_epi64(position, _mm_unpacklo_epi32(colorInt, texCoordInt));
+			_mm_storeu_si128((__m128i*)&compact[i], packed);
+		}
+	}
+#endif
+
+	bool isSimd() {
+#ifdef VERTEX_COMPRESSION_SSE2
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void encodeVertices(const StandardVertex* vertices, CompactVertex* compact, size_t count) {
+#ifdef VERTEX_COMPRESSION_SSE2
+		encodeVerticesSSE2(vertices, compact, count);
+#else
+		encodeVerticesScalar(vertices, compact, count);
+#endif
+	}
+
+	void decodeVertices(const CompactVertex* compact, StandardVertex* vertices, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			const CompactVertex& in = compact[i];
+			StandardVertex& vertex = vertices[i];
+			for (int c = 0; c < 3; c++) {
+				vertex.position[c] = halfToFloat(in.position[c].bits);
+				vertex.color[c] = in.color[c] / 255.0f;
+			}
+			vertex.texCoord[0] = in.texCoord[0] / 65535.0f;
+			vertex.texCoord[1] = in.texCoord[1] / 65535.0f;
+		}
+	}
+
+	// encodes and decodes the vertices and checks every attribute against the precision of its format
+	bool checkRoundTrip(const StandardVertex* vertices, size_t count, RoundTripError& error) {
+		error.position = 0.0f;
+		error.color = 0.0f;
+		error.texCoord = 0.0f;
+		if (count == 0) {
+			return true;
+		}
+		CompactVertex* compact = new CompactVertex[count];
+		StandardVertex* decoded = new StandardVertex[count];
+		encodeVertices(vertices, compact, count);
+		decodeVertices(compact, decoded, count);
+
+		// a half has 11 significant bits, anything below the smallest normal half has a fixed step of 2^-24
+		const float positionTolerance = std::ldexp(1.0f, -11);
+		const float smallestNormal = std::ldexp(1.0f, -14);
+		// half a step plus some room for the float arithmetic of the decoder
+		const float colorTolerance = 0.5f / 255.0f + 1e-6f;
+		const float texCoordTolerance = 0.5f / 65535.0f + 1e-7f;
+
+		size_t failures = 0;
+		for (size_t i = 0; i < count; i++) {
+			for (int c = 0; c < 3; c++) {
+				float original = vertices[i].position[c];
+				float difference = std::fabs(decoded[i].position[c] - original);
+				float relative = difference / std::max(std::fabs(original), smallestNormal);
+				error.position = std::max(error.position, relative);
+				error.color = std::max(error.color, std::fabs(decoded[i].color[c] - vertices[i].color[c]));
+			}
+			for (int c = 0; c < 2; c++) {
+				error.texCoord = std::max(error.texCoord, std::fabs(decoded[i].texCoord[c] - vertices[i].texCoord[c]));
+			}
+		}
+		if (error.position > positionTolerance) {
+			std::cout << "ERROR::VERTEX_COMPRESSION::POSITION_ERROR " << error.position << " exceeds " << positionTolerance << std::endl;
+			failures++;
+		}
+		if (error.color > colorTolerance) {
+			std::cout << "ERROR::VERTEX_COMPRESSION::COLOR_ERROR " << error.color << " exceeds " << colorTolerance << std::endl;
+			failures++;
+		}
+		if (error.texCoord > texCoordTolerance) {
+			std::cout << "ERROR::VERTEX_COMPRESSION::TEXCOORD_ERROR " << error.texCoord << " exceeds " << texCoordTolerance << std::endl;
+			failures++;
+		}
+		delete[] compact;
+		delete[] decoded;
+		return failures == 0;
+	}
+}
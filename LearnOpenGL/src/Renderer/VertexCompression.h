@@ -0,0 +1,38 @@
+#ifndef VERTEX_COMPRESSION_H
+#define VERTEX_COMPRESSION_H
+
+#include <cstddef>
+
+#include "VertexFormats.h"
+
+// converts StandardVertex data into the 16 byte CompactVertex format and back
+namespace VertexCompression {
+
+	// largest difference between the original and the decoded vertices, per attribute
+	struct RoundTripError {
+		// relative to the magnitude of the position component
+		float position;
+		float color;
+		float texCoord;
+	};
+
+	// float <-> IEEE half, rounds to nearest even, overflows to infinity and keeps NaN
+	unsigned short floatToHalf(float value);
+	float halfToFloat(unsigned short half);
+
+	// true when this build encodes with SSE2
+	bool isSimd();
+
+	// encodes count vertices, the SIMD path produces exactly the same bytes as encodeVerticesScalar
+	void encodeVertices(const StandardVertex* vertices, CompactVertex* compact, size_t count);
+	void encodeVerticesScalar(const StandardVertex* vertices, CompactVertex* compact, size_t count);
+	void decodeVertices(const CompactVertex* compact, StandardVertex* vertices, size_t count);
+
+	// encodes and decodes the vertices and checks every attribute against the precision of its format:
+	// half a half float ulp for positions, half a step of 1/255 for colours and 1/65535 for texture coordinates.
+	// colours and texture coordinates outside [0, 1] are clamped by the format and expected to fail
+	bool checkRoundTrip(const StandardVertex* vertices, size_t count, RoundTripError& error);
+
+}
+
+#endif // VERTEX_COMPRESSION_H
@@ -0,0 +1,41 @@
+#ifndef VERTEX_FORMATS_H
+#define VERTEX_FORMATS_H
+
+#include "VertexLayout.h"
+
+// interleaved position / colour / texture coordinate vertex read by vertexShaderSource.vert
+struct StandardVertex {
+	float position[3];
+	float color[3];
+	float texCoord[2];
+};
+
+typedef VertexLayout<StandardVertex,
+	VERTEX_ATTRIBUTE(StandardVertex, position, 0),
+	VERTEX_ATTRIBUTE(StandardVertex, color, 1),
+	VERTEX_ATTRIBUTE(StandardVertex, texCoord, 2)
+> StandardVertexLayout;
+
+static_assert(StandardVertexLayout::stride == 8 * sizeof(float), "StandardVertex must stay tightly packed");
+
+// the same vertex in 16 bytes instead of 32, encoded by VertexCompression:
+// half float position, unorm8 colour and unorm16 texture coordinates (the shader still reads floats)
+struct CompactVertex {
+	HalfFloat position[3];
+	// keeps the colour 4 byte aligned
+	unsigned short padding;
+	unsigned char color[3];
+	// fourth colour byte, always 0, vertexShaderSource.vert only reads rgb
+	unsigned char unused;
+	unsigned short texCoord[2];
+};
+
+typedef VertexLayout<CompactVertex,
+	VERTEX_ATTRIBUTE(CompactVertex, position, 0),
+	VERTEX_ATTRIBUTE_NORMALIZED(CompactVertex, color, 1),
+	VERTEX_ATTRIBUTE_NORMALIZED(CompactVertex, texCoord, 2)
+> CompactVertexLayout;
+
+static_assert(CompactVertexLayout::stride == 16, "CompactVertex must stay 16 bytes");
+
+#endif // VERTEX_FORMATS_H
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <cstring>
+
+#include "VertexLayout.h"
+
+namespace VertexLayoutCheck {
+
+	// number of components the shader reads for an attribute type, 0 for types a layout cannot feed
+	static int getComponentCount(GLenum type) {
+		switch (type) {
+		case GL_FLOAT:
+		case GL_INT:
+		case GL_UNSIGNED_INT:
+			return 1;
+		case GL_FLOAT_VEC2:
+		case GL_INT_VEC2:
+		case GL_UNSIGNED_INT_VEC2:
+			return 2;
+		case GL_FLOAT_VEC3:
+		case GL_INT_VEC3:
+		case GL_UNSIGNED_INT_VEC3:
+			return 3;
+		case GL_FLOAT_VEC4:
+		case GL_INT_VEC4:
+		case GL_UNSIGNED_INT_VEC4:
+			return 4;
+		default:
+			return 0;
+		}
+	}
+
+	// compares the active inputs of a linked program with the attributes the vertex arrays provide
+	bool validate(unsigned int program, const char* label, const VertexAttributeInfo* attributes, size_t count) {
+		int activeCount = 0;
+		glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &activeCount);
+		bool valid = true;
+		for (int i = 0; i < activeCount; i++) {
+			char name[256];
+			GLint size = 0;
+			GLenum type = 0;
+			glGetActiveAttrib(program, (GLuint)i, sizeof(name), NULL, &size, &type, name);
+			// built-in inputs such as gl_VertexID have no location
+			int location = glGetAttribLocation(program, name);
+			if (location < 0 || strncmp(name, "gl_", 3) == 0) {
+				continue;
+			}
+
+			const VertexAttributeInfo* attribute = NULL;
+			for (size_t a = 0; a < count; a++) {
+				if (attributes[a].location == (unsigned int)location) {
+					attribute = &attributes[a];
+					break;
+				}
+			}
+			if (attribute == NULL) {
+				std::cout << "ERROR::VERTEX_LAYOUT::MISSING_ATTRIBUTE " << label << ": the shader reads '" << name
+					<< "' at location " << location << " but the vertex layout has nothing there" << std::endl;
+				valid = false;
+				continue;
+			}
+			int expected = getComponentCount(type);
+			if (expected == 0 || expected != attribute->components) {
+				std::cout << "ERROR::VERTEX_LAYOUT::COMPONENT_MISMATCH " << label << ": '" << name << "' at location " << location
+					<< " reads " << expected << " components but the vertex layout provides " << attribute->components << std::endl;
+				valid = false;
+			}
+		}
+		return valid;
+	}
+}
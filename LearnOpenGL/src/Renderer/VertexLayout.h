@@ -0,0 +1,126 @@
+#ifndef VERTEX_LAYOUT_H
+#define VERTEX_LAYOUT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+#include <glad/glad.h>
+
+// what a single attribute looks like once the layout has been resolved, used to check layouts against shaders
+struct VertexAttributeInfo {
+	unsigned int location;
+	// 1 - 4
+	int components;
+	GLenum type;
+	bool normalized;
+	size_t offset;
+};
+
+// IEEE 754 binary16 value, C++ has no half float type so vertex structs store the raw bits
+struct HalfFloat {
+	unsigned short bits;
+};
+
+// maps a C++ component type onto the enum glVertexAttribPointer expects,
+// types without a specialization do not compile as vertex attributes
+template <typename T> struct VertexComponent;
+template <> struct VertexComponent<float>          { static constexpr GLenum type = GL_FLOAT; };
+template <> struct VertexComponent<signed char>    { static constexpr GLenum type = GL_BYTE; };
+template <> struct VertexComponent<unsigned char>  { static constexpr GLenum type = GL_UNSIGNED_BYTE; };
+template <> struct VertexComponent<short>          { static constexpr GLenum type = GL_SHORT; };
+template <> struct VertexComponent<unsigned short> { static constexpr GLenum type = GL_UNSIGNED_SHORT; };
+template <> struct VertexComponent<int>            { static constexpr GLenum type = GL_INT; };
+template <> struct VertexComponent<unsigned int>   { static constexpr GLenum type = GL_UNSIGNED_INT; };
+template <> struct VertexComponent<HalfFloat>      { static constexpr GLenum type = GL_HALF_FLOAT; };
+
+// one member of a vertex struct, declare it through VERTEX_ATTRIBUTE / VERTEX_ATTRIBUTE_NORMALIZED
+// so the member type and offset come straight from the struct definition
+template <unsigned int Location, typename Member, size_t Offset, bool Normalized>
+struct VertexAttribute {
+	typedef typename std::remove_all_extents<Member>::type Component;
+
+	static constexpr unsigned int location = Location;
+	static constexpr int components = std::is_array<Member>::value ? (int)std::extent<Member>::value : 1;
+	static constexpr GLenum type = VertexComponent<Component>::type;
+	static constexpr bool normalized = Normalized;
+	static constexpr size_t offset = Offset;
+	static constexpr size_t size = sizeof(Member);
+
+	static_assert(std::rank<Member>::value <= 1, "vertex attributes must be a scalar or a one dimensional array");
+	static_assert(components >= 1 && components <= 4, "vertex attributes have 1 to 4 components");
+	static_assert(!Normalized || (type != GL_FLOAT && type != GL_HALF_FLOAT), "only integer components can be normalized");
+	static_assert(Offset % sizeof(Component) == 0, "vertex attributes must be aligned to their component size");
+};
+
+#define VERTEX_ATTRIBUTE(Vertex, member, location) \
+	VertexAttribute<location, decltype(Vertex::member), offsetof(Vertex, member), false>
+#define VERTEX_ATTRIBUTE_NORMALIZED(Vertex, member, location) \
+	VertexAttribute<location, decltype(Vertex::member), offsetof(Vertex, member), true>
+
+namespace VertexLayoutDetail {
+	// true when no two attributes use the same location or the same bytes of the vertex
+	template <typename... Attributes>
+	constexpr bool isDisjoint() {
+		constexpr unsigned int locations[] = { Attributes::location... };
+		constexpr size_t begins[] = { Attributes::offset... };
+		constexpr size_t ends[] = { (Attributes::offset + Attributes::size)... };
+		for (size_t i = 0; i < sizeof...(Attributes); i++) {
+			for (size_t j = i + 1; j < sizeof...(Attributes); j++) {
+				if (locations[i] == locations[j] || (begins[i] < ends[j] && begins[j] < ends[i])) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	template <typename Attribute>
+	inline void applyAttribute(GLsizei stride, size_t byteOffset, unsigned int divisor) {
+		glVertexAttribPointer(Attribute::location, Attribute::components, Attribute::type,
+			Attribute::normalized ? GL_TRUE : GL_FALSE, stride, (void*)(byteOffset + Attribute::offset));
+		glEnableVertexAttribArray(Attribute::location);
+		glVertexAttribDivisor(Attribute::location, divisor);
+	}
+}
+
+// describes how a vertex struct maps onto shader inputs, stride, offsets, types and counts are all
+// derived at compile time so apply() compiles down to the glVertexAttribPointer calls one would write by hand
+template <typename Vertex, typename... Attributes>
+struct VertexLayout {
+	typedef Vertex VertexType;
+
+	static constexpr GLsizei stride = sizeof(Vertex);
+	static constexpr size_t attributeCount = sizeof...(Attributes);
+	static constexpr VertexAttributeInfo attributes[] = {
+		{ Attributes::location, Attributes::components, Attributes::type, Attributes::normalized, Attributes::offset }...
+	};
+
+	static_assert(sizeof...(Attributes) > 0, "a vertex layout needs at least one attribute");
+	static_assert(std::is_standard_layout<Vertex>::value, "offsetof is only valid for standard layout vertex structs");
+	static_assert(((Attributes::offset + Attributes::size <= sizeof(Vertex)) && ...), "attribute lies outside of the vertex");
+	static_assert(VertexLayoutDetail::isDisjoint<Attributes...>(), "two attributes share a location or overlap in memory");
+
+	// points every attribute at the buffer bound to GL_ARRAY_BUFFER, the vertex array must be bound,
+	// a divisor of 1 advances the attributes once per instance instead of once per vertex
+	static void apply(size_t byteOffset = 0, unsigned int divisor = 0) {
+		(VertexLayoutDetail::applyAttribute<Attributes>(stride, byteOffset, divisor), ...);
+	}
+};
+
+namespace VertexLayoutCheck {
+	// compares the active inputs of a linked program with the attributes the vertex arrays provide,
+	// prints every input that is missing or has a different component count and returns false if any were found
+	bool validate(unsigned int program, const char* label, const VertexAttributeInfo* attributes, size_t count);
+
+	// same, the attributes are gathered from one or more layouts (e.g. per vertex and per instance)
+	template <typename... Layouts>
+	bool validate(unsigned int program, const char* label) {
+		VertexAttributeInfo attributes[(Layouts::attributeCount + ...)];
+		size_t count = 0;
+		((std::copy(Layouts::attributes, Layouts::attributes + Layouts::attributeCount, attributes + count), count += Layouts::attributeCount), ...);
+		return validate(program, label, attributes, count);
+	}
+}
+
+#endif // VERTEX_LAYOUT_H
@@ -0,0 +1,288 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+#include <functional>
+
+#include "ProgramCache.h"
+#include "../Utility/GLExtensions.h"
+
+namespace ProgramCache {
+
+	// header written in front of every binary
+	struct FileHeader {
+		char magic[4];
+		unsigned int version;
+		unsigned long long key;
+		// the driver that wrote it, entries of any other are pruned
+		unsigned long long driver;
+		// of the binary, a damaged file is never handed to glProgramBinary
+		unsigned long long binaryHash;
+		unsigned int binaryFormat;
+		unsigned int binaryLength;
+	};
+
+	static const char FILE_MAGIC[4] = { 'L', 'O', 'P', 'B' };
+	static const unsigned int FILE_VERSION = 2;
+	// least recently used entries beyond this are pruned
+	static const uintmax_t MAX_CACHE_BYTES = 64 * 1024 * 1024;
+	// temporary files this old were left by a writer that crashed, younger ones may still be written
+	static const std::chrono::minutes TEMPORARY_FILE_AGE(10);
+
+	static std::string cacheDirectory = "shadercache";
+	static Statistics statistics;
+	// -1 until the first query, then 0 or 1
+	static int supported = -1;
+	// the directory is pruned once per run, before the first store
+	static bool pruned = false;
+
+	static unsigned long long hashBytes(unsigned long long hash, const char* data, size_t length) {
+		for (size_t i = 0; i < length; i++) {
+			hash ^= (unsigned char)data[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	static unsigned long long hashString(unsigned long long hash, const char* text) {
+		// the terminator is hashed too so "ab" + "c" and "a" + "bc" differ
+		return hashBytes(hash, text ? text : "", text ? std::char_traits<char>::length(text) + 1 : 1);
+	}
+
+	static std::string cachePath(unsigned long long key) {
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.bin", key);
+		return cacheDirectory + "/" + name;
+	}
+
+	// true if the context can save and load program binaries
+	bool isSupported() {
+		if (supported < 0) {
+			bool available = GLExtensions::hasVersion(4, 1) || GLExtensions::has("GL_ARB_get_program_binary");
+			// ARB_get_program_binary uses the core names, glad only loads them for 4.1 contexts
+			available = available
+				&& GLExtensions::loadProc(glad_glGetProgramBinary, "glGetProgramBinary")
+				&& GLExtensions::loadProc(glad_glProgramBinary, "glProgramBinary")
+				&& GLExtensions::loadProc(glad_glProgramParameteri, "glProgramParameteri");
+			int formats = 0;
+			if (available) {
+				glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+			}
+			supported = available && formats > 0 ? 1 : 0;
+		}
+		return supported == 1;
+	}
+
+	// directory the binaries are written to, "shadercache" by default
+	void setDirectory(const std::string& directory) {
+		cacheDirectory = directory;
+	}
+
+	// the vendor, renderer and version strings, a driver update changes them
+	static unsigned long long makeDriverKey() {
+		unsigned long long hash = 14695981039346656037ull;
+		hash = hashString(hash, (const char*)glGetString(GL_VENDOR));
+		hash = hashString(hash, (const char*)glGetString(GL_RENDERER));
+		hash = hashString(hash, (const char*)glGetString(GL_VERSION));
+		return hash;
+	}
+
+	// key of a program for the current driver
+	unsigned long long makeKey(const std::string& vertexCode, const std::string& fragmentCode) {
+		unsigned long long hash = makeDriverKey();
+		hash = hashBytes(hash, vertexCode.c_str(), vertexCode.size() + 1);
+		hash = hashBytes(hash, fragmentCode.c_str(), fragmentCode.size() + 1);
+		return hash;
+	}
+
+	// returns a linked program from the cache, or 0 if it has to be compiled from source
+	unsigned int load(const std::string& vertexCode, const std::string& fragmentCode) {
+		if (!isSupported()) {
+			statistics.misses++;
+			return 0;
+		}
+		auto start = std::chrono::steady_clock::now();
+		unsigned long long key = makeKey(vertexCode, fragmentCode);
+		std::string path = cachePath(key);
+
+		std::ifstream file(path, std::ios::binary);
+		FileHeader header;
+		if (!file || !file.read((char*)&header, sizeof(header))) {
+			statistics.misses++;
+			return 0;
+		}
+		std::vector<char> binary;
+		bool valid = std::equal(header.magic, header.magic + 4, FILE_MAGIC)
+			&& header.version == FILE_VERSION && header.key == key;
+		if (valid) {
+			binary.resize(header.binaryLength);
+			valid = (bool)file.read(binary.data(), binary.size())
+				&& hashBytes(14695981039346656037ull, binary.data(), binary.size()) == header.binaryHash;
+		}
+		file.close();
+
+		unsigned int program = 0;
+		if (valid) {
+			program = glCreateProgram();
+			glProgramBinary(program, header.binaryFormat, binary.data(), (GLsizei)binary.size());
+			int success = 0;
+			glGetProgramiv(program, GL_LINK_STATUS, &success);
+			if (!success) {
+				glDeleteProgram(program);
+				program = 0;
+			}
+		}
+		if (program == 0) {
+			// stale or corrupt entry, drop it so the recompiled program replaces it
+			std::cout << "WARNING::PROGRAM_CACHE::BINARY_REJECTED " << path << std::endl;
+			std::remove(path.c_str());
+			statistics.rejected++;
+			statistics.misses++;
+			return 0;
+		}
+		// hits count as uses for pruning
+		std::error_code touchError;
+		std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), touchError);
+		statistics.hits++;
+		statistics.hitMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		return program;
+	}
+
+	// call before glLinkProgram so the driver keeps the binary around for store()
+	void prepareForLink(unsigned int program) {
+		if (isSupported()) {
+			glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+	}
+
+	// write a successfully linked program to the cache
+	void store(unsigned int program, const std::string& vertexCode, const std::string& fragmentCode) {
+		if (!isSupported()) {
+			return;
+		}
+		int success = 0;
+		int length = 0;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (!success || length <= 0) {
+			return;
+		}
+		std::vector<char> binary(length);
+		GLenum binaryFormat = 0;
+		glGetProgramBinary(program, length, &length, &binaryFormat, binary.data());
+
+		FileHeader header;
+		std::copy(FILE_MAGIC, FILE_MAGIC + 4, header.magic);
+		header.version = FILE_VERSION;
+		header.key = makeKey(vertexCode, fragmentCode);
+		header.driver = makeDriverKey();
+		header.binaryHash = hashBytes(14695981039346656037ull, binary.data(), (size_t)length);
+		header.binaryFormat = binaryFormat;
+		header.binaryLength = (unsigned int)length;
+
+		if (!pruned) {
+			pruned = true;
+			prune();
+		}
+		std::error_code error;
+		std::filesystem::create_directories(cacheDirectory, error);
+		// written next to the entry and renamed, so neither a crash nor a second instance storing the same program
+		// leaves a truncated binary under the entry's name
+		std::string path = cachePath(header.key);
+		std::string temporary = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+		std::ofstream file(temporary, std::ios::binary);
+		if (!file || !file.write((const char*)&header, sizeof(header)) || !file.write(binary.data(), length)) {
+			std::cout << "WARNING::PROGRAM_CACHE::FAILED_TO_WRITE " << temporary << std::endl;
+			file.close();
+			std::remove(temporary.c_str());
+			return;
+		}
+		file.close();
+		std::filesystem::rename(temporary, path, error);
+		if (error) {
+			std::cout << "WARNING::PROGRAM_CACHE::FAILED_TO_WRITE " << path << " (" << error.message() << ")" << std::endl;
+			std::remove(temporary.c_str());
+			return;
+		}
+		statistics.stored++;
+	}
+
+	// drops entries of other drivers or file versions, temporary files of crashed writers and the least recently used
+	// entries beyond MAX_CACHE_BYTES
+	void prune() {
+		namespace fs = std::filesystem;
+		std::error_code error;
+		fs::directory_iterator iterator(cacheDirectory, error);
+		if (error) {
+			return;
+		}
+		unsigned long long driver = makeDriverKey();
+		fs::file_time_type now = fs::file_time_type::clock::now();
+		struct CachedFile {
+			fs::path path;
+			fs::file_time_type lastUse;
+			uintmax_t size;
+		};
+		std::vector<CachedFile> current;
+		for (const fs::directory_entry& entry : iterator) {
+			std::error_code entryError;
+			fs::file_time_type lastUse = entry.last_write_time(entryError);
+			uintmax_t size = entry.file_size(entryError);
+			if (entryError) {
+				continue;
+			}
+			if (entry.path().extension() == ".tmp") {
+				if (now - lastUse > TEMPORARY_FILE_AGE) {
+					fs::remove(entry.path(), entryError);
+				}
+				continue;
+			}
+			if (entry.path().extension() != ".bin") {
+				continue;
+			}
+			std::ifstream file(entry.path(), std::ios::binary);
+			FileHeader header;
+			bool valid = file && file.read((char*)&header, sizeof(header)) && std::equal(header.magic, header.magic + 4, FILE_MAGIC)
+				&& header.version == FILE_VERSION && header.driver == driver;
+			file.close();
+			if (!valid) {
+				fs::remove(entry.path(), entryError);
+				statistics.evicted++;
+				continue;
+			}
+			current.push_back(CachedFile{ entry.path(), lastUse, size });
+		}
+		// most recently used first, the ones past the budget go
+		std::sort(current.begin(), current.end(), [](const CachedFile& a, const CachedFile& b) { return a.lastUse > b.lastUse; });
+		uintmax_t total = 0;
+		for (const CachedFile& file : current) {
+			total += file.size;
+			if (total > MAX_CACHE_BYTES) {
+				std::error_code removeError;
+				fs::remove(file.path, removeError);
+				statistics.evicted++;
+			}
+		}
+	}
+
+	// add the time of a compile from source to the miss counters
+	void recordCompile(double milliseconds) {
+		statistics.missMilliseconds += milliseconds;
+	}
+
+	const Statistics& getStatistics() {
+		return statistics;
+	}
+
+	void printStatistics() {
+		std::cout << "Program cache: " << statistics.hits << " hits (" << statistics.hitMilliseconds << " ms), "
+			<< statistics.misses << " misses (" << statistics.missMilliseconds << " ms), "
+			<< statistics.rejected << " rejected, " << statistics.stored << " stored, " << statistics.evicted << " evicted"
+			<< (isSupported() ? "" : " [program binaries not supported]") << std::endl;
+	}
+
+}
@@ -0,0 +1,58 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <string>
+
+#include <glad/glad.h>
+
+// persistent cache of linked programs through glGetProgramBinary/glProgramBinary.
+// entries are keyed by the shader sources and the driver vendor/renderer/version strings,
+// so a driver update or an edited shader simply misses and recompiles from source. entries are written to a
+// temporary file and renamed into place, and the first store of a run prunes the directory
+namespace ProgramCache {
+
+	// startup counters
+	struct Statistics {
+		unsigned int hits = 0;
+		unsigned int misses = 0;
+		// binaries that existed but the driver refused to load
+		unsigned int rejected = 0;
+		unsigned int stored = 0;
+		// entries prune() deleted
+		unsigned int evicted = 0;
+		// time spent loading binaries and compiling from source
+		double hitMilliseconds = 0.0;
+		double missMilliseconds = 0.0;
+	};
+
+	// true if the context can save and load program binaries
+	bool isSupported();
+
+	// directory the binaries are written to, "shadercache" by default
+	void setDirectory(const std::string& directory);
+
+	// key of a program for the current driver
+	unsigned long long makeKey(const std::string& vertexCode, const std::string& fragmentCode);
+
+	// returns a linked program from the cache, or 0 if it has to be compiled from source
+	unsigned int load(const std::string& vertexCode, const std::string& fragmentCode);
+
+	// call before glLinkProgram so the driver keeps the binary around for store()
+	void prepareForLink(unsigned int program);
+
+	// write a successfully linked program to the cache
+	void store(unsigned int program, const std::string& vertexCode, const std::string& fragmentCode);
+
+	// deletes entries written by another driver or file version, temporary files a crashed writer left behind and
+	// the least recently used entries once the directory is over 64 MB
+	void prune();
+
+	// add the time of a compile from source to the miss counters
+	void recordCompile(double milliseconds);
+
+	const Statistics& getStatistics();
+	void printStatistics();
+
+}
+
+#endif // PROGRAM_CACHE_H
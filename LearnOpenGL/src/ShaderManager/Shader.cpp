@@ -1,36 +1,66 @@
+#include <chrono>
+
 #include "Shader.h"
+#include "ProgramCache.h"
+#include "../Renderer/GLState.h"
 
 // constructor
 Shader::Shader(const char* vertexPath, const char* fragmentPath) {
 	// first retrieve the vertex/fragment source code from the path in the function parameter
 	std::string vertexCode;
 	std::string fragmentCode;
-	std::ifstream verShaderFile;
-	std::ifstream fragShaderFile;
+	readSource(vertexPath, vertexCode);
+	readSource(fragmentPath, fragmentCode);
+
+	// a warm start loads the linked program straight from the binary cache
+	ID = ProgramCache::load(vertexCode, fragmentCode);
+	bool compiled = ID == 0;
+	if (compiled) {
+		auto compileStart = std::chrono::steady_clock::now();
+		ID = compileProgram(vertexCode.c_str(), fragmentCode.c_str());
+		ProgramCache::recordCompile(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileStart).count());
+	}
+
+	// look every uniform location up once so the setters never query the driver
+	if (!buildUniformTable()) {
+		rejectProgram();
+	}
+	else if (compiled) {
+		ProgramCache::store(ID, vertexCode, fragmentCode);
+	}
+}
+
+// take over an already linked program, e.g. one built by the ShaderCompiler. getID() is 0 when it was rejected
+Shader::Shader(unsigned int programID) : ID(programID) {
+	if (!buildUniformTable()) {
+		rejectProgram();
+	}
+}
+
+// read a whole shader source file, returns false and logs if it can not be read
+bool Shader::readSource(const char* path, std::string& code) {
+	std::ifstream shaderFile;
 	// ifstream objects should be able to throw exceptions
-	verShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-	fragShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+	shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
 	try {
-		verShaderFile.open(vertexPath);
-		fragShaderFile.open(fragmentPath);
-		std::stringstream verShaderStream, fragShaderStream;
-		// read file's buffer contents into streams
-		verShaderStream << verShaderFile.rdbuf();
-		fragShaderStream << fragShaderFile.rdbuf();
-		// close file handlers
-		verShaderFile.close();
-		fragShaderFile.close();
-		// convert string stream into strings
-		vertexCode = verShaderStream.str();
-		fragmentCode = fragShaderStream.str();
+		shaderFile.open(path);
+		std::stringstream shaderStream;
+		// read file's buffer contents into the stream
+		shaderStream << shaderFile.rdbuf();
+		// close file handler
+		shaderFile.close();
+		// convert string stream into a string
+		code = shaderStream.str();
 	}
 	catch (std::ifstream::failure err) {
 		std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << err.what() << std::endl;
+		return false;
 	}
-	// convert c++ strings into c strings
-	const char* verShaderCode = vertexCode.c_str();
-	const char* fragShaderCode = fragmentCode.c_str();
+	return true;
+}
 
+// compile both stages from source and link them into a new program
+unsigned int Shader::compileProgram(const char* verShaderCode, const char* fragShaderCode) {
 	// now compile the shaders
 	unsigned int vertex, fragment;
 	int success;
@@ -59,19 +89,94 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) {
 	}
 
 	// create and link all the shaders into one shader program
-	ID = glCreateProgram();
-	glAttachShader(ID, vertex);
-	glAttachShader(ID, fragment);
-	glLinkProgram(ID);
+	unsigned int program = glCreateProgram();
+	glAttachShader(program, vertex);
+	glAttachShader(program, fragment);
+	ProgramCache::prepareForLink(program);
+	glLinkProgram(program);
 	// log any errors when linking the shader programs
-	glGetProgramiv(ID, GL_LINK_STATUS, &success);
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
 	if (!success) {
-		glGetProgramInfoLog(ID, 512, NULL, infoLog);
+		glGetProgramInfoLog(program, 512, NULL, infoLog);
 		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
 	}
 	// after linking all shaders, delete them as they are not needed anymore
 	glDeleteShader(vertex);
 	glDeleteShader(fragment);
+	return program;
+}
+
+// enumerate GL_ACTIVE_UNIFORMS into the uniform table
+bool Shader::buildUniformTable() {
+	uniformTable.clear();
+	uniformMask = 0;
+	if (ID == 0) {
+		return true;
+	}
+	int uniformCount = 0;
+	int maxNameLength = 0;
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+	// every name a setter may be called with: arrays are reported once as "name[0]" and are registered under their
+	// plain name and under every element, whose locations are not guaranteed to be consecutive
+	std::vector<std::pair<std::string, int>> uniforms;
+	std::vector<char> name(maxNameLength > 0 ? maxNameLength : 1);
+	for (int i = 0; i < uniformCount; i++) {
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(ID, (GLuint)i, (GLsizei)name.size(), &length, &size, &type, name.data());
+		int location = glGetUniformLocation(ID, name.data());
+		// uniform block members have no location
+		if (location < 0) {
+			continue;
+		}
+		std::string uniformName(name.data(), (size_t)length);
+		if (length > 3 && uniformName.compare(length - 3, 3, "[0]") == 0) {
+			std::string base = uniformName.substr(0, length - 3);
+			uniforms.emplace_back(base, location);
+			for (int element = 1; element < size; element++) {
+				std::string elementName = base + "[" + std::to_string(element) + "]";
+				uniforms.emplace_back(elementName, glGetUniformLocation(ID, elementName.c_str()));
+			}
+		}
+		uniforms.emplace_back(uniformName, location);
+	}
+
+	// keep the table at most half full so probing stays short
+	unsigned int capacity = 8;
+	while (capacity < (unsigned int)uniforms.size() * 2) {
+		capacity *= 2;
+	}
+	uniformTable.assign(capacity, UniformSlot{ 0, -1, false });
+	uniformMask = capacity - 1;
+
+	bool unique = true;
+	for (size_t i = 0; i < uniforms.size(); i++) {
+		UniformId uniform(uniforms[i].first.c_str(), uniforms[i].first.size());
+		unsigned int slot = uniform.hash & uniformMask;
+		while (uniformTable[slot].used && uniformTable[slot].hash != uniform.hash) {
+			slot = (slot + 1) & uniformMask;
+		}
+		// lookups only compare hashes, the second name could never be told apart from the first
+		if (uniformTable[slot].used) {
+			std::cout << "ERROR::SHADER::UNIFORM_HASH_COLLISION: " << uniforms[i].first << std::endl;
+			unique = false;
+			continue;
+		}
+		uniformTable[slot] = UniformSlot{ uniform.hash, uniforms[i].second, true };
+	}
+	return unique;
+}
+
+// a program whose uniform names collide is rejected as if it had failed to link, setters would write the wrong uniform
+void Shader::rejectProgram() {
+	std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\nuniform names with the same UniformId hash" << std::endl;
+	GLState::deleteProgram(ID);
+	ID = 0;
+	uniformTable.clear();
+	uniformMask = 0;
 }
 
 // get the ID of the shader program
@@ -81,19 +186,48 @@ unsigned int Shader::getID() const {
 
 // use/activate the shader
 void Shader::use() {
-	glUseProgram(ID);
+	GLState::useProgram(ID);
+}
+
+// get the location of a uniform, -1 if the program has no such active uniform
+int Shader::getUniformLocation(UniformId uniform) const {
+	if (uniformTable.empty()) {
+		return -1;
+	}
+	unsigned int slot = uniform.hash & uniformMask;
+	while (uniformTable[slot].used) {
+		if (uniformTable[slot].hash == uniform.hash) {
+			return uniformTable[slot].location;
+		}
+		slot = (slot + 1) & uniformMask;
+	}
+	return -1;
+}
+
+// swap in a newly built program (e.g. after a hot reload) and delete the old one
+void Shader::reload(const Shader& replacement) {
+	if (replacement.ID == ID) {
+		return;
+	}
+	if (ID != 0) {
+		GLState::deleteProgram(ID);
+	}
+	ID = replacement.ID;
+	uniformTable = replacement.uniformTable;
+	uniformMask = replacement.uniformMask;
 }
 
 // utility functions
-void Shader::setBool(const std::string& name, bool value) const {
-	glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+// a location of -1 is silently ignored by glUniform, same as for unknown names before
+void Shader::setBool(UniformId uniform, bool value) const {
+	glUniform1i(getUniformLocation(uniform), (int)value);
 }
 
-void Shader::setInt(const std::string& name, int value) const {
-	glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+void Shader::setInt(UniformId uniform, int value) const {
+	glUniform1i(getUniformLocation(uniform), value);
 }
 
-void Shader::setFloat(const std::string& name, float value) const {
-	glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+void Shader::setFloat(UniformId uniform, float value) const {
+	glUniform1f(getUniformLocation(uniform), value);
 }
 
@@ -5,36 +5,68 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
 
 #include <glad/glad.h>
 
+#include "UniformId.h"
+
 class Shader {
 private:
 	// the shader program
 	unsigned int ID;
 
+	// open addressed table from uniform name hash to location, filled once after linking
+	struct UniformSlot {
+		unsigned int hash;
+		int location;
+		bool used;
+	};
+	std::vector<UniformSlot> uniformTable;
+	unsigned int uniformMask;
+
+	// enumerate GL_ACTIVE_UNIFORMS into the uniform table, false if two names hash to the same UniformId
+	bool buildUniformTable();
+	// deletes a program buildUniformTable() refused, the shader is left empty
+	void rejectProgram();
+
 public:
 
 	// constructor
 	Shader(const char* vertexPath, const char* fragmentPath);
 
+	// take over an already linked program, e.g. one built by the ShaderCompiler
+	explicit Shader(unsigned int programID);
+
 	// destructor
 	~Shader() = default;
 
 	// use/activate the shader
 	void use();
 
+	// swap in a newly built program (e.g. after a hot reload) and delete the old one
+	void reload(const Shader& replacement);
+
 	// utility functions
 
+	// read a whole shader source file, returns false and logs if it can not be read
+	static bool readSource(const char* path, std::string& code);
+
+	// compile both stages from source and link them into a new program
+	static unsigned int compileProgram(const char* verShaderCode, const char* fragShaderCode);
+
 	// getters
 	
 	// get the ID of the shader program
 	unsigned int getID() const;
 
+	// get the location of a uniform, -1 if the program has no such active uniform
+	int getUniformLocation(UniformId uniform) const;
+
 	// setters
-	void setBool(const std::string& name, bool value) const;
-	void setInt(const std::string& name, int value) const;
-	void setFloat(const std::string& name, float value) const;
+	void setBool(UniformId uniform, bool value) const;
+	void setInt(UniformId uniform, int value) const;
+	void setFloat(UniformId uniform, float value) const;
 };
 
 #endif // SHADER_H
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include <iostream>
+
+#include "ShaderCompiler.h"
+#include "ProgramCache.h"
+#include "../Utility/GLExtensions.h"
+
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+// constructor, asks the driver for as many compiler threads as it wants to use
+ShaderCompiler::ShaderCompiler() : parallel(false) {
+	const char* entryPoint = NULL;
+	if (GLExtensions::has("GL_KHR_parallel_shader_compile")) {
+		entryPoint = "glMaxShaderCompilerThreadsKHR";
+	}
+	else if (GLExtensions::has("GL_ARB_parallel_shader_compile")) {
+		entryPoint = "glMaxShaderCompilerThreadsARB";
+	}
+	if (entryPoint) {
+		PFNGLMAXSHADERCOMPILERTHREADSKHRPROC maxShaderCompilerThreads =
+			(PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)GLExtensions::getProcAddress(entryPoint);
+		if (maxShaderCompilerThreads) {
+			// 0xFFFFFFFF lets the implementation pick the number of threads
+			maxShaderCompilerThreads(0xFFFFFFFFu);
+		}
+		parallel = true;
+	}
+}
+
+// destructor, deletes programs that never finished
+ShaderCompiler::~ShaderCompiler() {
+	for (PendingProgram& request : pending) {
+		glDeleteShader(request.vertex);
+		glDeleteShader(request.fragment);
+		glDeleteProgram(request.program);
+	}
+}
+
+// queue a program built from two source files, returns false if a file can not be read
+bool ShaderCompiler::submit(const char* vertexPath, const char* fragmentPath, ReadyCallback onReady,
+	FailedCallback onFailed) {
+	std::string vertexCode;
+	std::string fragmentCode;
+	if (!Shader::readSource(vertexPath, vertexCode) || !Shader::readSource(fragmentPath, fragmentCode)) {
+		if (onFailed) {
+			onFailed();
+		}
+		return false;
+	}
+	submitSource(vertexCode, fragmentCode, onReady, onFailed);
+	return true;
+}
+
+// queue a program built from sources already in memory
+void ShaderCompiler::submitSource(const std::string& vertexCode, const std::string& fragmentCode, ReadyCallback onReady,
+	FailedCallback onFailed) {
+	if (pending.empty()) {
+		firstSubmit = std::chrono::steady_clock::now();
+	}
+	statistics.submitted++;
+
+	PendingProgram request;
+	request.vertexCode = vertexCode;
+	request.fragmentCode = fragmentCode;
+	request.vertex = 0;
+	request.fragment = 0;
+	request.onReady = onReady;
+	request.onFailed = onFailed;
+	request.submitTime = std::chrono::steady_clock::now();
+
+	// a cached binary is ready on the next poll, nothing to compile
+	request.program = ProgramCache::load(vertexCode, fragmentCode);
+	request.fromCache = request.program != 0;
+	if (!request.fromCache) {
+		const char* verShaderCode = request.vertexCode.c_str();
+		const char* fragShaderCode = request.fragmentCode.c_str();
+
+		// hand everything to the driver without asking for any status,
+		// any query here would force the compile to finish on this thread
+		request.vertex = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(request.vertex, 1, &verShaderCode, NULL);
+		glCompileShader(request.vertex);
+
+		request.fragment = glCreateShader(GL_FRAGMENT_SHADER);
+		glShaderSource(request.fragment, 1, &fragShaderCode, NULL);
+		glCompileShader(request.fragment);
+
+		request.program = glCreateProgram();
+		glAttachShader(request.program, request.vertex);
+		glAttachShader(request.program, request.fragment);
+		ProgramCache::prepareForLink(request.program);
+		glLinkProgram(request.program);
+	}
+	pending.push_back(request);
+}
+
+// check the compile and link logs, returns false if the program is unusable
+bool ShaderCompiler::checkProgram(const PendingProgram& request) {
+	int success;
+	char infoLog[512];
+	if (!request.fromCache) {
+		glGetShaderiv(request.vertex, GL_COMPILE_STATUS, &success);
+		if (!success) {
+			glGetShaderInfoLog(request.vertex, 512, NULL, infoLog);
+			std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED" << infoLog << std::endl;
+		}
+		glGetShaderiv(request.fragment, GL_COMPILE_STATUS, &success);
+		if (!success) {
+			glGetShaderInfoLog(request.fragment, 512, NULL, infoLog);
+			std::cout << "ERROR::SHADER:FRAGMENT:COMPILATION_FAILED" << infoLog << std::endl;
+		}
+	}
+	glGetProgramiv(request.program, GL_LINK_STATUS, &success);
+	if (!success) {
+		glGetProgramInfoLog(request.program, 512, NULL, infoLog);
+		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// finish every program the driver is done with, call once per frame
+void ShaderCompiler::poll() {
+	// collect the finished programs first, callbacks may submit new ones
+	std::vector<PendingProgram> finished;
+	for (size_t i = 0; i < pending.size();) {
+		int completed = GL_TRUE;
+		if (parallel && !pending[i].fromCache) {
+			glGetProgramiv(pending[i].program, GL_COMPLETION_STATUS_KHR, &completed);
+		}
+		if (completed) {
+			finished.push_back(pending[i]);
+			pending.erase(pending.begin() + i);
+		}
+		else {
+			i++;
+		}
+	}
+
+	for (PendingProgram& request : finished) {
+		bool success = checkProgram(request);
+		if (!request.fromCache) {
+			// the shaders are not needed anymore once the program is linked
+			glDeleteShader(request.vertex);
+			glDeleteShader(request.fragment);
+		}
+		if (!success) {
+			glDeleteProgram(request.program);
+		}
+		// the shader deletes a program whose uniform names collide
+		Shader shader(success ? request.program : 0u);
+		if (shader.getID() == 0) {
+			statistics.failed++;
+			if (request.onFailed) {
+				request.onFailed();
+			}
+			continue;
+		}
+		if (request.fromCache) {
+			statistics.cached++;
+		}
+		else {
+			ProgramCache::recordCompile(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - request.submitTime).count());
+			ProgramCache::store(request.program, request.vertexCode, request.fragmentCode);
+		}
+		statistics.completed++;
+		statistics.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - firstSubmit).count();
+		if (request.onReady) {
+			request.onReady(shader);
+		}
+	}
+}
+
+// block until every submitted program is finished
+void ShaderCompiler::finishAll() {
+	bool wasParallel = parallel;
+	// without the completion query the status checks simply wait for the driver
+	parallel = false;
+	while (!pending.empty()) {
+		poll();
+	}
+	parallel = wasParallel;
+}
+
+bool ShaderCompiler::isIdle() const {
+	return pending.empty();
+}
+
+bool ShaderCompiler::isParallel() const {
+	return parallel;
+}
+
+const ShaderCompiler::Statistics& ShaderCompiler::getStatistics() const {
+	return statistics;
+}
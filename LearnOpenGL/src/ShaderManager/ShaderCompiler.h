@@ -0,0 +1,95 @@
+#ifndef SHADER_COMPILER_H
+#define SHADER_COMPILER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+
+#include <glad/glad.h>
+
+#include "Shader.h"
+
+// KHR_parallel_shader_compile / ARB_parallel_shader_compile, not part of the generated glad
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// builds shader programs without blocking the render loop.
+// submit() only hands the sources to the driver, poll() checks GL_COMPLETION_STATUS_KHR once
+// per frame and fires the ready callback of every program the driver finished compiling.
+// without the extension poll() still works, it just waits for each program in turn
+class ShaderCompiler {
+public:
+	// called with the linked program, not called when compiling or linking failed
+	typedef std::function<void(const Shader& shader)> ReadyCallback;
+	// called instead when the program could not be built, the errors are already logged
+	typedef std::function<void()> FailedCallback;
+
+	struct Statistics {
+		unsigned int submitted = 0;
+		unsigned int completed = 0;
+		unsigned int failed = 0;
+		// programs that came straight from the program binary cache
+		unsigned int cached = 0;
+		// time from the first submit until the last program became ready
+		double milliseconds = 0.0;
+	};
+
+private:
+	// a program the driver is still working on
+	struct PendingProgram {
+		std::string vertexCode;
+		std::string fragmentCode;
+		unsigned int vertex;
+		unsigned int fragment;
+		unsigned int program;
+		bool fromCache;
+		std::chrono::steady_clock::time_point submitTime;
+		ReadyCallback onReady;
+		FailedCallback onFailed;
+	};
+
+	std::vector<PendingProgram> pending;
+	Statistics statistics;
+	std::chrono::steady_clock::time_point firstSubmit;
+	bool parallel;
+
+	// check the compile and link logs, returns false if the program is unusable
+	static bool checkProgram(const PendingProgram& request);
+
+public:
+
+	// constructor, asks the driver for as many compiler threads as it wants to use
+	ShaderCompiler();
+
+	// destructor, deletes programs that never finished
+	~ShaderCompiler();
+
+	ShaderCompiler(const ShaderCompiler&) = delete;
+	ShaderCompiler& operator=(const ShaderCompiler&) = delete;
+
+	// queue a program built from two source files, returns false if a file can not be read
+	bool submit(const char* vertexPath, const char* fragmentPath, ReadyCallback onReady,
+		FailedCallback onFailed = FailedCallback());
+
+	// queue a program built from sources already in memory
+	void submitSource(const std::string& vertexCode, const std::string& fragmentCode, ReadyCallback onReady,
+		FailedCallback onFailed = FailedCallback());
+
+	// finish every program the driver is done with, call once per frame
+	void poll();
+
+	// block until every submitted program is finished
+	void finishAll();
+
+	// getters
+	bool isIdle() const;
+	bool isParallel() const;
+	const Statistics& getStatistics() const;
+};
+
+#endif // SHADER_COMPILER_H
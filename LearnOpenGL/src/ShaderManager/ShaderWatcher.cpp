@@ -0,0 +1,141 @@
+#include <iostream>
+#include <algorithm>
+
+#include "ShaderWatcher.h"
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+// only the file name is compared, inotify reports names relative to the watched directory
+static std::string fileName(const std::string& path) {
+	return std::filesystem::path(path).filename().string();
+}
+
+// constructor, starts watching the directory
+ShaderWatcher::ShaderWatcher(ShaderCompiler& compiler, const char* directory)
+	: compiler(compiler), directory(directory) {
+#if defined(__linux__)
+	watchDescriptor = -1;
+	inotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (inotifyFD < 0) {
+		std::cout << "ERROR::SHADER_WATCHER::INOTIFY_INIT_FAILED" << std::endl;
+		return;
+	}
+	// editors either rewrite the file in place or rename a temporary file over it
+	watchDescriptor = inotify_add_watch(inotifyFD, directory, IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (watchDescriptor < 0) {
+		std::cout << "ERROR::SHADER_WATCHER::FAILED_TO_WATCH " << directory << std::endl;
+	}
+#else
+	lastScan = std::chrono::steady_clock::now();
+#endif
+}
+
+// destructor
+ShaderWatcher::~ShaderWatcher() {
+#if defined(__linux__)
+	if (inotifyFD >= 0) {
+		close(inotifyFD);
+	}
+#endif
+}
+
+// rebuild the program whenever one of its two source files changes
+void ShaderWatcher::watch(const char* vertexPath, const char* fragmentPath, ShaderCompiler::ReadyCallback onReloaded) {
+	std::shared_ptr<WatchedProgram> program = std::make_shared<WatchedProgram>();
+	program->vertexPath = vertexPath;
+	program->fragmentPath = fragmentPath;
+	program->onReloaded = onReloaded;
+	programs.push_back(program);
+#if !defined(__linux__)
+	std::error_code error;
+	for (const std::string& path : { program->vertexPath, program->fragmentPath }) {
+		writeTimes.push_back(std::make_pair(path, std::filesystem::last_write_time(path, error)));
+	}
+#endif
+}
+
+// file names (without directory) that changed since the last poll
+void ShaderWatcher::collectChanges(std::vector<std::string>& changedFiles) {
+#if defined(__linux__)
+	if (inotifyFD < 0) {
+		return;
+	}
+	alignas(inotify_event) char buffer[4096];
+	while (true) {
+		ssize_t length = read(inotifyFD, buffer, sizeof(buffer));
+		// EAGAIN means the queue is drained, the descriptor never blocks
+		if (length <= 0) {
+			break;
+		}
+		for (char* cursor = buffer; cursor < buffer + length;) {
+			const inotify_event* event = (const inotify_event*)cursor;
+			if (event->len > 0) {
+				changedFiles.push_back(event->name);
+			}
+			cursor += sizeof(inotify_event) + event->len;
+		}
+	}
+#else
+	// stat()ing every frame is wasteful, a few times per second is plenty for editing
+	auto now = std::chrono::steady_clock::now();
+	if (now - lastScan < std::chrono::milliseconds(250)) {
+		return;
+	}
+	lastScan = now;
+	std::error_code error;
+	for (auto& entry : writeTimes) {
+		std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(entry.first, error);
+		if (!error && writeTime != entry.second) {
+			entry.second = writeTime;
+			changedFiles.push_back(fileName(entry.first));
+		}
+	}
+#endif
+}
+
+void ShaderWatcher::rebuild(const std::shared_ptr<WatchedProgram>& program) {
+	if (program->reloading) {
+		// pick the newest sources up once the current rebuild is done
+		program->changedAgain = true;
+		return;
+	}
+	program->reloading = true;
+	program->changedAgain = false;
+	std::cout << "Reloading shader program " << program->vertexPath << " + " << program->fragmentPath << std::endl;
+
+	std::shared_ptr<WatchedProgram> watched = program;
+	auto finished = [this, watched]() {
+		watched->reloading = false;
+		if (watched->changedAgain) {
+			rebuild(watched);
+		}
+	};
+	compiler.submit(watched->vertexPath.c_str(), watched->fragmentPath.c_str(),
+		[watched, finished](const Shader& shader) {
+			watched->onReloaded(shader);
+			finished();
+		},
+		// the old program stays in use, the errors are already logged
+		finished);
+}
+
+// check for changed files and submit rebuilds, call once per frame before ShaderCompiler::poll
+void ShaderWatcher::poll() {
+	std::vector<std::string> changedFiles;
+	collectChanges(changedFiles);
+	if (changedFiles.empty()) {
+		return;
+	}
+	for (const std::shared_ptr<WatchedProgram>& program : programs) {
+		bool changed = std::find_if(changedFiles.begin(), changedFiles.end(), [&](const std::string& name) {
+			return name == fileName(program->vertexPath) || name == fileName(program->fragmentPath);
+		}) != changedFiles.end();
+		if (changed) {
+			rebuild(program);
+		}
+	}
+}
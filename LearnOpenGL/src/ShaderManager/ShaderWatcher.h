@@ -0,0 +1,65 @@
+#ifndef SHADER_WATCHER_H
+#define SHADER_WATCHER_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+
+#include "ShaderCompiler.h"
+
+// watches the shader directory and rebuilds the programs whose sources changed.
+// rebuilds go through the ShaderCompiler, so with parallel compile support the render loop
+// never waits for them; the reload callback runs from poll() between frames and a failed
+// compile simply leaves the old program in use.
+// uses inotify on Linux and polls the file modification times everywhere else
+class ShaderWatcher {
+private:
+	struct WatchedProgram {
+		std::string vertexPath;
+		std::string fragmentPath;
+		ShaderCompiler::ReadyCallback onReloaded;
+		// a rebuild is in flight
+		bool reloading = false;
+		// the sources changed again while the rebuild was in flight
+		bool changedAgain = false;
+	};
+
+	ShaderCompiler& compiler;
+	std::string directory;
+	// shared with the compiler callbacks, which can outlive a move of the vector
+	std::vector<std::shared_ptr<WatchedProgram>> programs;
+
+#if defined(__linux__)
+	int inotifyFD;
+	int watchDescriptor;
+#else
+	// modification times of every watched file, checked a few times per second
+	std::vector<std::pair<std::string, std::filesystem::file_time_type>> writeTimes;
+	std::chrono::steady_clock::time_point lastScan;
+#endif
+
+	// file names (without directory) that changed since the last poll
+	void collectChanges(std::vector<std::string>& changedFiles);
+	void rebuild(const std::shared_ptr<WatchedProgram>& program);
+
+public:
+
+	// constructor, starts watching the directory
+	ShaderWatcher(ShaderCompiler& compiler, const char* directory);
+
+	// destructor
+	~ShaderWatcher();
+
+	ShaderWatcher(const ShaderWatcher&) = delete;
+	ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+	// rebuild the program whenever one of its two source files changes
+	void watch(const char* vertexPath, const char* fragmentPath, ShaderCompiler::ReadyCallback onReloaded);
+
+	// check for changed files and submit rebuilds, call once per frame before ShaderCompiler::poll
+	void poll();
+};
+
+#endif // SHADER_WATCHER_H
@@ -0,0 +1,41 @@
+#ifndef UNIFORM_ID_H
+#define UNIFORM_ID_H
+
+#include <cstddef>
+
+// 32-bit FNV-1a hash of a uniform name, usable at compile time
+constexpr unsigned int hashUniformName(const char* name, size_t length) {
+	unsigned int hash = 2166136261u;
+	for (size_t i = 0; i < length; i++) {
+		hash ^= (unsigned char)name[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+constexpr size_t uniformNameLength(const char* name) {
+	size_t length = 0;
+	while (name[length] != '\0') {
+		length++;
+	}
+	return length;
+}
+
+// identifies a uniform by the hash of its name, so setters never build strings or ask the driver.
+// declare them constexpr to hash at compile time:
+//     constexpr UniformId textureDiff("textureDiff");
+struct UniformId {
+	unsigned int hash;
+	const char* name;
+
+	constexpr UniformId() : hash(hashUniformName("", 0)), name("") {}
+	constexpr UniformId(const char* name) : hash(hashUniformName(name, uniformNameLength(name))), name(name) {}
+	constexpr UniformId(const char* name, size_t length) : hash(hashUniformName(name, length)), name(name) {}
+};
+
+// "textureDiff"_uniform
+constexpr UniformId operator"" _uniform(const char* name, size_t length) {
+	return UniformId(name, length);
+}
+
+#endif // UNIFORM_ID_H
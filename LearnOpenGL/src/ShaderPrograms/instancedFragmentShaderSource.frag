@@ -0,0 +1,15 @@
+#version 330 core
+
+out vec4 FragColor;
+
+in vec3 ourColor;
+in vec2 texCoord;
+flat in float textureLayer;
+
+// every image the instances use, each instance picks its own by layer and rectangle instead of a bind
+uniform sampler2DArray atlas;
+uniform float textureDiff = 0.2f;
+
+void main() {
+	FragColor = mix(vec4(ourColor, 0), texture(atlas, vec3(texCoord, textureLayer)), textureDiff);
+}
@@ -0,0 +1,23 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+layout (location = 2) in vec2 aTexCoord;
+// per instance attributes
+layout (location = 3) in vec2 aOffset;
+layout (location = 4) in float aScale;
+layout (location = 5) in float aLayer;
+layout (location = 6) in vec4 aTint;
+// offset and scale of the image inside its atlas layer
+layout (location = 7) in vec4 aTexRect;
+
+out vec3 ourColor;
+out vec2 texCoord;
+flat out float textureLayer;
+
+void main() {
+	gl_Position = vec4(aPos.x * aScale + aOffset.x, aPos.y * aScale + aOffset.y, aPos.z, 1.0);
+	ourColor = aColor * aTint.rgb;
+	// images are stored bottom row first like OpenGL expects, the rectangle picks the image out of its layer
+	texCoord = aTexRect.xy + aTexCoord * aTexRect.zw;
+	textureLayer = aLayer;
+}
@@ -0,0 +1,118 @@
+#include "BlockDecoder.h"
+
+namespace BlockDecoder {
+
+	static unsigned int readShort(const unsigned char* bytes) {
+		return bytes[0] | (bytes[1] << 8);
+	}
+
+	static unsigned int readInt(const unsigned char* bytes) {
+		return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+	}
+
+	// 5:6:5 expanded to 8 bits by replicating the top bits, like the hardware does
+	static void unpack565(unsigned int color, unsigned char* rgb) {
+		unsigned int r = (color >> 11) & 31;
+		unsigned int g = (color >> 5) & 63;
+		unsigned int b = color & 31;
+		rgb[0] = (unsigned char)((r << 3) | (r >> 2));
+		rgb[1] = (unsigned char)((g << 2) | (g >> 4));
+		rgb[2] = (unsigned char)((b << 3) | (b >> 2));
+	}
+
+	// the colour half shared by BC1, BC2 and BC3. the latter two always use four colours
+	static void decodeColor(const unsigned char* block, unsigned char* out, size_t pitch, bool allowThreeColor, bool alpha) {
+		unsigned int color0 = readShort(block);
+		unsigned int color1 = readShort(block + 2);
+		unsigned char palette[4][4];
+		unpack565(color0, palette[0]);
+		unpack565(color1, palette[1]);
+		palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+		if (color0 > color1 || !allowThreeColor) {
+			for (int c = 0; c < 3; c++) {
+				palette[2][c] = (unsigned char)((2 * palette[0][c] + palette[1][c] + 1) / 3);
+				palette[3][c] = (unsigned char)((palette[0][c] + 2 * palette[1][c] + 1) / 3);
+			}
+		}
+		else {
+			for (int c = 0; c < 3; c++) {
+				palette[2][c] = (unsigned char)((palette[0][c] + palette[1][c] + 1) / 2);
+				palette[3][c] = 0;
+			}
+			palette[3][3] = alpha ? 0 : 255;
+		}
+		unsigned int indices = readInt(block + 4);
+		for (int y = 0; y < 4; y++) {
+			unsigned char* row = out + y * pitch;
+			for (int x = 0; x < 4; x++) {
+				const unsigned char* color = palette[(indices >> (2 * (y * 4 + x))) & 3];
+				row[x * 4 + 0] = color[0];
+				row[x * 4 + 1] = color[1];
+				row[x * 4 + 2] = color[2];
+				row[x * 4 + 3] = color[3];
+			}
+		}
+	}
+
+	// two 8 bit endpoints and 16 3 bit indices, used for BC3 alpha and both BC4/BC5 channels
+	static void decodeChannel(const unsigned char* block, unsigned char* out, size_t pitch, size_t channelStride) {
+		unsigned int value0 = block[0];
+		unsigned int value1 = block[1];
+		unsigned char palette[8];
+		palette[0] = (unsigned char)value0;
+		palette[1] = (unsigned char)value1;
+		if (value0 > value1) {
+			for (int i = 1; i < 7; i++) {
+				palette[i + 1] = (unsigned char)(((7 - i) * value0 + i * value1 + 3) / 7);
+			}
+		}
+		else {
+			for (int i = 1; i < 5; i++) {
+				palette[i + 1] = (unsigned char)(((5 - i) * value0 + i * value1 + 2) / 5);
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+		// 48 bits of indices
+		unsigned long long indices = 0;
+		for (int i = 0; i < 6; i++) {
+			indices |= (unsigned long long)block[2 + i] << (8 * i);
+		}
+		for (int y = 0; y < 4; y++) {
+			unsigned char* row = out + y * pitch;
+			for (int x = 0; x < 4; x++) {
+				row[x * channelStride] = palette[(indices >> (3 * (y * 4 + x))) & 7];
+			}
+		}
+	}
+
+	void decodeBC1(const unsigned char* block, unsigned char* out, size_t pitch, bool alpha) {
+		decodeColor(block, out, pitch, true, alpha);
+	}
+
+	void decodeBC2(const unsigned char* block, unsigned char* out, size_t pitch) {
+		decodeColor(block + 8, out, pitch, false, false);
+		// explicit 4 bit alpha per texel
+		for (int y = 0; y < 4; y++) {
+			unsigned int alphaRow = readShort(block + y * 2);
+			for (int x = 0; x < 4; x++) {
+				unsigned int alpha = (alphaRow >> (4 * x)) & 15;
+				out[y * pitch + x * 4 + 3] = (unsigned char)(alpha * 17);
+			}
+		}
+	}
+
+	void decodeBC3(const unsigned char* block, unsigned char* out, size_t pitch) {
+		decodeColor(block + 8, out, pitch, false, false);
+		decodeChannel(block, out + 3, pitch, 4);
+	}
+
+	void decodeBC4(const unsigned char* block, unsigned char* out, size_t pitch, size_t channelStride) {
+		decodeChannel(block, out, pitch, channelStride);
+	}
+
+	void decodeBC5(const unsigned char* block, unsigned char* out, size_t pitch) {
+		decodeChannel(block, out, pitch, 2);
+		decodeChannel(block + 8, out + 1, pitch, 2);
+	}
+}
@@ -0,0 +1,23 @@
+#ifndef BLOCK_DECODER_H
+#define BLOCK_DECODER_H
+
+#include <cstddef>
+
+// CPU decompression of the BCn formats that are not core in desktop GL (BC1-BC3 need EXT_texture_compression_s3tc)
+// plus BC4/BC5, used when the driver can not sample them directly. blocks are 4x4 texels, 8 bytes for BC1 and BC4,
+// 16 for the others
+namespace BlockDecoder {
+
+	// 4x4 RGBA8 texels written row by row to out, pitch is the byte distance between rows of out.
+	// alpha selects the BC1 variant where colour index 3 in three colour blocks is transparent black
+	void decodeBC1(const unsigned char* block, unsigned char* out, size_t pitch, bool alpha);
+	void decodeBC2(const unsigned char* block, unsigned char* out, size_t pitch);
+	void decodeBC3(const unsigned char* block, unsigned char* out, size_t pitch);
+	// one channel, channelStride bytes apart in out (1 for R8, 2 or 4 to fill a channel of RG8 or RGBA8)
+	void decodeBC4(const unsigned char* block, unsigned char* out, size_t pitch, size_t channelStride);
+	// two channels, R and G
+	void decodeBC5(const unsigned char* block, unsigned char* out, size_t pitch);
+
+}
+
+#endif // BLOCK_DECODER_H
@@ -0,0 +1,420 @@
+#include <cmath>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+
+#include "BlockEncoder.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLOCK_ENCODER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace BlockEncoder {
+
+	// share of endpoint 0 in each of the four BC1 palette entries
+	static const float COLOR_WEIGHTS[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+	static void writeShort(unsigned char* bytes, unsigned int value) {
+		bytes[0] = (unsigned char)value;
+		bytes[1] = (unsigned char)(value >> 8);
+	}
+
+	// rounded to the nearest representable value
+	static unsigned int pack565(const int* rgb) {
+		return ((rgb[0] * 31 + 127) / 255) << 11 | ((rgb[1] * 63 + 127) / 255) << 5 | ((rgb[2] * 31 + 127) / 255);
+	}
+
+	// the four colours the decoder derives from the endpoints (see BlockDecoder), packed as RGBA8 with alpha left
+	// at 0 so it drops out of the distances
+	static void makePalette(unsigned int color0, unsigned int color1, unsigned int* palette) {
+		int endpoints[2][3];
+		const unsigned int colors[2] = { color0, color1 };
+		for (int e = 0; e < 2; e++) {
+			unsigned int r = (colors[e] >> 11) & 31;
+			unsigned int g = (colors[e] >> 5) & 63;
+			unsigned int b = colors[e] & 31;
+			endpoints[e][0] = (int)((r << 3) | (r >> 2));
+			endpoints[e][1] = (int)((g << 2) | (g >> 4));
+			endpoints[e][2] = (int)((b << 3) | (b >> 2));
+		}
+		for (int k = 0; k < 4; k++) {
+			palette[k] = 0;
+		}
+		for (int c = 0; c < 3; c++) {
+			int values[4] = {
+				endpoints[0][c],
+				endpoints[1][c],
+				(2 * endpoints[0][c] + endpoints[1][c] + 1) / 3,
+				(endpoints[0][c] + 2 * endpoints[1][c] + 1) / 3
+			};
+			for (int k = 0; k < 4; k++) {
+				palette[k] |= (unsigned int)values[k] << (8 * c);
+			}
+		}
+	}
+
+	// nearest palette entry of every texel by squared RGB distance, the first one wins ties. returns the summed error
+	static int selectColorIndicesScalar(const unsigned char* texels, const unsigned int* palette, unsigned char* indices) {
+		int error = 0;
+		for (int i = 0; i < 16; i++) {
+			const unsigned char* texel = texels + i * 4;
+			int bestDistance = INT_MAX;
+			for (int k = 0; k < 4; k++) {
+				int dr = texel[0] - (int)(palette[k] & 255);
+				int dg = texel[1] - (int)((palette[k] >> 8) & 255);
+				int db = texel[2] - (int)((palette[k] >> 16) & 255);
+				int distance = dr * dr + dg * dg + db * db;
+				if (distance < bestDistance) {
+					bestDistance = distance;
+					indices[i] = (unsigned char)k;
+				}
+			}
+			error += bestDistance;
+		}
+		return error;
+	}
+
+#ifdef BLOCK_ENCODER_SSE2
+
+	// a row of four texels against each palette entry at once, same distances and tie breaking as the scalar version
+	static int selectColorIndicesSSE2(const unsigned char* texels, const unsigned int* palette, unsigned char* indices) {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i rgbMask = _mm_set1_epi32(0x00ffffff);
+		__m128i colors[4];
+		for (int k = 0; k < 4; k++) {
+			colors[k] = _mm_set1_epi32((int)palette[k]);
+		}
+		__m128i errors = zero;
+		for (int row = 0; row < 4; row++) {
+			__m128i texelRow = _mm_and_si128(_mm_load_si128((const __m128i*)(texels + row * 16)), rgbMask);
+			__m128i best = zero;
+			__m128i bestIndex = zero;
+			for (int k = 0; k < 4; k++) {
+				__m128i difference = _mm_or_si128(_mm_subs_epu8(texelRow, colors[k]), _mm_subs_epu8(colors[k], texelRow));
+				__m128i low = _mm_unpacklo_epi8(difference, zero);
+				__m128i high = _mm_unpackhi_epi8(difference, zero);
+				// r*r + g*g and b*b per texel, then the two halves of each texel added up
+				low = _mm_madd_epi16(low, low);
+				high = _mm_madd_epi16(high, high);
+				low = _mm_add_epi32(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(2, 3, 0, 1)));
+				high = _mm_add_epi32(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(2, 3, 0, 1)));
+				__m128i distance = _mm_unpacklo_epi64(_mm_shuffle_epi32(low, _MM_SHUFFLE(3, 1, 2, 0)),
+					_mm_shuffle_epi32(high, _MM_SHUFFLE(3, 1, 2, 0)));
+				if (k == 0) {
+					best = distance;
+					continue;
+				}
+				__m128i closer = _mm_cmplt_epi32(distance, best);
+				best = _mm_or_si128(_mm_and_si128(closer, distance), _mm_andnot_si128(closer, best));
+				bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(k)), _mm_andnot_si128(closer, bestIndex));
+			}
+			errors = _mm_add_epi32(errors, best);
+			int packed = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(bestIndex, zero), zero));
+			memcpy(indices + row * 4, &packed, 4);
+		}
+		errors = _mm_add_epi32(errors, _mm_shuffle_epi32(errors, _MM_SHUFFLE(2, 3, 0, 1)));
+		errors = _mm_add_epi32(errors, _mm_shuffle_epi32(errors, _MM_SHUFFLE(1, 0, 3, 2)));
+		return _mm_cvtsi128_si32(errors);
+	}
+
+	static void findColorRangeSSE2(const unsigned char* texels, int* minimum, int* maximum) {
+		__m128i low = _mm_load_si128((const __m128i*)texels);
+		__m128i high = low;
+		for (int row = 1; row < 4; row++) {
+			__m128i texelRow = _mm_load_si128((const __m128i*)(texels + row * 16));
+			low = _mm_min_epu8(low, texelRow);
+			high = _mm_max_epu8(high, texelRow);
+		}
+		low = _mm_min_epu8(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(2, 3, 0, 1)));
+		low = _mm_min_epu8(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(1, 0, 3, 2)));
+		high = _mm_max_epu8(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(2, 3, 0, 1)));
+		high = _mm_max_epu8(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(1, 0, 3, 2)));
+		unsigned int packedLow = (unsigned int)_mm_cvtsi128_si32(low);
+		unsigned int packedHigh = (unsigned int)_mm_cvtsi128_si32(high);
+		for (int c = 0; c < 3; c++) {
+			minimum[c] = (int)((packedLow >> (8 * c)) & 255);
+			maximum[c] = (int)((packedHigh >> (8 * c)) & 255);
+		}
+	}
+
+	// all 16 values in one register, compared against each of the 8 palette entries
+	static void selectChannelIndicesSSE2(const unsigned char* values, const unsigned char* palette, unsigned char* indices) {
+		__m128i texels = _mm_load_si128((const __m128i*)values);
+		__m128i best = _mm_setzero_si128();
+		__m128i bestIndex = _mm_setzero_si128();
+		for (int k = 0; k < 8; k++) {
+			__m128i entry = _mm_set1_epi8((char)palette[k]);
+			__m128i difference = _mm_or_si128(_mm_subs_epu8(texels, entry), _mm_subs_epu8(entry, texels));
+			if (k == 0) {
+				best = difference;
+				continue;
+			}
+			// strictly closer, difference < best without a signed compare
+			__m128i closer = _mm_andnot_si128(_mm_cmpeq_epi8(difference, best), _mm_cmpeq_epi8(_mm_min_epu8(difference, best), difference));
+			best = _mm_min_epu8(best, difference);
+			bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi8((char)k)), _mm_andnot_si128(closer, bestIndex));
+		}
+		_mm_storeu_si128((__m128i*)indices, bestIndex);
+	}
+
+#endif
+
+	bool isSimd() {
+#ifdef BLOCK_ENCODER_SSE2
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	static int selectColorIndices(const unsigned char* texels, const unsigned int* palette, unsigned char* indices, bool simd) {
+#ifdef BLOCK_ENCODER_SSE2
+		if (simd) {
+			return selectColorIndicesSSE2(texels, palette, indices);
+		}
+#endif
+		return selectColorIndicesScalar(texels, palette, indices);
+	}
+
+	// endpoints ordered for four colour mode, their palette indices and the error they leave
+	struct ColorFit {
+		unsigned int color0;
+		unsigned int color1;
+		unsigned char indices[16];
+		int error;
+	};
+
+	static void fitColors(const unsigned char* texels, const int* endpoint0, const int* endpoint1, ColorFit& fit, bool simd) {
+		fit.color0 = pack565(endpoint0);
+		fit.color1 = pack565(endpoint1);
+		// color0 > color1 selects four colours. equal endpoints give an all equal palette and every index 0
+		if (fit.color0 < fit.color1) {
+			std::swap(fit.color0, fit.color1);
+		}
+		unsigned int palette[4];
+		makePalette(fit.color0, fit.color1, palette);
+		fit.error = selectColorIndices(texels, palette, fit.indices, simd);
+	}
+
+	// least squares endpoints for the indices of a fit, false if they all pick the same endpoint weight
+	static bool refineEndpoints(const unsigned char* texels, const ColorFit& fit, int* endpoint0, int* endpoint1) {
+		float alpha2 = 0.0f, beta2 = 0.0f, alphaBeta = 0.0f;
+		float alphaX[3] = { 0.0f, 0.0f, 0.0f };
+		float betaX[3] = { 0.0f, 0.0f, 0.0f };
+		for (int i = 0; i < 16; i++) {
+			float alpha = COLOR_WEIGHTS[fit.indices[i]];
+			float beta = 1.0f - alpha;
+			alpha2 += alpha * alpha;
+			beta2 += beta * beta;
+			alphaBeta += alpha * beta;
+			for (int c = 0; c < 3; c++) {
+				alphaX[c] += alpha * texels[i * 4 + c];
+				betaX[c] += beta * texels[i * 4 + c];
+			}
+		}
+		float determinant = alpha2 * beta2 - alphaBeta * alphaBeta;
+		if (std::fabs(determinant) < 1e-6f) {
+			return false;
+		}
+		for (int c = 0; c < 3; c++) {
+			float value0 = (alphaX[c] * beta2 - betaX[c] * alphaBeta) / determinant;
+			float value1 = (betaX[c] * alpha2 - alphaX[c] * alphaBeta) / determinant;
+			endpoint0[c] = std::min(255, std::max(0, (int)std::lround(value0)));
+			endpoint1[c] = std::min(255, std::max(0, (int)std::lround(value1)));
+		}
+		return true;
+	}
+
+	// 4x4 RGBA8 texels, alpha ignored, into 8 bytes of BC1 colour
+	static void encodeColor(const unsigned char* texels, unsigned char* block, bool simd) {
+		int minimum[3], maximum[3];
+#ifdef BLOCK_ENCODER_SSE2
+		if (simd) {
+			findColorRangeSSE2(texels, minimum, maximum);
+		}
+		else
+#endif
+		{
+			for (int c = 0; c < 3; c++) {
+				minimum[c] = maximum[c] = texels[c];
+			}
+			for (int i = 1; i < 16; i++) {
+				for (int c = 0; c < 3; c++) {
+					minimum[c] = std::min(minimum[c], (int)texels[i * 4 + c]);
+					maximum[c] = std::max(maximum[c], (int)texels[i * 4 + c]);
+				}
+			}
+		}
+
+		// the box diagonal that follows the colours: every channel that falls while the widest one rises is flipped.
+		// covariances are scaled by 256 to stay in integers
+		int sums[3] = { 0, 0, 0 };
+		int products[3][3] = {};
+		for (int i = 0; i < 16; i++) {
+			const unsigned char* texel = texels + i * 4;
+			for (int c = 0; c < 3; c++) {
+				sums[c] += texel[c];
+				for (int d = c; d < 3; d++) {
+					products[c][d] += texel[c] * texel[d];
+				}
+			}
+		}
+		int widest = 0;
+		for (int c = 1; c < 3; c++) {
+			if (maximum[c] - minimum[c] > maximum[widest] - minimum[widest]) {
+				widest = c;
+			}
+		}
+		int endpoint0[3], endpoint1[3];
+		for (int c = 0; c < 3; c++) {
+			// pulled in by a sixteenth of the range, the palette has entries between the endpoints
+			int inset = (maximum[c] - minimum[c]) >> 4;
+			endpoint0[c] = maximum[c] - inset;
+			endpoint1[c] = minimum[c] + inset;
+			int first = std::min(c, widest), second = std::max(c, widest);
+			if (16 * products[first][second] - sums[first] * sums[second] < 0) {
+				std::swap(endpoint0[c], endpoint1[c]);
+			}
+		}
+
+		ColorFit fit;
+		fitColors(texels, endpoint0, endpoint1, fit, simd);
+		if (fit.error > 0 && refineEndpoints(texels, fit, endpoint0, endpoint1)) {
+			ColorFit refined;
+			fitColors(texels, endpoint0, endpoint1, refined, simd);
+			if (refined.error < fit.error) {
+				fit = refined;
+			}
+		}
+
+		writeShort(block, fit.color0);
+		writeShort(block + 2, fit.color1);
+		unsigned int indices = 0;
+		for (int i = 0; i < 16; i++) {
+			indices |= (unsigned int)fit.indices[i] << (2 * i);
+		}
+		for (int i = 0; i < 4; i++) {
+			block[4 + i] = (unsigned char)(indices >> (8 * i));
+		}
+	}
+
+	// 16 values into 8 bytes of BC4 (also the BC3 alpha half), eight values between the exact minimum and maximum
+	static void encodeChannel(const unsigned char* values, unsigned char* block, bool simd) {
+		int low = values[0], high = values[0];
+		for (int i = 1; i < 16; i++) {
+			low = std::min(low, (int)values[i]);
+			high = std::max(high, (int)values[i]);
+		}
+		block[0] = (unsigned char)high;
+		block[1] = (unsigned char)low;
+		memset(block + 2, 0, 6);
+		if (high == low) {
+			// the six value mode, but every index is 0
+			return;
+		}
+		// the palette of the eight value mode, as BlockDecoder derives it
+		unsigned char palette[8];
+		palette[0] = (unsigned char)high;
+		palette[1] = (unsigned char)low;
+		for (int i = 1; i < 7; i++) {
+			palette[i + 1] = (unsigned char)(((7 - i) * high + i * low + 3) / 7);
+		}
+		alignas(16) unsigned char indices[16];
+#ifdef BLOCK_ENCODER_SSE2
+		if (simd) {
+			selectChannelIndicesSSE2(values, palette, indices);
+		}
+		else
+#endif
+		{
+			for (int i = 0; i < 16; i++) {
+				int bestDistance = INT_MAX;
+				for (int k = 0; k < 8; k++) {
+					int distance = std::abs(values[i] - palette[k]);
+					if (distance < bestDistance) {
+						bestDistance = distance;
+						indices[i] = (unsigned char)k;
+					}
+				}
+			}
+		}
+		unsigned long long packed = 0;
+		for (int i = 0; i < 16; i++) {
+			packed |= (unsigned long long)indices[i] << (3 * i);
+		}
+		for (int i = 0; i < 6; i++) {
+			block[2 + i] = (unsigned char)(packed >> (8 * i));
+		}
+	}
+
+	// one channel of a tile, the SSE2 path loads it as a whole register
+	static void gatherChannel(const unsigned char* tile, int channel, unsigned char* values) {
+		for (int i = 0; i < 16; i++) {
+			values[i] = tile[i * 4 + channel];
+		}
+	}
+
+	// the 4x4 texels at (x, y) expanded to RGBA8, positions past the edge repeat the last row and column
+	static void loadTile(const unsigned char* pixels, int width, int height, int channels, int x, int y, unsigned char* tile) {
+		size_t pitch = (size_t)width * channels;
+		for (int row = 0; row < 4; row++) {
+			const unsigned char* source = pixels + (size_t)std::min(y + row, height - 1) * pitch;
+			unsigned char* target = tile + row * 16;
+			if (channels == 4 && x + 4 <= width) {
+				memcpy(target, source + (size_t)x * 4, 16);
+				continue;
+			}
+			for (int column = 0; column < 4; column++) {
+				const unsigned char* texel = source + (size_t)std::min(x + column, width - 1) * channels;
+				for (int c = 0; c < 4; c++) {
+					target[column * 4 + c] = c < channels ? texel[c] : 255;
+				}
+			}
+		}
+	}
+
+	CompressedTexture::Format getFormat(int channels) {
+		switch (channels) {
+		case 1: return CompressedTexture::FORMAT_BC4;
+		case 2: return CompressedTexture::FORMAT_BC5;
+		case 3: return CompressedTexture::FORMAT_BC1;
+		default: return CompressedTexture::FORMAT_BC3;
+		}
+	}
+
+	void encodeImage(const unsigned char* pixels, int width, int height, int channels, unsigned char* out, ThreadPool& pool, bool simd) {
+		size_t blockBytes = (channels == 1 || channels == 3) ? 8 : 16;
+		int blocksWide = (width + 3) / 4;
+		int blocksHigh = (height + 3) / 4;
+		// one row of blocks per task
+		pool.run((size_t)blocksHigh, [&](size_t blockRow) {
+			unsigned char* block = out + blockRow * blocksWide * blockBytes;
+			alignas(16) unsigned char tile[16 * 4];
+			alignas(16) unsigned char values[16];
+			for (int blockX = 0; blockX < blocksWide; blockX++, block += blockBytes) {
+				loadTile(pixels, width, height, channels, blockX * 4, (int)blockRow * 4, tile);
+				switch (channels) {
+				case 1:
+					gatherChannel(tile, 0, values);
+					encodeChannel(values, block, simd);
+					break;
+				case 2:
+					gatherChannel(tile, 0, values);
+					encodeChannel(values, block, simd);
+					gatherChannel(tile, 1, values);
+					encodeChannel(values, block + 8, simd);
+					break;
+				case 3:
+					encodeColor(tile, block, simd);
+					break;
+				default:
+					gatherChannel(tile, 3, values);
+					encodeChannel(values, block, simd);
+					encodeColor(tile, block + 8, simd);
+					break;
+				}
+			}
+		});
+	}
+}
@@ -0,0 +1,26 @@
+#ifndef BLOCK_ENCODER_H
+#define BLOCK_ENCODER_H
+
+#include "CompressedTexture.h"
+#include "../Utility/ThreadPool.h"
+
+// real time compression of 8 bit images into BC1 (RGB), BC3 (RGBA), BC4 (R) and BC5 (RG), fast enough to run at
+// load time for textures that only exist as JPG/PNG. colour endpoints are the bounding box diagonal that follows the
+// texel correlation, refined once by a least squares fit; the alpha and BC4/BC5 channels use their exact range
+namespace BlockEncoder {
+
+	// true when this build picks the palette indices with SSE2
+	bool isSimd();
+
+	// the format a width x height image with this many channels is compressed to: BC4, BC5, BC1 or BC3
+	CompressedTexture::Format getFormat(int channels);
+
+	// encodes an image of tightly packed rows with 1 to 4 channels into getFormat(channels), out must hold
+	// CompressedTexture::levelSize() bytes. rows of 4x4 blocks are spread over the pool, the texels of partial blocks
+	// repeat the last row and column. simd false runs the scalar reference, both produce exactly the same bytes
+	void encodeImage(const unsigned char* pixels, int width, int height, int channels, unsigned char* out,
+		ThreadPool& pool = ThreadPool::shared(), bool simd = true);
+
+}
+
+#endif // BLOCK_ENCODER_H
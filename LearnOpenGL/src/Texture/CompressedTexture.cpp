@@ -0,0 +1,674 @@
+#include <cstring>
+#include <cstdio>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+#include <functional>
+
+#include "CompressedTexture.h"
+#include "BlockDecoder.h"
+#include "BlockEncoder.h"
+#include "../Utility/MappedFile.h"
+#include "../Utility/Lz4.h"
+#include "../Utility/GLExtensions.h"
+#include "PixelConverter.h"
+
+namespace CompressedTexture {
+
+	// EXT_texture_compression_s3tc and its sRGB variants from EXT_texture_sRGB, glad is generated without extensions
+	const GLenum COMPRESSED_RGB_S3TC_DXT1 = 0x83F0;
+	const GLenum COMPRESSED_RGBA_S3TC_DXT1 = 0x83F1;
+	const GLenum COMPRESSED_RGBA_S3TC_DXT3 = 0x83F2;
+	const GLenum COMPRESSED_RGBA_S3TC_DXT5 = 0x83F3;
+	const GLenum COMPRESSED_SRGB_S3TC_DXT1 = 0x8C4C;
+	const GLenum COMPRESSED_SRGB_ALPHA_S3TC_DXT1 = 0x8C4D;
+	const GLenum COMPRESSED_SRGB_ALPHA_S3TC_DXT3 = 0x8C4E;
+	const GLenum COMPRESSED_SRGB_ALPHA_S3TC_DXT5 = 0x8C4F;
+
+	struct FormatInfo {
+		const char* name;
+		// bytes per 4x4 block, 0 for the uncompressed formats
+		size_t blockBytes;
+		// bytes per texel of the uncompressed formats
+		size_t texelBytes;
+		GLenum internalFormat;
+		// 0 when there is no sRGB variant
+		GLenum srgbInternalFormat;
+		// client format of the uncompressed formats
+		GLenum format;
+		// VkFormat values KTX2 files use, 0 when there is none
+		unsigned int vkFormat;
+		unsigned int vkSrgbFormat;
+	};
+
+	static const FormatInfo FORMATS[FORMAT_COUNT] = {
+		{ "unknown", 0, 0, 0, 0, 0, 0, 0 },
+		{ "R8", 0, 1, GL_R8, 0, GL_RED, 9, 0 },
+		{ "RG8", 0, 2, GL_RG8, 0, GL_RG, 16, 0 },
+		{ "RGB8", 0, 3, GL_RGB8, GL_SRGB8, GL_RGB, 23, 29 },
+		{ "RGBA8", 0, 4, GL_RGBA8, GL_SRGB8_ALPHA8, GL_RGBA, 37, 43 },
+		{ "BGRA8", 0, 4, GL_RGBA8, GL_SRGB8_ALPHA8, GL_BGRA, 44, 50 },
+		{ "BC1", 8, 0, COMPRESSED_RGB_S3TC_DXT1, COMPRESSED_SRGB_S3TC_DXT1, 0, 131, 132 },
+		{ "BC1A", 8, 0, COMPRESSED_RGBA_S3TC_DXT1, COMPRESSED_SRGB_ALPHA_S3TC_DXT1, 0, 133, 134 },
+		{ "BC2", 16, 0, COMPRESSED_RGBA_S3TC_DXT3, COMPRESSED_SRGB_ALPHA_S3TC_DXT3, 0, 135, 136 },
+		{ "BC3", 16, 0, COMPRESSED_RGBA_S3TC_DXT5, COMPRESSED_SRGB_ALPHA_S3TC_DXT5, 0, 137, 138 },
+		{ "BC4", 8, 0, GL_COMPRESSED_RED_RGTC1, 0, 0, 139, 0 },
+		{ "BC5", 16, 0, GL_COMPRESSED_RG_RGTC2, 0, 0, 141, 0 },
+		{ "BC7", 16, 0, GL_COMPRESSED_RGBA_BPTC_UNORM, GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, 0, 145, 146 },
+		{ "ETC2", 8, 0, GL_COMPRESSED_RGB8_ETC2, GL_COMPRESSED_SRGB8_ETC2, 0, 147, 148 },
+		{ "ETC2A1", 8, 0, GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2, GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2, 0, 149, 150 },
+		{ "ETC2A", 16, 0, GL_COMPRESSED_RGBA8_ETC2_EAC, GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC, 0, 151, 152 }
+	};
+
+	static const unsigned char KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+	// the level index follows the fixed header
+	static const size_t KTX2_LEVEL_INDEX_OFFSET = 80;
+	// key/value entry saying which way the rows go, "rd" (top row first) when it is missing
+	static const char KTX2_ORIENTATION_KEY[] = "KTXorientation";
+	// supercompression scheme of files written with lz4 set, levels are LZ4 blocks. not a Khronos scheme (those are
+	// below 0x10000), other tools refuse these files, only load() reads them
+	static const unsigned int KTX2_SUPERCOMPRESSION_LZ4 = 0x10000;
+
+	// what a container describes, the levels point into the mapped file
+	struct Source {
+		Format format = FORMAT_UNKNOWN;
+		bool srgb = false;
+		int width = 0;
+		int height = 0;
+		// rows as OpenGL expects them, otherwise load() flips them
+		bool bottomUp = false;
+		std::vector<const unsigned char*> levels;
+		// bytes each level takes in the file, an LZ4 block when that is less than its size
+		std::vector<size_t> storedSizes;
+		bool lz4 = false;
+	};
+
+	static unsigned int readInt(const unsigned char* bytes) {
+		unsigned int value;
+		memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+
+	static unsigned long long readLong(const unsigned char* bytes) {
+		unsigned long long value;
+		memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+
+	static std::string getExtension(const std::string& path) {
+		size_t dot = path.find_last_of('.');
+		std::string extension = dot == std::string::npos ? "" : path.substr(dot + 1);
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)tolower(c); });
+		return extension;
+	}
+
+	bool isContainer(const std::string& path) {
+		std::string extension = getExtension(path);
+		return extension == "ktx2" || extension == "dds";
+	}
+
+	bool isSupported(Format format, bool srgb) {
+		switch (format) {
+		case FORMAT_R8:
+		case FORMAT_RG8:
+		case FORMAT_RGB8:
+		case FORMAT_RGBA8:
+		case FORMAT_BGRA8:
+			return true;
+		case FORMAT_BC1:
+		case FORMAT_BC1_ALPHA:
+		case FORMAT_BC2:
+		case FORMAT_BC3:
+			return GLExtensions::has("GL_EXT_texture_compression_s3tc") &&
+				(!srgb || GLExtensions::has("GL_EXT_texture_sRGB") || GLExtensions::has("GL_EXT_texture_compression_s3tc_srgb"));
+		case FORMAT_BC4:
+		case FORMAT_BC5:
+			return GLExtensions::hasVersion(3, 0) || GLExtensions::has("GL_ARB_texture_compression_rgtc");
+		case FORMAT_BC7:
+			return GLExtensions::hasVersion(4, 2) || GLExtensions::has("GL_ARB_texture_compression_bptc");
+		case FORMAT_ETC2_RGB:
+		case FORMAT_ETC2_RGB_A1:
+		case FORMAT_ETC2_RGBA:
+			return GLExtensions::hasVersion(4, 3) || GLExtensions::has("GL_ARB_ES3_compatibility");
+		default:
+			return false;
+		}
+	}
+
+	size_t levelSize(Format format, int width, int height) {
+		if (FORMATS[format].blockBytes == 0) {
+			return (size_t)width * height * FORMATS[format].texelBytes;
+		}
+		return (size_t)((width + 3) / 4) * ((height + 3) / 4) * FORMATS[format].blockBytes;
+	}
+
+	const char* getName(Format format) {
+		return FORMATS[format].name;
+	}
+
+	// checks that every level of the chain lies inside the file, levels are tightly packed from start on
+	static bool readPackedLevels(const MappedFile& file, size_t start, unsigned int levelCount, Source& source, std::string& error) {
+		size_t offset = start;
+		for (unsigned int level = 0; level < levelCount; level++) {
+			size_t size = levelSize(source.format, std::max(1, source.width >> level), std::max(1, source.height >> level));
+			if (offset > file.size() || size > file.size() - offset) {
+				error = "truncated at mip level " + std::to_string(level);
+				return false;
+			}
+			source.levels.push_back(file.data() + offset);
+			source.storedSizes.push_back(size);
+			offset += size;
+		}
+		return true;
+	}
+
+	// Khronos KTX 2.0: identifier, a fixed header, an index and one (offset, length) pair per level
+	static bool parseKtx2(const MappedFile& file, Source& source, std::string& error) {
+		const unsigned char* bytes = file.data();
+		if (file.size() < KTX2_LEVEL_INDEX_OFFSET || memcmp(bytes, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+			error = "not a KTX2 file";
+			return false;
+		}
+		unsigned int vkFormat = readInt(bytes + 12);
+		source.width = (int)readInt(bytes + 20);
+		source.height = (int)readInt(bytes + 24);
+		unsigned int depth = readInt(bytes + 28);
+		unsigned int layers = readInt(bytes + 32);
+		unsigned int faces = readInt(bytes + 36);
+		// 0 asks the loader to generate the chain
+		unsigned int levelCount = std::max(readInt(bytes + 40), 1u);
+		unsigned int supercompression = readInt(bytes + 44);
+		if (depth > 1 || layers > 1 || faces != 1 || source.width <= 0 || source.height <= 0) {
+			error = "only single 2D images are supported";
+			return false;
+		}
+		if (supercompression != 0 && supercompression != KTX2_SUPERCOMPRESSION_LZ4) {
+			error = "supercompressed (Basis/zstd) data is not supported";
+			return false;
+		}
+		source.lz4 = supercompression == KTX2_SUPERCOMPRESSION_LZ4;
+		for (int format = FORMAT_R8; format < FORMAT_COUNT && source.format == FORMAT_UNKNOWN; format++) {
+			if (FORMATS[format].vkFormat == vkFormat || (FORMATS[format].vkSrgbFormat != 0 && FORMATS[format].vkSrgbFormat == vkFormat)) {
+				source.format = (Format)format;
+				source.srgb = FORMATS[format].vkSrgbFormat == vkFormat;
+			}
+		}
+		if (source.format == FORMAT_UNKNOWN) {
+			error = "unsupported VkFormat " + std::to_string(vkFormat);
+			return false;
+		}
+		if (levelCount > 32 || KTX2_LEVEL_INDEX_OFFSET + levelCount * 24 > file.size()) {
+			error = "truncated level index";
+			return false;
+		}
+		// key/value data: entries of a 4 byte length, "key\0value", padded to 4 bytes
+		size_t keyValueOffset = readInt(bytes + 56);
+		size_t keyValueLength = readInt(bytes + 60);
+		if (keyValueOffset <= file.size() && keyValueLength <= file.size() - keyValueOffset) {
+			const unsigned char* entry = bytes + keyValueOffset;
+			const unsigned char* end = entry + keyValueLength;
+			while (end - entry >= 4) {
+				size_t length = readInt(entry);
+				const char* key = (const char*)entry + 4;
+				if (length > (size_t)(end - entry) - 4) {
+					break;
+				}
+				size_t keyLength = strnlen(key, length);
+				if (keyLength + 2 < length && strcmp(key, KTX2_ORIENTATION_KEY) == 0) {
+					// the second letter is the direction of t
+					source.bottomUp = key[keyLength + 2] == 'u';
+				}
+				entry += 4 + (length + 3) / 4 * 4;
+			}
+		}
+		for (unsigned int level = 0; level < levelCount; level++) {
+			const unsigned char* entry = bytes + KTX2_LEVEL_INDEX_OFFSET + level * 24;
+			unsigned long long offset = readLong(entry);
+			unsigned long long length = readLong(entry + 8);
+			unsigned long long uncompressedLength = readLong(entry + 16);
+			size_t expected = levelSize(source.format, std::max(1, source.width >> level), std::max(1, source.height >> level));
+			// LZ4 levels that would not shrink are stored as they are, a level of its full size is not compressed
+			size_t stored = source.lz4 ? (size_t)std::min(length, (unsigned long long)expected) : expected;
+			bool sizeValid = source.lz4 ? length <= expected && uncompressedLength == expected : length >= expected;
+			if (!sizeValid || offset > file.size() || stored > file.size() - offset) {
+				error = "truncated at mip level " + std::to_string(level);
+				return false;
+			}
+			source.levels.push_back(bytes + offset);
+			source.storedSizes.push_back(stored);
+		}
+		return true;
+	}
+
+	// DirectDraw Surface: "DDS ", a 124 byte header and for DX10 files a second 20 byte header, then the levels
+	static bool parseDds(const MappedFile& file, Source& source, std::string& error) {
+		const size_t HEADER_SIZE = 4 + 124;
+		const unsigned int MIPMAP_COUNT_FLAG = 0x20000;
+		const unsigned int FOURCC_FLAG = 0x4;
+		const unsigned int CUBEMAP_OR_VOLUME = 0x200 | 0x200000;
+		const unsigned char* bytes = file.data();
+		if (file.size() < HEADER_SIZE || memcmp(bytes, "DDS ", 4) != 0 || readInt(bytes + 4) != 124) {
+			error = "not a DDS file";
+			return false;
+		}
+		unsigned int flags = readInt(bytes + 8);
+		source.height = (int)readInt(bytes + 12);
+		source.width = (int)readInt(bytes + 16);
+		unsigned int levelCount = (flags & MIPMAP_COUNT_FLAG) ? std::max(readInt(bytes + 28), 1u) : 1;
+		unsigned int pixelFlags = readInt(bytes + 80);
+		const unsigned char* fourCC = bytes + 84;
+		if ((readInt(bytes + 112) & CUBEMAP_OR_VOLUME) != 0) {
+			error = "only single 2D images are supported";
+			return false;
+		}
+		size_t dataStart = HEADER_SIZE;
+		if ((pixelFlags & FOURCC_FLAG) != 0 && memcmp(fourCC, "DX10", 4) == 0) {
+			if (file.size() < HEADER_SIZE + 20) {
+				error = "truncated DX10 header";
+				return false;
+			}
+			unsigned int dxgiFormat = readInt(bytes + HEADER_SIZE);
+			unsigned int arraySize = readInt(bytes + HEADER_SIZE + 12);
+			if (arraySize > 1) {
+				error = "texture arrays are not supported";
+				return false;
+			}
+			dataStart += 20;
+			// DXGI_FORMAT values
+			switch (dxgiFormat) {
+			case 28: source.format = FORMAT_RGBA8; break;
+			case 29: source.format = FORMAT_RGBA8; source.srgb = true; break;
+			case 87: source.format = FORMAT_BGRA8; break;
+			case 91: source.format = FORMAT_BGRA8; source.srgb = true; break;
+			case 71: source.format = FORMAT_BC1_ALPHA; break;
+			case 72: source.format = FORMAT_BC1_ALPHA; source.srgb = true; break;
+			case 74: source.format = FORMAT_BC2; break;
+			case 75: source.format = FORMAT_BC2; source.srgb = true; break;
+			case 77: source.format = FORMAT_BC3; break;
+			case 78: source.format = FORMAT_BC3; source.srgb = true; break;
+			case 80: source.format = FORMAT_BC4; break;
+			case 83: source.format = FORMAT_BC5; break;
+			case 98: source.format = FORMAT_BC7; break;
+			case 99: source.format = FORMAT_BC7; source.srgb = true; break;
+			default:
+				error = "unsupported DXGI format " + std::to_string(dxgiFormat);
+				return false;
+			}
+		}
+		else if ((pixelFlags & FOURCC_FLAG) != 0) {
+			// DXT1 may use its transparent colour, so it is read as the alpha variant like D3D does
+			if (memcmp(fourCC, "DXT1", 4) == 0) source.format = FORMAT_BC1_ALPHA;
+			else if (memcmp(fourCC, "DXT3", 4) == 0) source.format = FORMAT_BC2;
+			else if (memcmp(fourCC, "DXT5", 4) == 0) source.format = FORMAT_BC3;
+			else if (memcmp(fourCC, "ATI1", 4) == 0 || memcmp(fourCC, "BC4U", 4) == 0) source.format = FORMAT_BC4;
+			else if (memcmp(fourCC, "ATI2", 4) == 0 || memcmp(fourCC, "BC5U", 4) == 0) source.format = FORMAT_BC5;
+			else {
+				error = "unsupported FourCC " + std::string((const char*)fourCC, 4);
+				return false;
+			}
+		}
+		else if (readInt(bytes + 88) == 32 && readInt(bytes + 92) == 0xFF && readInt(bytes + 96) == 0xFF00 &&
+			readInt(bytes + 100) == 0xFF0000 && readInt(bytes + 104) == 0xFF000000u) {
+			source.format = FORMAT_RGBA8;
+		}
+		else if (readInt(bytes + 88) == 32 && readInt(bytes + 92) == 0xFF0000 && readInt(bytes + 96) == 0xFF00 &&
+			readInt(bytes + 100) == 0xFF && readInt(bytes + 104) == 0xFF000000u) {
+			source.format = FORMAT_BGRA8;
+		}
+		else {
+			error = "unsupported pixel format";
+			return false;
+		}
+		if (levelCount > 32 || source.width <= 0 || source.height <= 0) {
+			error = "bad dimensions";
+			return false;
+		}
+		return readPackedLevels(file, dataStart, levelCount, source, error);
+	}
+
+	// expands every level on the CPU into RGBA8, R8 (BC4) or RG8 (BC5)
+	static bool decodeLevels(const Source& source, TextureData& data, std::string& error) {
+		int channels;
+		switch (source.format) {
+		case FORMAT_BC1:
+		case FORMAT_BC1_ALPHA:
+		case FORMAT_BC2:
+		case FORMAT_BC3:
+			channels = 4;
+			data.internalFormat = source.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+			data.format = GL_RGBA;
+			break;
+		case FORMAT_BC4:
+			channels = 1;
+			data.internalFormat = GL_R8;
+			data.format = GL_RED;
+			break;
+		case FORMAT_BC5:
+			channels = 2;
+			data.internalFormat = GL_RG8;
+			data.format = GL_RG;
+			break;
+		default:
+			error = std::string(getName(source.format)) + " is not supported by this context and can not be decoded";
+			return false;
+		}
+		data.compressed = false;
+		size_t total = 0;
+		for (size_t level = 0; level < source.levels.size(); level++) {
+			int width = std::max(1, source.width >> level);
+			int height = std::max(1, source.height >> level);
+			data.levels.push_back(TextureLevel{ total, (size_t)width * height * channels, width, height });
+			total += (size_t)width * height * channels;
+		}
+		data.bytes.resize(total);
+
+		size_t blockBytes = FORMATS[source.format].blockBytes;
+		for (size_t level = 0; level < source.levels.size(); level++) {
+			const TextureLevel& target = data.levels[level];
+			const unsigned char* block = source.levels[level];
+			size_t pitch = (size_t)target.width * channels;
+			for (int y = 0; y < target.height; y += 4) {
+				for (int x = 0; x < target.width; x += 4, block += blockBytes) {
+					// edge blocks are decoded whole into a scratch tile and clipped
+					unsigned char tile[4 * 4 * 4];
+					size_t tilePitch = 4 * (size_t)channels;
+					switch (source.format) {
+					case FORMAT_BC1: BlockDecoder::decodeBC1(block, tile, tilePitch, false); break;
+					case FORMAT_BC1_ALPHA: BlockDecoder::decodeBC1(block, tile, tilePitch, true); break;
+					case FORMAT_BC2: BlockDecoder::decodeBC2(block, tile, tilePitch); break;
+					case FORMAT_BC3: BlockDecoder::decodeBC3(block, tile, tilePitch); break;
+					case FORMAT_BC4: BlockDecoder::decodeBC4(block, tile, tilePitch, 1); break;
+					default: BlockDecoder::decodeBC5(block, tile, tilePitch); break;
+					}
+					int columns = std::min(4, target.width - x);
+					int rows = std::min(4, target.height - y);
+					unsigned char* out = data.bytes.data() + target.offset + (size_t)y * pitch + (size_t)x * channels;
+					for (int row = 0; row < rows; row++) {
+						memcpy(out + row * pitch, tile + row * tilePitch, (size_t)columns * channels);
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	// the levels as they are, out of the mapping. LZ4 levels decompress straight into data, false when one is corrupt
+	static bool copyLevels(const Source& source, TextureData& data, std::string& error) {
+		const FormatInfo& info = FORMATS[source.format];
+		data.compressed = info.blockBytes != 0;
+		data.internalFormat = source.srgb && info.srgbInternalFormat != 0 ? info.srgbInternalFormat : info.internalFormat;
+		data.format = info.format;
+		size_t total = 0;
+		for (size_t level = 0; level < source.levels.size(); level++) {
+			int width = std::max(1, source.width >> level);
+			int height = std::max(1, source.height >> level);
+			size_t size = levelSize(source.format, width, height);
+			data.levels.push_back(TextureLevel{ total, size, width, height });
+			total += size;
+		}
+		// one copy out of the mapping, the file is closed before the upload
+		data.bytes.resize(total);
+		for (size_t level = 0; level < source.levels.size(); level++) {
+			const TextureLevel& mip = data.levels[level];
+			if (source.storedSizes[level] == mip.size) {
+				memcpy(data.bytes.data() + mip.offset, source.levels[level], mip.size);
+			}
+			else if (!Lz4::decompress(source.levels[level], source.storedSizes[level], data.bytes.data() + mip.offset, mip.size)) {
+				error = "corrupt LZ4 data at mip level " + std::to_string(level);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// reverses the order of the first rows rows of a 4x4 block's bit field, rowBits per row starting at bit 0
+	static unsigned long long reverseRows(unsigned long long bits, int rowBits, int rows) {
+		unsigned long long mask = (1ull << rowBits) - 1;
+		// BC2's alpha fills all 64 bits
+		unsigned long long used = rowBits * rows >= 64 ? ~0ull : (1ull << (rowBits * rows)) - 1;
+		unsigned long long result = bits & ~used;
+		for (int row = 0; row < rows; row++) {
+			result |= ((bits >> (row * rowBits)) & mask) << ((rows - 1 - row) * rowBits);
+		}
+		return result;
+	}
+
+	static void flipField(unsigned char* bytes, size_t size, int rowBits, int rows) {
+		unsigned long long bits = 0;
+		memcpy(&bits, bytes, size);
+		bits = reverseRows(bits, rowBits, rows);
+		memcpy(bytes, &bits, size);
+	}
+
+	// turns the first rows rows of one block upside down, the endpoints stay and only the index rows move
+	static void flipBlock(Format format, unsigned char* block, int rows) {
+		switch (format) {
+		case FORMAT_BC1:
+		case FORMAT_BC1_ALPHA:
+			// a byte of 2 bit indices per row
+			flipField(block + 4, 4, 8, rows);
+			break;
+		case FORMAT_BC2:
+			// 4 bit alpha values, then a BC1 block
+			flipField(block, 8, 16, rows);
+			flipField(block + 12, 4, 8, rows);
+			break;
+		case FORMAT_BC3:
+			// two alpha endpoints and 3 bit indices, then a BC1 block
+			flipField(block + 2, 6, 12, rows);
+			flipField(block + 12, 4, 8, rows);
+			break;
+		case FORMAT_BC4:
+			flipField(block + 2, 6, 12, rows);
+			break;
+		default:
+			// BC5, two BC4 blocks
+			flipField(block + 2, 6, 12, rows);
+			flipField(block + 10, 6, 12, rows);
+			break;
+		}
+	}
+
+	// puts the levels of data (in format) bottom row first. false when the rows can not be moved without a decode
+	static bool flipLevels(Format format, TextureData& data) {
+		if (!data.compressed) {
+			for (const TextureLevel& level : data.levels) {
+				PixelConverter::flipRows(data.bytes.data() + level.offset, level.size / level.height, level.height);
+			}
+			return true;
+		}
+		if (format < FORMAT_BC1 || format > FORMAT_BC5) {
+			return false;
+		}
+		// a partial last row of blocks would have to move by less than a block
+		for (const TextureLevel& level : data.levels) {
+			if (level.height > 4 && level.height % 4 != 0) {
+				return false;
+			}
+		}
+		size_t blockBytes = FORMATS[format].blockBytes;
+		for (const TextureLevel& level : data.levels) {
+			int blockRows = (level.height + 3) / 4;
+			size_t rowBytes = (size_t)((level.width + 3) / 4) * blockBytes;
+			unsigned char* bytes = data.bytes.data() + level.offset;
+			PixelConverter::flipRows(bytes, rowBytes, blockRows);
+			for (size_t offset = 0; offset < level.size; offset += blockBytes) {
+				flipBlock(format, bytes + offset, std::min(4, level.height));
+			}
+		}
+		return true;
+	}
+
+	bool load(const std::string& path, TextureData& data, std::string& error) {
+		data = TextureData();
+		MappedFile file;
+		if (!file.open(path.c_str())) {
+			error = "can't open";
+			return false;
+		}
+		Source source;
+		bool parsed = getExtension(path) == "dds" ? parseDds(file, source, error) : parseKtx2(file, source, error);
+		if (!parsed) {
+			return false;
+		}
+		data.width = source.width;
+		data.height = source.height;
+		if (!isSupported(source.format, source.srgb)) {
+			// the block decoder reads whole levels, LZ4 levels are unpacked first
+			TextureData unpacked;
+			if (source.lz4 && !copyLevels(source, unpacked, error)) {
+				return false;
+			}
+			for (size_t level = 0; level < unpacked.levels.size(); level++) {
+				source.levels[level] = unpacked.bytes.data() + unpacked.levels[level].offset;
+			}
+			if (!decodeLevels(source, data, error)) {
+				return false;
+			}
+		}
+		else if (!copyLevels(source, data, error)) {
+			return false;
+		}
+		if (!source.bottomUp && !flipLevels(source.format, data)) {
+			std::cout << "WARNING::TEXTURE::UPSIDE_DOWN " << path << " (" << getName(source.format) << " rows stored top first can not be flipped)" << std::endl;
+		}
+		return true;
+	}
+
+	static void writeInt(unsigned char* bytes, unsigned long long value, size_t size) {
+		for (size_t i = 0; i < size; i++) {
+			bytes[i] = (unsigned char)(value >> (8 * i));
+		}
+	}
+
+	bool write(const std::string& path, const TextureData& data, std::string& error, bool lz4) {
+		Format format = FORMAT_UNKNOWN;
+		bool srgb = false;
+		for (int candidate = FORMAT_R8; candidate < FORMAT_COUNT && format == FORMAT_UNKNOWN; candidate++) {
+			// RGBA8 and BGRA8 share the internal format
+			if (!data.compressed && FORMATS[candidate].format != data.format) {
+				continue;
+			}
+			srgb = FORMATS[candidate].srgbInternalFormat != 0 && FORMATS[candidate].srgbInternalFormat == data.internalFormat;
+			if (srgb || FORMATS[candidate].internalFormat == data.internalFormat) {
+				format = (Format)candidate;
+			}
+		}
+		if (format == FORMAT_UNKNOWN || data.levels.empty() || data.levels.size() > 32) {
+			error = "no KTX2 format for this data";
+			return false;
+		}
+		const FormatInfo& info = FORMATS[format];
+
+		// the only key/value entry says the rows go up, the way TextureData holds them
+		const char orientation[] = "ru";
+		size_t keyValueLength = sizeof(KTX2_ORIENTATION_KEY) + sizeof(orientation);
+		size_t keyValueOffset = KTX2_LEVEL_INDEX_OFFSET + data.levels.size() * 24;
+		std::vector<unsigned char> file(keyValueOffset + 4 + (keyValueLength + 3) / 4 * 4, 0);
+		writeInt(&file[keyValueOffset], keyValueLength, 4);
+		memcpy(&file[keyValueOffset + 4], KTX2_ORIENTATION_KEY, sizeof(KTX2_ORIENTATION_KEY));
+		memcpy(&file[keyValueOffset + 4 + sizeof(KTX2_ORIENTATION_KEY)], orientation, sizeof(orientation));
+		memcpy(file.data(), KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+		writeInt(&file[12], srgb ? info.vkSrgbFormat : info.vkFormat, 4);
+		// typeSize, 1 for 8 bit and block compressed formats
+		writeInt(&file[16], 1, 4);
+		writeInt(&file[20], (unsigned int)data.width, 4);
+		writeInt(&file[24], (unsigned int)data.height, 4);
+		// depth and layers stay 0, one face
+		writeInt(&file[36], 1, 4);
+		writeInt(&file[40], data.levels.size(), 4);
+		writeInt(&file[56], keyValueOffset, 4);
+		writeInt(&file[60], 4 + (keyValueLength + 3) / 4 * 4, 4);
+		writeInt(&file[44], lz4 ? KTX2_SUPERCOMPRESSION_LZ4 : 0, 4);
+		// no data format descriptor. the spec asks for one, load() never reads it and these files are only written for it
+
+		// levels go smallest first, each aligned to its texel or block size and to 4 bytes
+		size_t unit = info.blockBytes != 0 ? info.blockBytes : info.texelBytes;
+		size_t alignment = unit;
+		while (alignment % 4 != 0) {
+			alignment += unit;
+		}
+		std::vector<unsigned char> packed;
+		for (size_t level = data.levels.size(); level-- > 0;) {
+			const TextureLevel& mip = data.levels[level];
+			if (mip.size != levelSize(format, mip.width, mip.height) || mip.offset + mip.size > data.bytes.size()) {
+				error = "mip level " + std::to_string(level) + " has the wrong size";
+				return false;
+			}
+			const unsigned char* bytes = data.bytes.data() + mip.offset;
+			size_t stored = mip.size;
+			if (lz4) {
+				// a level LZ4 can not shrink is kept as it is, load() tells them apart by their length
+				packed.resize(Lz4::getBound(mip.size));
+				size_t packedSize = Lz4::compress(bytes, mip.size, packed.data(), packed.size());
+				if (packedSize != 0 && packedSize < mip.size) {
+					bytes = packed.data();
+					stored = packedSize;
+				}
+			}
+			file.resize((file.size() + alignment - 1) / alignment * alignment, 0);
+			unsigned char* entry = &file[KTX2_LEVEL_INDEX_OFFSET + level * 24];
+			writeInt(entry, file.size(), 8);
+			writeInt(entry + 8, stored, 8);
+			writeInt(entry + 16, mip.size, 8);
+			file.insert(file.end(), bytes, bytes + stored);
+		}
+
+		// written next to the target and renamed, so a reader never sees half a file. the name is per thread in case
+		// two threads produce the same file
+		std::string temporary = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+		std::ofstream stream(temporary, std::ios::binary);
+		if (!stream || !stream.write((const char*)file.data(), file.size())) {
+			error = "can't write " + temporary;
+			return false;
+		}
+		stream.close();
+		std::error_code renameError;
+		std::filesystem::rename(temporary, path, renameError);
+		if (renameError) {
+			std::remove(temporary.c_str());
+			error = "can't rename " + temporary + " (" + renameError.message() + ")";
+			return false;
+		}
+		return true;
+	}
+
+	bool compress(TextureData& data, ThreadPool& pool) {
+		int channels;
+		switch (data.format) {
+		case GL_RED: channels = 1; break;
+		case GL_RG: channels = 2; break;
+		case GL_RGB: channels = 3; break;
+		case GL_RGBA: channels = 4; break;
+		default: return false;
+		}
+		bool srgb = data.internalFormat == GL_SRGB8 || data.internalFormat == GL_SRGB8_ALPHA8;
+		Format format = BlockEncoder::getFormat(channels);
+		if (data.compressed || data.levels.empty() || !isSupported(format, srgb)) {
+			return false;
+		}
+
+		const FormatInfo& info = FORMATS[format];
+		TextureData result;
+		result.width = data.width;
+		result.height = data.height;
+		result.compressed = true;
+		result.internalFormat = srgb && info.srgbInternalFormat != 0 ? info.srgbInternalFormat : info.internalFormat;
+		size_t total = 0;
+		for (const TextureLevel& level : data.levels) {
+			size_t size = levelSize(format, level.width, level.height);
+			result.levels.push_back(TextureLevel{ total, size, level.width, level.height });
+			total += size;
+		}
+		result.bytes.resize(total);
+		for (size_t level = 0; level < data.levels.size(); level++) {
+			const TextureLevel& source = data.levels[level];
+			BlockEncoder::encodeImage(data.bytes.data() + source.offset, source.width, source.height, channels,
+				result.bytes.data() + result.levels[level].offset, pool);
+		}
+		data = std::move(result);
+		return true;
+	}
+}
@@ -0,0 +1,67 @@
+#ifndef COMPRESSED_TEXTURE_H
+#define COMPRESSED_TEXTURE_H
+
+#include <string>
+
+#include "TextureData.h"
+#include "../Utility/ThreadPool.h"
+
+// loader for KTX2 and DDS containers holding precompressed BC1-BC5, BC7 or ETC2 data (or plain 8 bit texels) with
+// their mip chains. formats the driver can sample are handed to glCompressedTexImage2D as they are, BC1-BC5
+// fall back to a CPU decode into RGBA8/R8/RG8 when the extension is missing
+namespace CompressedTexture {
+
+	enum Format {
+		FORMAT_UNKNOWN,
+		FORMAT_R8,
+		FORMAT_RG8,
+		FORMAT_RGB8,
+		FORMAT_RGBA8,
+		// RGBA8 stored in the order GL_BGRA uploads take
+		FORMAT_BGRA8,
+		FORMAT_BC1,
+		// BC1 where index 3 of three colour blocks is transparent
+		FORMAT_BC1_ALPHA,
+		FORMAT_BC2,
+		FORMAT_BC3,
+		FORMAT_BC4,
+		FORMAT_BC5,
+		FORMAT_BC7,
+		FORMAT_ETC2_RGB,
+		FORMAT_ETC2_RGB_A1,
+		FORMAT_ETC2_RGBA,
+		FORMAT_COUNT
+	};
+
+	// true for .ktx2 and .dds paths
+	bool isContainer(const std::string& path);
+
+	// true if the current context samples the format natively (the extension list is read once after context
+	// creation, so this may be called from any thread)
+	bool isSupported(Format format, bool srgb);
+
+	// reads the file, validates every level against its size and either keeps the blocks as they are or decodes
+	// them when the format is not supported. levels stored top row first (DDS, and KTX2 without a "ru"
+	// KTXorientation) are flipped into OpenGL's order, which BC7 and ETC2 blocks and BC1-BC5 levels with a partial
+	// row of blocks can not be. safe to call on worker threads
+	bool load(const std::string& path, TextureData& data, std::string& error);
+
+	// writes data as it is (compressed or 8 bit levels, bottom row first) into a KTX2 file that load() reads back
+	// without any work. with lz4 set every level is stored as an LZ4 block under a supercompression scheme of this
+	// loader's own. flat artwork and block compressed levels shrink two to ten times, photographs' texels hardly;
+	// decompressing costs a small fraction of a JPEG/PNG decode
+	bool write(const std::string& path, const TextureData& data, std::string& error, bool lz4 = false);
+
+	// compresses every level of uncompressed R8, RG8, RGB8 or RGBA8 data (as stb_image returns it) into BC4, BC5, BC1
+	// or BC3 with BlockEncoder. glGenerateMipmap does not work on compressed textures, so the chain has to be there
+	// before (see MipGenerator). returns false and leaves data alone when the context can not sample the result
+	bool compress(TextureData& data, ThreadPool& pool = ThreadPool::shared());
+
+	// byte size of one level, 4x4 blocks for the compressed formats and tightly packed rows for the others
+	size_t levelSize(Format format, int width, int height);
+
+	const char* getName(Format format);
+
+}
+
+#endif // COMPRESSED_TEXTURE_H
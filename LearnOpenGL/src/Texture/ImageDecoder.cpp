@@ -0,0 +1,341 @@
+#include <cstdio>
+#include <cstring>
+#include <csetjmp>
+
+// the stb_image implementation lives here, everything else only includes the header
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+#include "ImageDecoder.h"
+#include "PixelConverter.h"
+#include "../Utility/MappedFile.h"
+
+// the build defines which system codecs it links, see ImageDecoder.h
+#ifdef IMAGE_DECODER_WITH_LIBJPEG
+#define IMAGE_DECODER_LIBJPEG
+#include <jpeglib.h>
+#endif
+#ifdef IMAGE_DECODER_WITH_SPNG
+#define IMAGE_DECODER_SPNG
+#include <spng.h>
+#endif
+#ifdef IMAGE_DECODER_WITH_LIBPNG
+#define IMAGE_DECODER_LIBPNG
+#include <png.h>
+#endif
+
+namespace ImageDecoder {
+
+	static const unsigned char JPEG_SIGNATURE[3] = { 0xFF, 0xD8, 0xFF };
+	static const unsigned char PNG_SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+	static bool isJpeg(const unsigned char* bytes, size_t size) {
+		return size >= sizeof(JPEG_SIGNATURE) && memcmp(bytes, JPEG_SIGNATURE, sizeof(JPEG_SIGNATURE)) == 0;
+	}
+
+	static bool isPng(const unsigned char* bytes, size_t size) {
+		return size >= sizeof(PNG_SIGNATURE) && memcmp(bytes, PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) == 0;
+	}
+
+	static bool decodeStb(const unsigned char* bytes, size_t size, Image& image, std::string& error) {
+		// the flip setting is thread local, whatever another caller left behind is reset
+		stbi_set_flip_vertically_on_load_thread(0);
+		unsigned char* pixels = stbi_load_from_memory(bytes, (int)size, &image.width, &image.height, &image.channels, 0);
+		if (!pixels) {
+			// the failure reason is thread local too
+			error = stbi_failure_reason();
+			return false;
+		}
+		image.pixels.assign(pixels, pixels + (size_t)image.width * image.height * image.channels);
+		stbi_image_free(pixels);
+		return true;
+	}
+
+#ifdef IMAGE_DECODER_LIBJPEG
+	// libjpeg calls exit() on errors unless error_exit jumps out
+	struct JpegError {
+		jpeg_error_mgr manager;
+		jmp_buf jump;
+		char message[JMSG_LENGTH_MAX];
+	};
+
+	static void onJpegError(j_common_ptr info) {
+		JpegError* jpegError = (JpegError*)info->err;
+		(*info->err->format_message)(info, jpegError->message);
+		longjmp(jpegError->jump, 1);
+	}
+
+	// corrupt data warnings would go to stderr, stb does not report them either
+	static void onJpegMessage(j_common_ptr) {}
+
+	static bool decodeLibjpeg(const unsigned char* bytes, size_t size, Image& image, std::string& error) {
+		jpeg_decompress_struct info;
+		JpegError jpegError;
+		info.err = jpeg_std_error(&jpegError.manager);
+		jpegError.manager.error_exit = onJpegError;
+		jpegError.manager.output_message = onJpegMessage;
+		// nothing with a destructor may be created below this point, the jump would skip it
+		if (setjmp(jpegError.jump)) {
+			jpeg_destroy_decompress(&info);
+			error = jpegError.message;
+			return false;
+		}
+		jpeg_create_decompress(&info);
+		jpeg_mem_src(&info, (unsigned char*)bytes, (unsigned long)size);
+		jpeg_read_header(&info, TRUE);
+		// libjpeg only passes CMYK through, stb converts it to RGB
+		if (info.jpeg_color_space == JCS_CMYK || info.jpeg_color_space == JCS_YCCK) {
+			jpeg_destroy_decompress(&info);
+			error = "CMYK JPEG";
+			return false;
+		}
+		info.out_color_space = info.num_components == 1 ? JCS_GRAYSCALE : JCS_RGB;
+		jpeg_start_decompress(&info);
+		image.width = (int)info.output_width;
+		image.height = (int)info.output_height;
+		image.channels = info.output_components;
+		size_t pitch = (size_t)image.width * image.channels;
+		image.pixels.resize(pitch * image.height);
+		while (info.output_scanline < info.output_height) {
+			// the decoder hands out up to rec_outbuf_height rows per call
+			JSAMPROW rows[4];
+			int count = 0;
+			for (; count < 4 && info.output_scanline + count < info.output_height; count++) {
+				rows[count] = image.pixels.data() + (info.output_scanline + count) * pitch;
+			}
+			jpeg_read_scanlines(&info, rows, count);
+		}
+		jpeg_finish_decompress(&info);
+		jpeg_destroy_decompress(&info);
+		return true;
+	}
+#endif
+
+#ifdef IMAGE_DECODER_SPNG
+	static bool decodeSpng(const unsigned char* bytes, size_t size, Image& image, std::string& error) {
+		spng_ctx* context = spng_ctx_new(0);
+		if (context == NULL) {
+			error = "out of memory";
+			return false;
+		}
+		spng_ihdr header;
+		int result = spng_set_png_buffer(context, bytes, size);
+		if (result == 0) {
+			result = spng_get_ihdr(context, &header);
+		}
+		if (result != 0) {
+			error = spng_strerror(result);
+			spng_ctx_free(context);
+			return false;
+		}
+		// libspng's grey output formats only cover some bit depths, stb takes those
+		if (header.color_type == SPNG_COLOR_TYPE_GRAYSCALE || header.color_type == SPNG_COLOR_TYPE_GRAYSCALE_ALPHA) {
+			error = "grey PNG";
+			spng_ctx_free(context);
+			return false;
+		}
+		spng_trns transparency;
+		bool alpha = header.color_type == SPNG_COLOR_TYPE_TRUECOLOR_ALPHA || spng_get_trns(context, &transparency) == 0;
+		int format = alpha ? SPNG_FMT_RGBA8 : SPNG_FMT_RGB8;
+		size_t imageSize = 0;
+		result = spng_decoded_image_size(context, format, &imageSize);
+		if (result == 0) {
+			image.width = (int)header.width;
+			image.height = (int)header.height;
+			image.channels = alpha ? 4 : 3;
+			image.pixels.resize(imageSize);
+			result = spng_decode_image(context, image.pixels.data(), imageSize, format, alpha ? SPNG_DECODE_TRNS : 0);
+		}
+		spng_ctx_free(context);
+		if (result != 0) {
+			error = spng_strerror(result);
+			return false;
+		}
+		return true;
+	}
+#endif
+
+#ifdef IMAGE_DECODER_LIBPNG
+	struct PngSource {
+		const unsigned char* bytes;
+		size_t size;
+		size_t offset;
+		char message[256];
+	};
+
+	static void readPng(png_structp png, png_bytep target, png_size_t length) {
+		PngSource* source = (PngSource*)png_get_io_ptr(png);
+		if (length > source->size - source->offset) {
+			png_error(png, "truncated");
+		}
+		memcpy(target, source->bytes + source->offset, length);
+		source->offset += length;
+	}
+
+	// libpng prints and jumps by default, the message is kept for the caller instead
+	static void onPngError(png_structp png, png_const_charp message) {
+		PngSource* source = (PngSource*)png_get_error_ptr(png);
+		std::snprintf(source->message, sizeof(source->message), "%s", message);
+		png_longjmp(png, 1);
+	}
+
+	static void onPngWarning(png_structp, png_const_charp) {}
+
+	static bool decodeLibpng(const unsigned char* bytes, size_t size, Image& image, std::string& error) {
+		PngSource source = { bytes, size, 0, "" };
+		png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, &source, onPngError, onPngWarning);
+		png_infop info = png ? png_create_info_struct(png) : NULL;
+		if (info == NULL) {
+			png_destroy_read_struct(&png, NULL, NULL);
+			error = "out of memory";
+			return false;
+		}
+		// created before the jump target, so an error does not skip the destructor
+		std::vector<png_bytep> rows;
+		if (setjmp(png_jmpbuf(png))) {
+			png_destroy_read_struct(&png, &info, NULL);
+			error = source.message;
+			return false;
+		}
+		png_set_read_fn(png, &source, readPng);
+		// stb does not verify the checksums either, they cost libpng a good part of its time
+		png_set_crc_action(png, PNG_CRC_QUIET_USE, PNG_CRC_QUIET_USE);
+#if defined(PNG_IGNORE_ADLER32)
+		png_set_option(png, PNG_IGNORE_ADLER32, PNG_OPTION_ON);
+#endif
+		png_read_info(png, info);
+		// palettes to RGB, low bit depths to 8 bits and tRNS to alpha, then 16 bit samples to their high byte like stb
+		png_set_expand(png);
+		png_set_strip_16(png);
+		png_set_interlace_handling(png);
+		png_read_update_info(png, info);
+		image.width = (int)png_get_image_width(png, info);
+		image.height = (int)png_get_image_height(png, info);
+		image.channels = png_get_channels(png, info);
+		size_t pitch = png_get_rowbytes(png, info);
+		image.pixels.resize(pitch * image.height);
+		rows.resize(image.height);
+		for (int y = 0; y < image.height; y++) {
+			rows[y] = image.pixels.data() + y * pitch;
+		}
+		png_read_image(png, rows.data());
+		png_read_end(png, NULL);
+		png_destroy_read_struct(&png, &info, NULL);
+		return true;
+	}
+#endif
+
+	bool isAvailable(Backend backend) {
+		switch (backend) {
+		case BACKEND_STB: return true;
+#ifdef IMAGE_DECODER_LIBJPEG
+		case BACKEND_LIBJPEG: return true;
+#endif
+#ifdef IMAGE_DECODER_SPNG
+		case BACKEND_SPNG: return true;
+#endif
+#ifdef IMAGE_DECODER_LIBPNG
+		case BACKEND_LIBPNG: return true;
+#endif
+		default: return false;
+		}
+	}
+
+	bool canDecode(Backend backend, const unsigned char* bytes, size_t size) {
+		if (!isAvailable(backend)) {
+			return false;
+		}
+		switch (backend) {
+		case BACKEND_STB: return true;
+		case BACKEND_LIBJPEG: return isJpeg(bytes, size);
+		default: return isPng(bytes, size);
+		}
+	}
+
+	Backend choose(const unsigned char* bytes, size_t size) {
+		// fastest first
+		const Backend preferred[] = { BACKEND_LIBJPEG, BACKEND_SPNG, BACKEND_LIBPNG };
+		for (Backend backend : preferred) {
+			if (canDecode(backend, bytes, size)) {
+				return backend;
+			}
+		}
+		return BACKEND_STB;
+	}
+
+	bool decode(const unsigned char* bytes, size_t size, Image& image, std::string& error) {
+		Backend backend = choose(bytes, size);
+		if (backend != BACKEND_STB && decode(backend, bytes, size, image, error)) {
+			return true;
+		}
+		return decode(BACKEND_STB, bytes, size, image, error);
+	}
+
+	bool decode(Backend backend, const unsigned char* bytes, size_t size, Image& image, std::string& error) {
+		image = Image();
+		if (!canDecode(backend, bytes, size)) {
+			error = std::string(getName(backend)) + " can not decode this file";
+			return false;
+		}
+		bool decoded = false;
+		switch (backend) {
+		case BACKEND_STB: decoded = decodeStb(bytes, size, image, error); break;
+#ifdef IMAGE_DECODER_LIBJPEG
+		case BACKEND_LIBJPEG: decoded = decodeLibjpeg(bytes, size, image, error); break;
+#endif
+#ifdef IMAGE_DECODER_SPNG
+		case BACKEND_SPNG: decoded = decodeSpng(bytes, size, image, error); break;
+#endif
+#ifdef IMAGE_DECODER_LIBPNG
+		case BACKEND_LIBPNG: decoded = decodeLibpng(bytes, size, image, error); break;
+#endif
+		default: break;
+		}
+		if (!decoded) {
+			image = Image();
+		}
+		return decoded;
+	}
+
+	bool load(const std::string& path, Image& image, std::string& error) {
+		MappedFile file;
+		if (!file.open(path.c_str())) {
+			error = "can't open";
+			return false;
+		}
+		return decode(file.data(), file.size(), image, error);
+	}
+
+	void expandToRgba(Image& image) {
+		if (image.channels == 4) {
+			return;
+		}
+		size_t texels = (size_t)image.width * image.height;
+		std::vector<unsigned char> rgba(texels * 4);
+		if (image.channels == 3) {
+			PixelConverter::Options options;
+			options.expandRgb = true;
+			PixelConverter::convert(image.pixels.data(), image.width, image.height, 3, options, rgba.data());
+		}
+		else {
+			// grey is copied into R, G and B
+			for (size_t i = 0; i < texels; i++) {
+				const unsigned char* source = image.pixels.data() + i * image.channels;
+				rgba[i * 4] = rgba[i * 4 + 1] = rgba[i * 4 + 2] = source[0];
+				rgba[i * 4 + 3] = image.channels == 2 ? source[1] : 255;
+			}
+		}
+		image.pixels.swap(rgba);
+		image.channels = 4;
+	}
+
+	const char* getName(Backend backend) {
+		switch (backend) {
+		case BACKEND_STB: return "stb_image";
+		case BACKEND_LIBJPEG: return "libjpeg-turbo";
+		case BACKEND_SPNG: return "libspng";
+		case BACKEND_LIBPNG: return "libpng";
+		default: return "unknown";
+		}
+	}
+}
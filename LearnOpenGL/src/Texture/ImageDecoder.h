@@ -0,0 +1,59 @@
+#ifndef IMAGE_DECODER_H
+#define IMAGE_DECODER_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// decodes JPEG and PNG files with the fastest codec the build found, stb_image everywhere else and as the fallback.
+// the build system enables each codec it links with a define: IMAGE_DECODER_WITH_LIBJPEG for libjpeg-turbo (through
+// the libjpeg API of jpeglib.h, -ljpeg) and IMAGE_DECODER_WITH_SPNG for libspng (-lspng). CMake sets them when it
+// finds the libraries, the Visual Studio project through its ImageDecoderDefinitions macro. the libspng backend is
+// experimental and off by default: it has not been built and checked against stb_image (--benchmark decoders) yet. libpng decodes no faster
+// than stb_image, it is only built with IMAGE_DECODER_WITH_LIBPNG (and -lpng) to compare it in the benchmark.
+// every backend fills Image the same way:
+//  - tightly packed rows, top row first, 8 bits per channel (16 bit PNG samples keep their high byte)
+//  - the file's channels: 1 grey, 2 grey + alpha, 3 RGB, 4 RGBA. palettes expand to RGB, transparency chunks add alpha
+//  - no gamma or colour profile is applied
+// lossless formats decode to the same bytes on every backend. JPEG decoders differ in their IDCT and chroma
+// upsampling, their pixels may be a few levels apart
+namespace ImageDecoder {
+
+	enum Backend {
+		BACKEND_STB,
+		BACKEND_LIBJPEG,
+		BACKEND_SPNG,
+		BACKEND_LIBPNG,
+		BACKEND_COUNT
+	};
+
+	struct Image {
+		int width = 0;
+		int height = 0;
+		int channels = 0;
+		std::vector<unsigned char> pixels;
+	};
+
+	// true if the backend was compiled in, stb always is
+	bool isAvailable(Backend backend);
+	// true if the backend reads the file these bytes start with
+	bool canDecode(Backend backend, const unsigned char* bytes, size_t size);
+	// the backend decode() uses for these bytes
+	Backend choose(const unsigned char* bytes, size_t size);
+
+	// decodes with choose(), retrying with stb when a system codec refuses the file (CMYK JPEGs, grey PNGs for
+	// libspng, ...). thread safe
+	bool decode(const unsigned char* bytes, size_t size, Image& image, std::string& error);
+	// decodes with this backend only, false if it is not available or can not read the file
+	bool decode(Backend backend, const unsigned char* bytes, size_t size, Image& image, std::string& error);
+	// maps the file and decodes it
+	bool load(const std::string& path, Image& image, std::string& error);
+
+	// grey, grey + alpha and RGB images to RGBA, the way stb_image's req_comp 4 does it
+	void expandToRgba(Image& image);
+
+	const char* getName(Backend backend);
+
+}
+
+#endif // IMAGE_DECODER_H
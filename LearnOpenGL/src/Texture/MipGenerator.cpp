@@ -0,0 +1,277 @@
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "MipGenerator.h"
+#include "PixelConverter.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIP_GENERATOR_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace MipGenerator {
+
+	// in target texels
+	static const float KAISER_RADIUS = 2.0f;
+	static const float KAISER_ALPHA = 4.0f;
+	// rows per task of each pass
+	static const int BAND_ROWS = 16;
+
+	// working images keep four floats per texel whatever the channel count, one SSE register each
+	typedef std::vector<float> FloatImage;
+
+	// which source texels make up each target texel along one axis, with the edge addressing already applied
+	struct AxisFilter {
+		// target texel i uses taps starts[i] up to starts[i + 1]
+		std::vector<size_t> starts;
+		std::vector<int> indices;
+		std::vector<float> weights;
+	};
+
+	// linear to sRGB conversion for 8 bit values, the other way is PixelConverter's table
+	struct EncodeTable {
+		// linear value halfway between code k and k + 1 in encoded space, rounding to the nearest code is a search
+		float thresholds[255];
+
+		EncodeTable() {
+			for (int i = 0; i < 255; i++) {
+				float value = (i + 0.5f) / 255.0f;
+				thresholds[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+			}
+		}
+	};
+
+	static const EncodeTable& getEncodeTable() {
+		static const EncodeTable table;
+		return table;
+	}
+
+	static float sinc(float x) {
+		if (std::fabs(x) < 1e-6f) {
+			return 1.0f;
+		}
+		const float pi = 3.14159265358979f;
+		return std::sin(pi * x) / (pi * x);
+	}
+
+	// zeroth order modified Bessel function of the first kind, the series converges quickly for the alpha used
+	static float bessel0(float x) {
+		float sum = 1.0f;
+		float term = 1.0f;
+		for (int k = 1; k < 32; k++) {
+			term *= (x / (2.0f * k)) * (x / (2.0f * k));
+			sum += term;
+			if (term < sum * 1e-8f) {
+				break;
+			}
+		}
+		return sum;
+	}
+
+	// x in [-1, 1]
+	static float kaiser(float x) {
+		return bessel0(KAISER_ALPHA * std::sqrt(std::max(0.0f, 1.0f - x * x))) / bessel0(KAISER_ALPHA);
+	}
+
+	static int address(int index, int size, GLenum wrap) {
+		if (wrap == GL_REPEAT) {
+			return ((index % size) + size) % size;
+		}
+		if (wrap == GL_MIRRORED_REPEAT) {
+			int period = 2 * size;
+			int position = ((index % period) + period) % period;
+			return position < size ? position : period - 1 - position;
+		}
+		return std::min(std::max(index, 0), size - 1);
+	}
+
+	static void makeAxisFilter(int sourceSize, int targetSize, Filter filter, GLenum wrap, AxisFilter& axis) {
+		axis.starts.assign(1, 0);
+		axis.indices.clear();
+		axis.weights.clear();
+		float ratio = (float)sourceSize / targetSize;
+		for (int i = 0; i < targetSize; i++) {
+			size_t start = axis.weights.size();
+			if (sourceSize == targetSize) {
+				// an axis that is already 1 texel wide is copied
+				axis.indices.push_back(i);
+				axis.weights.push_back(1.0f);
+			}
+			else {
+				// source texel j covers [j, j + 1]
+				float center = (i + 0.5f) * ratio;
+				float support = filter == FILTER_BOX ? ratio * 0.5f : KAISER_RADIUS * ratio;
+				int first = (int)std::floor(center - support);
+				int last = (int)std::ceil(center + support) - 1;
+				float sum = 0.0f;
+				for (int j = first; j <= last; j++) {
+					float weight;
+					if (filter == FILTER_BOX) {
+						weight = std::min(j + 1.0f, center + support) - std::max((float)j, center - support);
+					}
+					else {
+						float x = (j + 0.5f - center) / ratio;
+						weight = std::fabs(x) < KAISER_RADIUS ? sinc(x) * kaiser(x / KAISER_RADIUS) : 0.0f;
+					}
+					if (weight == 0.0f) {
+						continue;
+					}
+					axis.indices.push_back(address(j, sourceSize, wrap));
+					axis.weights.push_back(weight);
+					sum += weight;
+				}
+				for (size_t k = start; k < axis.weights.size(); k++) {
+					axis.weights[k] /= sum;
+				}
+			}
+			axis.starts.push_back(axis.weights.size());
+		}
+	}
+
+	// target[i] = sum of weight * source[index] over the taps, four floats at a time
+	static inline void accumulate(const float* source, float weight, float* target) {
+#ifdef MIP_GENERATOR_SSE
+		_mm_storeu_ps(target, _mm_add_ps(_mm_loadu_ps(target), _mm_mul_ps(_mm_loadu_ps(source), _mm_set1_ps(weight))));
+#else
+		for (int c = 0; c < 4; c++) {
+			target[c] += source[c] * weight;
+		}
+#endif
+	}
+
+	// source width x height into target targetWidth x height
+	static void filterRows(const FloatImage& source, int width, int height, const AxisFilter& axis, int targetWidth, FloatImage& target, ThreadPool& pool) {
+		target.assign((size_t)targetWidth * height * 4, 0.0f);
+		size_t bands = (size_t)(height + BAND_ROWS - 1) / BAND_ROWS;
+		pool.run(bands, [&](size_t band) {
+			int end = std::min(height, (int)(band + 1) * BAND_ROWS);
+			for (int y = (int)band * BAND_ROWS; y < end; y++) {
+				const float* sourceRow = source.data() + (size_t)y * width * 4;
+				float* targetTexel = target.data() + (size_t)y * targetWidth * 4;
+				for (int x = 0; x < targetWidth; x++, targetTexel += 4) {
+					for (size_t k = axis.starts[x]; k < axis.starts[x + 1]; k++) {
+						accumulate(sourceRow + (size_t)axis.indices[k] * 4, axis.weights[k], targetTexel);
+					}
+				}
+			}
+		});
+	}
+
+	// source width x height into target width x targetHeight, whole rows at a time
+	static void filterColumns(const FloatImage& source, int width, const AxisFilter& axis, int targetHeight, FloatImage& target, ThreadPool& pool) {
+		target.assign((size_t)width * targetHeight * 4, 0.0f);
+		size_t bands = (size_t)(targetHeight + BAND_ROWS - 1) / BAND_ROWS;
+		pool.run(bands, [&](size_t band) {
+			int end = std::min(targetHeight, (int)(band + 1) * BAND_ROWS);
+			for (int y = (int)band * BAND_ROWS; y < end; y++) {
+				float* targetRow = target.data() + (size_t)y * width * 4;
+				for (size_t k = axis.starts[y]; k < axis.starts[y + 1]; k++) {
+					const float* sourceRow = source.data() + (size_t)axis.indices[k] * width * 4;
+					for (int x = 0; x < width; x++) {
+						accumulate(sourceRow + (size_t)x * 4, axis.weights[k], targetRow + (size_t)x * 4);
+					}
+				}
+			}
+		});
+	}
+
+	bool isSimd() {
+#ifdef MIP_GENERATOR_SSE
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	bool generate(TextureData& data, const Options& options, ThreadPool& pool) {
+		int channels;
+		switch (data.format) {
+		case GL_RED: channels = 1; break;
+		case GL_RG: channels = 2; break;
+		case GL_RGB: channels = 3; break;
+		// the colour channels are filtered alike, their order does not matter
+		case GL_RGBA:
+		case GL_BGRA: channels = 4; break;
+		default: return false;
+		}
+		if (data.compressed || data.levels.size() != 1) {
+			return false;
+		}
+		const float* toLinear = PixelConverter::getSrgbToLinearTable();
+		const EncodeTable& encode = getEncodeTable();
+		// grey (+ alpha) images keep their colour in the first channel
+		int colorChannels = channels <= 2 ? 1 : 3;
+		bool srgb = options.colorSpace == COLOR_SPACE_SRGB;
+		// alpha is the last of two or four channels, BGRA included
+		int alphaChannel = channels == 2 || channels == 4 ? channels - 1 : -1;
+		bool premultiply = alphaChannel >= 0 && !options.premultiplied;
+
+		// the chain, level 0 stays where it is
+		std::vector<TextureLevel> levels = data.levels;
+		size_t total = data.levels[0].offset + data.levels[0].size;
+		int width = data.width;
+		int height = data.height;
+		while (width > 1 || height > 1) {
+			width = std::max(1, width / 2);
+			height = std::max(1, height / 2);
+			size_t size = (size_t)width * height * channels;
+			levels.push_back(TextureLevel{ total, size, width, height });
+			total += size;
+		}
+		data.bytes.resize(total);
+
+		FloatImage current((size_t)data.width * data.height * 4, 0.0f);
+		const unsigned char* texel = data.bytes.data() + data.levels[0].offset;
+		for (size_t i = 0; i < (size_t)data.width * data.height; i++) {
+			float* value = &current[i * 4];
+			for (int c = 0; c < channels; c++, texel++) {
+				value[c] = c < colorChannels && srgb ? toLinear[*texel] : *texel / 255.0f;
+			}
+			if (premultiply) {
+				for (int c = 0; c < colorChannels; c++) {
+					value[c] *= value[alphaChannel];
+				}
+			}
+		}
+
+		FloatImage rows, next;
+		AxisFilter axis;
+		for (size_t level = 1; level < levels.size(); level++) {
+			const TextureLevel& source = levels[level - 1];
+			const TextureLevel& target = levels[level];
+			makeAxisFilter(source.width, target.width, options.filter, options.wrapS, axis);
+			filterRows(current, source.width, source.height, axis, target.width, rows, pool);
+			makeAxisFilter(source.height, target.height, options.filter, options.wrapT, axis);
+			filterColumns(rows, target.width, axis, target.height, next, pool);
+			current.swap(next);
+
+			// the next level filters the floats, only the stored copy is rounded
+			unsigned char* out = data.bytes.data() + target.offset;
+			for (size_t i = 0; i < (size_t)target.width * target.height; i++) {
+				// the Kaiser filter's negative lobes can leave the range
+				float alpha = alphaChannel >= 0 ? std::min(std::max(current[i * 4 + alphaChannel], 0.0f), 1.0f) : 1.0f;
+				for (int c = 0; c < channels; c++) {
+					float value = current[i * 4 + c];
+					if (premultiply && c < colorChannels) {
+						// no colour survives where nothing is covered
+						value = alpha > 0.0f ? value / alpha : 0.0f;
+					}
+					value = std::min(std::max(value, 0.0f), 1.0f);
+					if (c < colorChannels && srgb) {
+						*out++ = (unsigned char)(std::upper_bound(encode.thresholds, encode.thresholds + 255, value) - encode.thresholds);
+					}
+					else {
+						*out++ = (unsigned char)(value * 255.0f + 0.5f);
+					}
+				}
+			}
+		}
+		data.levels = levels;
+		return true;
+	}
+
+	const char* getName(Filter filter) {
+		return filter == FILTER_BOX ? "box" : "kaiser";
+	}
+}
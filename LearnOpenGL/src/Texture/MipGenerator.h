@@ -0,0 +1,46 @@
+#ifndef MIP_GENERATOR_H
+#define MIP_GENERATOR_H
+
+#include <glad/glad.h>
+
+#include "TextureData.h"
+#include "../Utility/ThreadPool.h"
+
+// builds mip chains on the CPU, so their quality and cost no longer depend on the driver's glGenerateMipmap
+// (usually a plain box filter on the stored values). every level is filtered from the previous one as floats,
+// sRGB colour channels in linear light and weighted by alpha, and only rounded back to 8 bits for storage. each pass
+// is split into bands of rows over the pool
+namespace MipGenerator {
+
+	enum Filter {
+		// average of the texels a target texel covers, the cheapest
+		FILTER_BOX,
+		// Kaiser windowed sinc over two target texels each side, sharper without visible ringing
+		FILTER_KAISER
+	};
+
+	struct Options {
+		Filter filter = FILTER_KAISER;
+		// of the colour channels (R of one and two channel images, RGB otherwise). sRGB ones are filtered in linear
+		// light, alpha is always linear
+		ColorSpace colorSpace = COLOR_SPACE_LINEAR;
+		// the colour channels are already multiplied by alpha. otherwise they are multiplied for filtering and divided
+		// again for storage, so fully transparent texels (the outside of a cutout) add nothing to their neighbours
+		bool premultiplied = false;
+		// how the filter reads past the edges, like the sampler will: GL_REPEAT, GL_MIRRORED_REPEAT or clamping
+		GLenum wrapS = GL_CLAMP_TO_EDGE;
+		GLenum wrapT = GL_CLAMP_TO_EDGE;
+	};
+
+	// true when the filter taps use SSE
+	bool isSimd();
+
+	// replaces the single 8 bit level of data (R, RG, RGB, RGBA or BGRA) with the full chain down to 1x1.
+	// false and data unchanged if it is compressed or already has more levels
+	bool generate(TextureData& data, const Options& options, ThreadPool& pool = ThreadPool::shared());
+
+	const char* getName(Filter filter);
+
+}
+
+#endif // MIP_GENERATOR_H
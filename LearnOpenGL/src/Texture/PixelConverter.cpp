@@ -0,0 +1,188 @@
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#include "PixelConverter.h"
+#include "../Utility/GLExtensions.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PIXEL_CONVERTER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace PixelConverter {
+
+	struct LinearTable {
+		float values[256];
+
+		LinearTable() {
+			for (int i = 0; i < 256; i++) {
+				float value = i / 255.0f;
+				values[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+			}
+		}
+	};
+
+	// round(value * alpha / 255) without a division
+	static inline unsigned char multiplyAlpha(unsigned int value, unsigned int alpha) {
+		unsigned int product = value * alpha + 128;
+		return (unsigned char)((product + (product >> 8)) >> 8);
+	}
+
+	// one row, texels from x on
+	static void convertRowScalar(const unsigned char* source, int x, int width, int channels, const Options& options, unsigned char* target) {
+		int targetChannels = getChannels(channels, options);
+		source += (size_t)x * channels;
+		target += (size_t)x * targetChannels;
+		bool swap = options.bgra && channels >= 3;
+		bool premultiply = options.premultiply && channels == 4;
+		for (; x < width; x++, source += channels, target += targetChannels) {
+			for (int c = 0; c < channels; c++) {
+				target[c] = source[c];
+			}
+			if (targetChannels > channels) {
+				target[3] = 255;
+			}
+			if (premultiply) {
+				for (int c = 0; c < 3; c++) {
+					target[c] = multiplyAlpha(target[c], source[3]);
+				}
+			}
+			if (swap) {
+				std::swap(target[0], target[2]);
+			}
+		}
+	}
+
+#ifdef PIXEL_CONVERTER_SSE2
+	// R and B of four RGBA texels swapped
+	static inline __m128i swapRedBlue(__m128i texels) {
+		__m128i greenAlpha = _mm_and_si128(texels, _mm_set1_epi32((int)0xFF00FF00u));
+		__m128i redBlue = _mm_and_si128(texels, _mm_set1_epi32(0x00FF00FF));
+		redBlue = _mm_or_si128(_mm_slli_epi32(redBlue, 16), _mm_srli_epi32(redBlue, 16));
+		// the shifts drop whatever leaves the 32 bit lane, R lands in byte 2 and B in byte 0
+		return _mm_or_si128(greenAlpha, redBlue);
+	}
+
+	// two RGBA texels widened to 16 bits, colour times alpha with the same rounding as multiplyAlpha
+	static inline __m128i premultiplyWide(__m128i texels) {
+		__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(texels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		// alpha itself is multiplied by 255, which leaves it unchanged
+		const __m128i alphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+		alpha = _mm_or_si128(_mm_andnot_si128(alphaLanes, alpha), _mm_and_si128(alphaLanes, _mm_set1_epi16(255)));
+		__m128i product = _mm_add_epi16(_mm_mullo_epi16(texels, alpha), _mm_set1_epi16(128));
+		return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+	}
+
+	// four texels per step, the scalar code finishes the row. returns the first texel it did not convert
+	static int convertRowSse2(const unsigned char* source, int width, int channels, const Options& options, unsigned char* target) {
+		int x = 0;
+		if (channels == 3 && options.expandRgb) {
+			const __m128i opaque = _mm_set1_epi32((int)0xFF000000u);
+			// 16 byte loads read 4 bytes past the 4 texels, the last texels of the row are left to the scalar code
+			for (; x + 6 <= width; x += 4) {
+				__m128i bytes = _mm_loadu_si128((const __m128i*)(source + (size_t)x * 3));
+				// texel k starts at byte 3k, shifting puts each one into the low lane
+				__m128i texels01 = _mm_unpacklo_epi32(bytes, _mm_srli_si128(bytes, 3));
+				__m128i texels23 = _mm_unpacklo_epi32(_mm_srli_si128(bytes, 6), _mm_srli_si128(bytes, 9));
+				__m128i texels = _mm_or_si128(_mm_unpacklo_epi64(texels01, texels23), opaque);
+				if (options.bgra) {
+					texels = swapRedBlue(texels);
+				}
+				_mm_storeu_si128((__m128i*)(target + (size_t)x * 4), texels);
+			}
+		}
+		else if (channels == 4 && (options.bgra || options.premultiply)) {
+			const __m128i zero = _mm_setzero_si128();
+			for (; x + 4 <= width; x += 4) {
+				__m128i texels = _mm_loadu_si128((const __m128i*)(source + (size_t)x * 4));
+				if (options.premultiply) {
+					__m128i low = premultiplyWide(_mm_unpacklo_epi8(texels, zero));
+					__m128i high = premultiplyWide(_mm_unpackhi_epi8(texels, zero));
+					texels = _mm_packus_epi16(low, high);
+				}
+				if (options.bgra) {
+					texels = swapRedBlue(texels);
+				}
+				_mm_storeu_si128((__m128i*)(target + (size_t)x * 4), texels);
+			}
+		}
+		return x;
+	}
+#endif
+
+	bool isSimd() {
+#ifdef PIXEL_CONVERTER_SSE2
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	int getChannels(int channels, const Options& options) {
+		return channels == 3 && options.expandRgb ? 4 : channels;
+	}
+
+	void convert(const unsigned char* pixels, int width, int height, int channels, const Options& options, unsigned char* target, bool simd) {
+		int targetChannels = getChannels(channels, options);
+		size_t sourcePitch = (size_t)width * channels;
+		size_t targetPitch = (size_t)width * targetChannels;
+		// nothing but the row order changes
+		bool copy = targetChannels == channels && !(options.bgra && channels >= 3) && !(options.premultiply && channels == 4);
+		for (int y = 0; y < height; y++) {
+			const unsigned char* source = pixels + (size_t)y * sourcePitch;
+			unsigned char* row = target + (size_t)(options.flip ? height - 1 - y : y) * targetPitch;
+			if (copy) {
+				memcpy(row, source, sourcePitch);
+				continue;
+			}
+			int x = 0;
+#ifdef PIXEL_CONVERTER_SSE2
+			if (simd) {
+				x = convertRowSse2(source, width, channels, options, row);
+			}
+#endif
+			convertRowScalar(source, x, width, channels, options, row);
+		}
+	}
+
+	void flipRows(unsigned char* pixels, size_t rowBytes, int rows) {
+		std::vector<unsigned char> scratch(rowBytes);
+		for (int top = 0, bottom = rows - 1; top < bottom; top++, bottom--) {
+			unsigned char* first = pixels + (size_t)top * rowBytes;
+			unsigned char* last = pixels + (size_t)bottom * rowBytes;
+			memcpy(scratch.data(), first, rowBytes);
+			memcpy(first, last, rowBytes);
+			memcpy(last, scratch.data(), rowBytes);
+		}
+	}
+
+	const float* getSrgbToLinearTable() {
+		static const LinearTable table;
+		return table.values;
+	}
+
+	void srgbToLinear(const unsigned char* values, size_t count, float* target) {
+		// a gather per value is all SIMD could do here, the table lookup is as fast
+		const float* table = getSrgbToLinearTable();
+		for (size_t i = 0; i < count; i++) {
+			target[i] = table[values[i]];
+		}
+	}
+
+	UploadFormat queryUploadFormat() {
+		UploadFormat format;
+		if ((GLExtensions::hasVersion(4, 3) || GLExtensions::has("GL_ARB_internalformat_query2"))
+			&& GLExtensions::loadProc(glad_glGetInternalformativ, "glGetInternalformativ")) {
+			GLint preferred = 0;
+			glGetInternalformativ(GL_TEXTURE_2D, GL_RGB8, GL_INTERNALFORMAT_PREFERRED, 1, &preferred);
+			format.expandRgb = preferred != GL_RGB8;
+			GLint imageFormat = 0;
+			glGetInternalformativ(GL_TEXTURE_2D, GL_RGBA8, GL_TEXTURE_IMAGE_FORMAT, 1, &imageFormat);
+			format.bgra = imageFormat == GL_BGRA;
+		}
+		return format;
+	}
+
+}
@@ -0,0 +1,56 @@
+#ifndef PIXEL_CONVERTER_H
+#define PIXEL_CONVERTER_H
+
+#include <cstddef>
+
+#include <glad/glad.h>
+
+// reshapes decoded 8 bit images into the layout they are uploaded in: OpenGL's bottom row first order, RGB expanded
+// to RGBA, R and B swapped for GL_BGRA and colour premultiplied by alpha, all in one pass over the rows. every
+// conversion has a scalar reference and an SSE2 version that produce the same bytes
+namespace PixelConverter {
+
+	struct Options {
+		// RGB sources get an opaque alpha channel
+		bool expandRgb = false;
+		// R and B swapped, for GL_BGRA / GL_BGR uploads
+		bool bgra = false;
+		// colour multiplied by alpha, rounded, on four channel output. done on the stored values, the same as
+		// blending with GL_ONE, GL_ONE_MINUS_SRC_ALPHA would expect
+		bool premultiply = false;
+		// the last row goes first, turning images stored top row first into the order OpenGL samples
+		bool flip = false;
+	};
+
+	// what the driver likes to be given, read through GL_INTERNALFORMAT_PREFERRED / GL_TEXTURE_IMAGE_FORMAT
+	struct UploadFormat {
+		// RGB8 is stored as RGBA8 anyway, uploading RGBA skips the driver's own (often slow) expansion
+		bool expandRgb = true;
+		// RGBA8 wants GL_BGRA client data
+		bool bgra = false;
+	};
+
+	// true when the conversions use SSE2
+	bool isSimd();
+
+	// channel count of the converted image
+	int getChannels(int channels, const Options& options);
+
+	// converts width x height tightly packed texels of channels bytes into target, which holds getChannels() bytes per
+	// texel and must not overlap pixels. simd false runs the scalar reference
+	void convert(const unsigned char* pixels, int width, int height, int channels, const Options& options, unsigned char* target, bool simd = true);
+
+	// reverses the order of the rows in place
+	void flipRows(unsigned char* pixels, size_t rowBytes, int rows);
+
+	// 256 linear values for the 8 bit sRGB encoded ones
+	const float* getSrgbToLinearTable();
+	// count sRGB encoded values to linear floats
+	void srgbToLinear(const unsigned char* values, size_t count, float* target);
+
+	// asks the current context, call on the GL thread. falls back to the defaults without ARB_internalformat_query2
+	UploadFormat queryUploadFormat();
+
+}
+
+#endif // PIXEL_CONVERTER_H
@@ -0,0 +1,95 @@
+#include <algorithm>
+
+#include "SkylinePacker.h"
+
+// constructor
+SkylinePacker::SkylinePacker(int width, int height) : width(width), height(height), usedArea(0) {
+	reset();
+}
+
+void SkylinePacker::reset() {
+	skyline.assign(1, Segment{ 0, 0, width });
+	usedArea = 0;
+}
+
+int SkylinePacker::fit(size_t index, int rectWidth, int rectHeight) const {
+	if (skyline[index].x + rectWidth > width) {
+		return -1;
+	}
+	// the rectangle rests on the highest segment below it
+	int y = 0;
+	int remaining = rectWidth;
+	for (size_t i = index; remaining > 0; i++) {
+		y = std::max(y, skyline[i].y);
+		if (y + rectHeight > height) {
+			return -1;
+		}
+		remaining -= skyline[i].width;
+	}
+	return y;
+}
+
+bool SkylinePacker::insert(int rectWidth, int rectHeight, int& x, int& y) {
+	if (rectWidth <= 0 || rectHeight <= 0) {
+		return false;
+	}
+	size_t best = skyline.size();
+	int bestTop = 0;
+	int bestY = 0;
+	for (size_t i = 0; i < skyline.size(); i++) {
+		int top = fit(i, rectWidth, rectHeight);
+		if (top < 0) {
+			continue;
+		}
+		if (best == skyline.size() || top + rectHeight < bestTop ||
+			(top + rectHeight == bestTop && skyline[i].width < skyline[best].width)) {
+			best = i;
+			bestTop = top + rectHeight;
+			bestY = top;
+		}
+	}
+	if (best == skyline.size()) {
+		return false;
+	}
+	x = skyline[best].x;
+	y = bestY;
+	usedArea += (long long)rectWidth * rectHeight;
+
+	// the new segment covers the rectangle's top, the ones it shadows are cut back or dropped
+	skyline.insert(skyline.begin() + best, Segment{ x, bestTop, rectWidth });
+	for (size_t i = best + 1; i < skyline.size();) {
+		int covered = skyline[i - 1].x + skyline[i - 1].width - skyline[i].x;
+		if (covered <= 0) {
+			break;
+		}
+		skyline[i].x += covered;
+		skyline[i].width -= covered;
+		if (skyline[i].width > 0) {
+			break;
+		}
+		skyline.erase(skyline.begin() + i);
+	}
+	// neighbours at the same height become one segment
+	for (size_t i = 0; i + 1 < skyline.size();) {
+		if (skyline[i].y == skyline[i + 1].y) {
+			skyline[i].width += skyline[i + 1].width;
+			skyline.erase(skyline.begin() + i + 1);
+		}
+		else {
+			i++;
+		}
+	}
+	return true;
+}
+
+int SkylinePacker::getWidth() const {
+	return width;
+}
+
+int SkylinePacker::getHeight() const {
+	return height;
+}
+
+float SkylinePacker::getOccupancy() const {
+	return (float)((double)usedArea / ((double)width * height));
+}
@@ -0,0 +1,43 @@
+#ifndef SKYLINE_PACKER_H
+#define SKYLINE_PACKER_H
+
+#include <vector>
+
+// places rectangles into a fixed size area, bottom left first. the free space is tracked as a skyline: the
+// height of the highest placed rectangle along x, kept as horizontal segments. each rectangle goes to the lowest
+// position it fits at, ties go to the narrowest segment. space hidden below the skyline is never reused, which
+// costs a few percent against maxrects but keeps insertion linear in the number of segments
+class SkylinePacker {
+private:
+	struct Segment {
+		int x;
+		int y;
+		int width;
+	};
+
+	int width;
+	int height;
+	std::vector<Segment> skyline;
+	long long usedArea;
+
+	// y a rectangle resting on the skyline from segment index on would be placed at, -1 if it does not fit
+	int fit(size_t index, int rectWidth, int rectHeight) const;
+
+public:
+	// constructor
+	SkylinePacker(int width, int height);
+
+	// finds a place for the rectangle and reserves it, false if it fits nowhere
+	bool insert(int rectWidth, int rectHeight, int& x, int& y);
+
+	// empties the area again
+	void reset();
+
+	// getters
+	int getWidth() const;
+	int getHeight() const;
+	// fraction of the area covered by rectangles
+	float getOccupancy() const;
+};
+
+#endif // SKYLINE_PACKER_H
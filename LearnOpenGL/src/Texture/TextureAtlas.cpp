@@ -0,0 +1,230 @@
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+#include <glad/glad.h>
+
+#include "TextureAtlas.h"
+#include "SkylinePacker.h"
+#include "PixelConverter.h"
+#include "ImageDecoder.h"
+#include "../Renderer/GLState.h"
+
+// an image decoded to RGBA8 and where it goes
+struct AtlasImage {
+	std::vector<unsigned char> pixels;
+	int width = 0;
+	int height = 0;
+	std::string error;
+	int layer = 0;
+	// top left of its padded rectangle
+	int x = 0;
+	int y = 0;
+};
+
+static int alignUp(int value, int alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+// copies the image into the page at (x + padding, y + padding) and fills its rectangle of rectWidth x rectHeight
+// around it with the nearest edge texels
+static void blitPadded(const AtlasImage& image, int padding, int rectWidth, int rectHeight, unsigned char* page, int pageWidth) {
+	size_t rowBytes = (size_t)image.width * 4;
+	for (int row = 0; row < rectHeight; row++) {
+		int sourceRow = std::min(std::max(row - padding, 0), image.height - 1);
+		const unsigned char* source = image.pixels.data() + (size_t)sourceRow * rowBytes;
+		unsigned char* target = page + ((size_t)(image.y + row) * pageWidth + image.x) * 4;
+		for (int column = 0; column < padding; column++) {
+			memcpy(target + column * 4, source, 4);
+		}
+		memcpy(target + padding * 4, source, rowBytes);
+		for (int column = padding + image.width; column < rectWidth; column++) {
+			memcpy(target + column * 4, source + rowBytes - 4, 4);
+		}
+	}
+}
+
+// constructor
+TextureAtlas::TextureAtlas() : id(0), width(0), height(0), layers(0), uniform(true), bytes(0) {}
+
+// destructor
+TextureAtlas::~TextureAtlas() {
+	destroy();
+}
+
+void TextureAtlas::destroy() {
+	if (id != 0) {
+		GLState::deleteTexture(id);
+	}
+	id = 0;
+	width = height = layers = 0;
+	bytes = 0;
+	regions.clear();
+}
+
+bool TextureAtlas::build(const std::vector<std::string>& paths, int pageSize, int padding, ThreadPool& pool) {
+	destroy();
+	if (paths.empty()) {
+		return false;
+	}
+	std::vector<AtlasImage> images(paths.size());
+	pool.run(paths.size(), [&](size_t i) {
+		ImageDecoder::Image image;
+		if (ImageDecoder::load(paths[i], image, images[i].error)) {
+			// bottom row first like TextureManager, the rectangles are flipped in place so they do not move
+			ImageDecoder::expandToRgba(image);
+			PixelConverter::flipRows(image.pixels.data(), (size_t)image.width * 4, image.height);
+			images[i].width = image.width;
+			images[i].height = image.height;
+			images[i].pixels.swap(image.pixels);
+		}
+	});
+	for (size_t i = 0; i < images.size(); i++) {
+		if (images[i].pixels.empty()) {
+			std::cout << "ERROR::TEXTURE_ATLAS::LOAD_FAILED " << paths[i] << " (" << images[i].error << ")" << std::endl;
+			return false;
+		}
+	}
+
+	uniform = std::all_of(images.begin(), images.end(), [&](const AtlasImage& image) {
+		return image.width == images[0].width && image.height == images[0].height;
+	});
+	// mip level n averages 2^n texels, the padding keeps the first log2(padding) levels free of the neighbours
+	int maxLevel = 0;
+	while (!uniform && (2 << maxLevel) <= padding) {
+		maxLevel++;
+	}
+	int alignment = 1 << maxLevel;
+	std::vector<int> rectWidths(images.size()), rectHeights(images.size());
+
+	if (uniform) {
+		width = images[0].width;
+		height = images[0].height;
+		layers = (int)images.size();
+		for (size_t i = 0; i < images.size(); i++) {
+			images[i].layer = (int)i;
+		}
+	}
+	else {
+		// tallest first packs a skyline tightest
+		std::vector<size_t> order(images.size());
+		for (size_t i = 0; i < order.size(); i++) {
+			order[i] = i;
+		}
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			return images[a].height != images[b].height ? images[a].height > images[b].height : images[a].width > images[b].width;
+		});
+		std::vector<SkylinePacker> pages;
+		width = height = 0;
+		for (size_t i : order) {
+			AtlasImage& image = images[i];
+			// aligned sizes keep every rectangle on the mip grid
+			rectWidths[i] = alignUp(image.width + 2 * padding, alignment);
+			rectHeights[i] = alignUp(image.height + 2 * padding, alignment);
+			if (rectWidths[i] > pageSize || rectHeights[i] > pageSize) {
+				std::cout << "ERROR::TEXTURE_ATLAS::TOO_LARGE " << paths[i] << " does not fit a " << pageSize << " page" << std::endl;
+				return false;
+			}
+			bool placed = false;
+			for (size_t page = 0; page < pages.size() && !placed; page++) {
+				placed = pages[page].insert(rectWidths[i], rectHeights[i], image.x, image.y);
+				image.layer = (int)page;
+			}
+			if (!placed) {
+				pages.emplace_back(pageSize, pageSize);
+				pages.back().insert(rectWidths[i], rectHeights[i], image.x, image.y);
+				image.layer = (int)pages.size() - 1;
+			}
+			width = std::max(width, image.x + rectWidths[i]);
+			height = std::max(height, image.y + rectHeights[i]);
+		}
+		layers = (int)pages.size();
+	}
+
+	glGenTextures(1, &id);
+	GLState::bindTexture(0, GL_TEXTURE_2D_ARRAY, id);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, uniform ? GL_REPEAT : GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, uniform ? GL_REPEAT : GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, uniform || maxLevel > 0 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	if (uniform) {
+		for (size_t i = 0; i < images.size(); i++) {
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, (GLint)i, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, images[i].pixels.data());
+		}
+	}
+	else {
+		// every page is put together in memory, the gaps between rectangles stay transparent black
+		std::vector<unsigned char> page((size_t)width * height * 4);
+		for (int layer = 0; layer < layers; layer++) {
+			std::fill(page.begin(), page.end(), 0);
+			for (size_t i = 0; i < images.size(); i++) {
+				if (images[i].layer == layer) {
+					blitPadded(images[i], padding, rectWidths[i], rectHeights[i], page.data(), width);
+				}
+			}
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, page.data());
+		}
+	}
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, uniform ? 1000 : maxLevel);
+	if (uniform || maxLevel > 0) {
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+	}
+	bytes = (size_t)width * height * 4 * layers;
+	// a full mip chain adds a third, the packed one only its first levels
+	for (int level = 1, levelWidth = width, levelHeight = height; level <= (uniform ? 30 : maxLevel) && (levelWidth > 1 || levelHeight > 1); level++) {
+		levelWidth = std::max(1, levelWidth / 2);
+		levelHeight = std::max(1, levelHeight / 2);
+		bytes += (size_t)levelWidth * levelHeight * 4 * layers;
+	}
+
+	regions.resize(images.size());
+	for (size_t i = 0; i < images.size(); i++) {
+		Region& region = regions[i];
+		region.layer = images[i].layer;
+		region.width = images[i].width;
+		region.height = images[i].height;
+		if (!uniform) {
+			region.offset[0] = (float)(images[i].x + padding) / width;
+			region.offset[1] = (float)(images[i].y + padding) / height;
+			region.scale[0] = (float)images[i].width / width;
+			region.scale[1] = (float)images[i].height / height;
+		}
+	}
+	return true;
+}
+
+unsigned int TextureAtlas::getID() const {
+	return id;
+}
+
+const TextureAtlas::Region& TextureAtlas::getRegion(size_t index) const {
+	return regions[index];
+}
+
+size_t TextureAtlas::getRegionCount() const {
+	return regions.size();
+}
+
+int TextureAtlas::getLayerCount() const {
+	return layers;
+}
+
+bool TextureAtlas::isUniform() const {
+	return uniform;
+}
+
+size_t TextureAtlas::getSize() const {
+	return bytes;
+}
+
+void TextureAtlas::printStatistics() const {
+	long long imageArea = 0;
+	for (const Region& region : regions) {
+		imageArea += (long long)region.width * region.height;
+	}
+	double occupancy = layers > 0 ? (double)imageArea / ((double)width * height * layers) : 0.0;
+	std::cout << "Texture atlas: " << regions.size() << " images in " << layers << " layers of " << width << "x" << height
+		<< (uniform ? " (one image per layer" : " (packed") << ", " << (int)(occupancy * 100.0 + 0.5) << "% used), "
+		<< bytes / 1024 << " KB" << std::endl;
+}
@@ -0,0 +1,64 @@
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "../Utility/ThreadPool.h"
+
+// puts several images into the layers of one GL_TEXTURE_2D_ARRAY, so draws that use different images keep the
+// same binding and can be batched or instanced together; they pick their image through a layer and a texture
+// coordinate rectangle instead. images that all have the same size get a layer each and keep repeat wrapping.
+// mixed sizes are packed into pages (the layers) with a SkylinePacker, every image surrounded by padding texels
+// copied from its edge so filtering does not bleed in its neighbours. wrapping then clamps, and only the mip levels
+// the padding covers are kept
+class TextureAtlas {
+public:
+	// where an image ended up. texture coordinates in [0, 1] over the image map to offset + coordinate * scale
+	struct Region {
+		int layer = 0;
+		float offset[2] = { 0.0f, 0.0f };
+		float scale[2] = { 1.0f, 1.0f };
+		int width = 0;
+		int height = 0;
+	};
+
+private:
+	unsigned int id;
+	int width;
+	int height;
+	int layers;
+	// one image per layer, nothing packed
+	bool uniform;
+	size_t bytes;
+	std::vector<Region> regions;
+
+public:
+	// constructor
+	TextureAtlas();
+
+	// destructor
+	~TextureAtlas();
+
+	TextureAtlas(const TextureAtlas&) = delete;
+	TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+	// decodes the images on the pool (as RGBA8) and creates the array, replacing an earlier one. mixed sizes are
+	// packed into pages of at most pageSize x pageSize. false if an image failed to load or is larger than a page
+	bool build(const std::vector<std::string>& paths, int pageSize = 2048, int padding = 4, ThreadPool& pool = ThreadPool::shared());
+	void destroy();
+
+	// getters
+	unsigned int getID() const;
+	// in the order of the paths given to build()
+	const Region& getRegion(size_t index) const;
+	size_t getRegionCount() const;
+	int getLayerCount() const;
+	bool isUniform() const;
+	// GPU memory including the mip chain
+	size_t getSize() const;
+	void printStatistics() const;
+};
+
+#endif // TEXTURE_ATLAS_H
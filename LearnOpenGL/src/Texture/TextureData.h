@@ -0,0 +1,39 @@
+#ifndef TEXTURE_DATA_H
+#define TEXTURE_DATA_H
+
+#include <vector>
+#include <cstddef>
+
+#include <glad/glad.h>
+
+// how the colour channels of an 8 bit image are encoded. colour images (photos, albedo, UI) are sRGB, data stored in
+// an image (normals, roughness, masks, heights) is linear and must not be treated as light when it is filtered
+enum ColorSpace {
+	COLOR_SPACE_LINEAR,
+	COLOR_SPACE_SRGB
+};
+
+// one mip level inside TextureData::bytes
+struct TextureLevel {
+	size_t offset;
+	size_t size;
+	int width;
+	int height;
+};
+
+// a decoded or loaded 2D texture ready for upload, filled by the loaders on any thread
+struct TextureData {
+	int width = 0;
+	int height = 0;
+	// GL_COMPRESSED_* for block compressed data, otherwise a sized format like GL_RGBA8
+	GLenum internalFormat = 0;
+	// client format of uncompressed data (GL_RGBA, GL_BGRA, ...), unused when compressed
+	GLenum format = 0;
+	bool compressed = false;
+	std::vector<unsigned char> bytes;
+	// level 0 first, each bottom row first the way OpenGL addresses them. a single uncompressed level gets the rest
+	// of its chain from glGenerateMipmap
+	std::vector<TextureLevel> levels;
+};
+
+#endif // TEXTURE_DATA_H
@@ -0,0 +1,882 @@
+#include <iostream>
+#include <chrono>
+#include <utility>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <filesystem>
+#include <vector>
+
+#include "TextureManager.h"
+#include "CompressedTexture.h"
+#include "ImageDecoder.h"
+#include "../Renderer/GLState.h"
+#include "../Utility/GLExtensions.h"
+#include "../Utility/MappedFile.h"
+
+bool SamplerState::operator==(const SamplerState& other) const {
+	return wrapS == other.wrapS && wrapT == other.wrapT && minFilter == other.minFilter && magFilter == other.magFilter;
+}
+
+bool SamplerState::usesMipmaps() const {
+	return minFilter != GL_NEAREST && minFilter != GL_LINEAR;
+}
+
+// ============================== TextureHandle ==============================
+
+TextureHandle::TextureHandle(TextureManager* manager, unsigned int slot) : manager(manager), slot(slot) {
+	if (manager) {
+		manager->acquire(slot);
+	}
+}
+
+// constructor
+TextureHandle::TextureHandle() : manager(NULL), slot(0) {}
+
+TextureHandle::TextureHandle(const TextureHandle& other) : TextureHandle(other.manager, other.slot) {}
+
+TextureHandle::TextureHandle(TextureHandle&& other) noexcept : manager(other.manager), slot(other.slot) {
+	other.manager = NULL;
+}
+
+// destructor
+TextureHandle::~TextureHandle() {
+	reset();
+}
+
+TextureHandle& TextureHandle::operator=(const TextureHandle& other) {
+	if (this != &other) {
+		// acquire first, other may be the last reference besides this one
+		if (other.manager) {
+			other.manager->acquire(other.slot);
+		}
+		reset();
+		manager = other.manager;
+		slot = other.slot;
+	}
+	return *this;
+}
+
+TextureHandle& TextureHandle::operator=(TextureHandle&& other) noexcept {
+	if (this != &other) {
+		reset();
+		manager = other.manager;
+		slot = other.slot;
+		other.manager = NULL;
+	}
+	return *this;
+}
+
+void TextureHandle::reset() {
+	if (manager) {
+		manager->release(slot);
+		manager = NULL;
+	}
+}
+
+unsigned int TextureHandle::getID() const {
+	return manager ? manager->entries[slot].id : 0;
+}
+
+int TextureHandle::getWidth() const {
+	return manager ? manager->entries[slot].width : 0;
+}
+
+int TextureHandle::getHeight() const {
+	return manager ? manager->entries[slot].height : 0;
+}
+
+bool TextureHandle::isValid() const {
+	return getID() != 0;
+}
+
+bool TextureHandle::isResident() const {
+	return manager && manager->entries[slot].id != 0 && !manager->entries[slot].pending;
+}
+
+void TextureHandle::requestScreenSize(float width, float height) {
+	if (manager && width > 0.0f && height > 0.0f) {
+		TextureManager::Entry& entry = manager->entries[slot];
+		entry.requestedWidth = std::max(entry.requestedWidth, width);
+		entry.requestedHeight = std::max(entry.requestedHeight, height);
+	}
+}
+
+// ============================== TextureManager ==============================
+
+// grey, grey + alpha, RGB and RGBA images
+static const GLenum FORMATS[4] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+static const GLenum INTERNAL_FORMATS[4] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+
+// estimated texel size of an uncompressed format, drivers pad RGB8 texels to 4 bytes
+static size_t texelBytes(GLenum format) {
+	switch (format) {
+	case GL_RED: return 1;
+	case GL_RG: return 2;
+	default: return 4;
+	}
+}
+// bump whenever MipGenerator, BlockEncoder, PixelConverter or the cache layout change what a cached file holds
+static const unsigned int CACHE_VERSION = 4;
+// least recently used cache files beyond this are pruned
+static const uintmax_t MAX_CACHE_BYTES = 512ull * 1024 * 1024;
+// temporary files this old were left by a writer that crashed, younger ones may still be written
+static const std::chrono::minutes TEMPORARY_FILE_AGE(10);
+
+// 64 bit FNV-1a, like the program cache keys
+static unsigned long long hashBytes(unsigned long long hash, const void* data, size_t length) {
+	for (size_t i = 0; i < length; i++) {
+		hash ^= ((const unsigned char*)data)[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+// levels up to this size stay resident whatever the requests say, so a streamed texture always shows something
+static const int STREAM_TAIL_SIZE = 64;
+// how much of a level newly streamed levels fade in per frame
+static const float STREAM_FADE_PER_FRAME = 0.125f;
+
+// ARB_texture_storage, core in 4.2
+static bool hasTextureStorage() {
+	static const bool available = (GLExtensions::hasVersion(4, 2) || GLExtensions::has("GL_ARB_texture_storage"))
+		&& GLExtensions::loadProc(glad_glTexStorage2D, "glTexStorage2D");
+	return available;
+}
+
+// ARB_copy_image, core in 4.3
+static bool hasCopyImage() {
+	static const bool available = (GLExtensions::hasVersion(4, 3) || GLExtensions::has("GL_ARB_copy_image"))
+		&& GLExtensions::loadProc(glad_glCopyImageSubData, "glCopyImageSubData");
+	return available;
+}
+
+// estimated GPU memory of one level
+static size_t getLevelBytes(const TextureData& data, size_t level) {
+	const TextureLevel& mip = data.levels[level];
+	return data.compressed ? mip.size : (size_t)mip.width * mip.height * texelBytes(data.format);
+}
+
+// of the levels from first on
+static size_t getChainBytes(const TextureData& data, size_t first) {
+	size_t bytes = 0;
+	for (size_t level = first; level < data.levels.size(); level++) {
+		bytes += getLevelBytes(data, level);
+	}
+	return bytes;
+}
+
+// the first level no larger than STREAM_TAIL_SIZE
+static int getTailLevel(const TextureData& data) {
+	int level = 0;
+	while (level + 1 < (int)data.levels.size() && std::max(data.levels[level].width, data.levels[level].height) > STREAM_TAIL_SIZE) {
+		level++;
+	}
+	return level;
+}
+
+// the finest level the GPU reads when the whole texture covers width x height pixels, its lod rounded down
+static int getLevelForSize(const TextureData& data, float width, float height) {
+	float texelsPerPixel = std::max(data.width / width, data.height / height);
+	int level = texelsPerPixel > 1.0f ? (int)std::floor(std::log2(texelsPerPixel)) : 0;
+	return std::min(level, (int)data.levels.size() - 1);
+}
+
+// storage for levelCount levels, starting with level first of data, on the bound texture. immutable where the
+// context has glTexStorage2D, otherwise every level is specified without pixels. call it before binding a pixel
+// buffer, NULL would be an offset into it
+static void allocateStorage(const TextureData& data, size_t first, int levelCount) {
+	int width = data.levels[first].width;
+	int height = data.levels[first].height;
+	if (hasTextureStorage()) {
+		glTexStorage2D(GL_TEXTURE_2D, levelCount, data.internalFormat, width, height);
+	}
+	else {
+		for (int level = 0; level < levelCount; level++) {
+			if (data.compressed) {
+				glCompressedTexImage2D(GL_TEXTURE_2D, level, data.internalFormat, width, height, 0, (GLsizei)data.levels[first + level].size, NULL);
+			}
+			else {
+				glTexImage2D(GL_TEXTURE_2D, level, data.internalFormat, width, height, 0, data.format, GL_UNSIGNED_BYTE, NULL);
+			}
+			width = std::max(1, width / 2);
+			height = std::max(1, height / 2);
+		}
+	}
+	// sampling past the last level would make a mutable texture incomplete
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+}
+
+// level of data into level target of the bound texture, pixels may be an offset into the bound pixel buffer
+static void uploadLevel(const TextureData& data, size_t level, int target, const unsigned char* pixels) {
+	const TextureLevel& mip = data.levels[level];
+	if (data.compressed) {
+		glCompressedTexSubImage2D(GL_TEXTURE_2D, target, 0, 0, mip.width, mip.height, data.internalFormat, (GLsizei)mip.size, pixels);
+	}
+	else {
+		glTexSubImage2D(GL_TEXTURE_2D, target, 0, 0, mip.width, mip.height, data.format, GL_UNSIGNED_BYTE, pixels);
+	}
+}
+
+// mid grey, shown until the real image is resident
+static const unsigned char PLACEHOLDER_PIXEL[4] = { 128, 128, 128, 255 };
+
+// constructor
+TextureManager::TextureManager(size_t budgetBytes, ThreadPool& pool)
+	: budget(budgetBytes), useCounter(0), streaming(false), streamFrame(0), pool(pool), decodeMilliseconds(0.0), cacheReadMilliseconds(0.0), pixelBuffer(0), compressImages(false),
+	generateMips(true), mipFilter(MipGenerator::FILTER_KAISER), cacheDirectory("texturecache"), cacheChecked(false),
+	uploadFormat(PixelConverter::queryUploadFormat()), premultiplyAlpha(false) {}
+
+// destructor
+TextureManager::~TextureManager() {
+	// the decoding threads write into this object
+	pool.wait();
+	for (Entry& entry : entries) {
+		if (entry.id != 0) {
+			GLState::deleteTexture(entry.id);
+		}
+	}
+	if (pixelBuffer != 0) {
+		GLState::deleteBuffer(pixelBuffer);
+	}
+}
+
+void TextureManager::acquire(unsigned int slot) {
+	Entry& entry = entries[slot];
+	entry.references++;
+	entry.lastUse = ++useCounter;
+}
+
+void TextureManager::release(unsigned int slot) {
+	Entry& entry = entries[slot];
+	entry.references--;
+	entry.lastUse = ++useCounter;
+	if (entry.references == 0 && budget != 0 && statistics.residentBytes > budget) {
+		makeRoom(0);
+	}
+}
+
+// the sampler and colour space are part of the key, the same image with other wrap or filter modes is a separate texture
+std::string TextureManager::makeKey(const std::string& path, const SamplerState& sampler, ColorSpace colorSpace) {
+	return path + '|' + std::to_string(sampler.wrapS) + ',' + std::to_string(sampler.wrapT) + ',' +
+		std::to_string(sampler.minFilter) + ',' + std::to_string(sampler.magFilter) + ',' + std::to_string(colorSpace);
+}
+
+// keyed by the file's contents, not its name or modification time: an edited image gets a new key, a touched or
+// copied one keeps its entry. hashing is a small fraction of a decode
+std::string TextureManager::getCachePath(const unsigned char* bytes, size_t size, const SamplerState& sampler, ColorSpace colorSpace, bool cpuMips) const {
+	unsigned int settings[11] = { CACHE_VERSION, sampler.wrapS, sampler.wrapT, (unsigned int)colorSpace, (unsigned int)cpuMips,
+		(unsigned int)compressImages, (unsigned int)generateMips, (unsigned int)mipFilter, (unsigned int)uploadFormat.expandRgb,
+		(unsigned int)uploadFormat.bgra, (unsigned int)premultiplyAlpha };
+	unsigned long long hash = 14695981039346656037ull;
+	hash = hashBytes(hash, &size, sizeof(size));
+	hash = hashBytes(hash, bytes, size);
+	hash = hashBytes(hash, settings, sizeof(settings));
+	// the version is in the name too, so pruneCache() can tell stale files apart without opening them
+	char name[48];
+	std::snprintf(name, sizeof(name), "%016llx.v%u.ktx2", hash, CACHE_VERSION);
+	return cacheDirectory + "/" + name;
+}
+
+void TextureManager::pruneCache() {
+	namespace fs = std::filesystem;
+	std::error_code error;
+	fs::directory_iterator iterator(cacheDirectory, error);
+	if (error) {
+		return;
+	}
+	std::string currentSuffix = ".v" + std::to_string(CACHE_VERSION) + ".ktx2";
+	fs::file_time_type now = fs::file_time_type::clock::now();
+	struct CachedFile {
+		fs::path path;
+		fs::file_time_type lastUse;
+		uintmax_t size;
+	};
+	std::vector<CachedFile> current;
+	for (const fs::directory_entry& entry : iterator) {
+		std::error_code entryError;
+		fs::file_time_type lastUse = entry.last_write_time(entryError);
+		uintmax_t size = entry.file_size(entryError);
+		if (entryError) {
+			continue;
+		}
+		std::string name = entry.path().filename().string();
+		if (entry.path().extension() == ".tmp") {
+			if (now - lastUse > TEMPORARY_FILE_AGE) {
+				fs::remove(entry.path(), entryError);
+			}
+			continue;
+		}
+		if (entry.path().extension() != ".ktx2") {
+			continue;
+		}
+		if (name.size() <= currentSuffix.size() || name.compare(name.size() - currentSuffix.size(), currentSuffix.size(), currentSuffix) != 0) {
+			fs::remove(entry.path(), entryError);
+			statistics.cachePruned++;
+			continue;
+		}
+		current.push_back(CachedFile{ entry.path(), lastUse, size });
+	}
+	// most recently used first, the ones past the cap go
+	std::sort(current.begin(), current.end(), [](const CachedFile& a, const CachedFile& b) { return a.lastUse > b.lastUse; });
+	uintmax_t total = 0;
+	for (const CachedFile& file : current) {
+		total += file.size;
+		if (total > MAX_CACHE_BYTES) {
+			std::error_code removeError;
+			fs::remove(file.path, removeError);
+			statistics.cachePruned++;
+		}
+	}
+}
+
+bool TextureManager::decode(const std::string& path, const SamplerState& sampler, ColorSpace colorSpace, TextureData& data, std::string& error, CacheUse& cache, bool& imageDecoded) const {
+	cache = CACHE_UNUSED;
+	imageDecoded = false;
+	if (CompressedTexture::isContainer(path)) {
+		return CompressedTexture::load(path, data, error);
+	}
+	bool cpuMips = sampler.usesMipmaps() && (generateMips || compressImages);
+	MappedFile file;
+	if (!file.open(path.c_str())) {
+		error = "can't open";
+		return false;
+	}
+	// every decoded image is kept, a plain level saves the JPEG/PNG decode alone. a hit is an LZ4 decompression out
+	// of the mapped cache file into data, which the upload copies from
+	std::string cachePath = !cacheDirectory.empty() ? getCachePath(file.data(), file.size(), sampler, colorSpace, cpuMips) : std::string();
+	std::error_code existsError;
+	if (!cachePath.empty() && std::filesystem::exists(cachePath, existsError)) {
+		std::string cacheError;
+		if (CompressedTexture::load(cachePath, data, cacheError)) {
+			// hits count as uses for pruning
+			std::error_code touchError;
+			std::filesystem::last_write_time(cachePath, std::filesystem::file_time_type::clock::now(), touchError);
+			cache = CACHE_HIT;
+			return true;
+		}
+		std::cout << "WARNING::TEXTURE_MANAGER::CACHE_READ_FAILED " << cachePath << " (" << cacheError << ")" << std::endl;
+	}
+	// top row first as every decoder returns it, PixelConverter flips while it converts
+	ImageDecoder::Image image;
+	imageDecoded = true;
+	if (!ImageDecoder::decode(file.data(), file.size(), image, error)) {
+		return false;
+	}
+	file.close();
+	int channels = image.channels;
+	data.width = image.width;
+	data.height = image.height;
+	// the block encoder takes the channels as the decoder returns them
+	PixelConverter::Options options;
+	options.flip = true;
+	options.expandRgb = !compressImages && uploadFormat.expandRgb;
+	options.bgra = !compressImages && uploadFormat.bgra && PixelConverter::getChannels(channels, options) == 4;
+	options.premultiply = premultiplyAlpha;
+	int targetChannels = PixelConverter::getChannels(channels, options);
+	size_t size = (size_t)data.width * data.height * targetChannels;
+	data.internalFormat = INTERNAL_FORMATS[targetChannels - 1];
+	data.format = options.bgra ? GL_BGRA : FORMATS[targetChannels - 1];
+	data.compressed = false;
+	data.bytes.resize(size);
+	data.levels.assign(1, TextureLevel{ 0, size, data.width, data.height });
+	PixelConverter::convert(image.pixels.data(), data.width, data.height, channels, options, data.bytes.data());
+	if (cpuMips) {
+		MipGenerator::Options mipOptions;
+		mipOptions.filter = mipFilter;
+		mipOptions.colorSpace = colorSpace;
+		mipOptions.premultiplied = premultiplyAlpha;
+		mipOptions.wrapS = sampler.wrapS;
+		mipOptions.wrapT = sampler.wrapT;
+		MipGenerator::generate(data, mipOptions, pool);
+	}
+	if (compressImages) {
+		// stays uncompressed when the context lacks the format
+		CompressedTexture::compress(data, pool);
+	}
+	if (!cachePath.empty()) {
+		std::error_code directoryError;
+		std::filesystem::create_directories(cacheDirectory, directoryError);
+		std::string cacheError;
+		if (CompressedTexture::write(cachePath, data, cacheError, true)) {
+			cache = CACHE_STORED;
+		}
+		else {
+			std::cout << "WARNING::TEXTURE_MANAGER::CACHE_WRITE_FAILED " << cachePath << " (" << cacheError << ")" << std::endl;
+		}
+	}
+	return true;
+}
+
+void TextureManager::createTexture(Entry& entry) {
+	glGenTextures(1, &entry.id);
+	GLState::bindTexture(0, GL_TEXTURE_2D, entry.id);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, entry.sampler.wrapS);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, entry.sampler.wrapT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, entry.sampler.minFilter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, entry.sampler.magFilter);
+}
+
+void TextureManager::uploadData(unsigned int slot, TextureData& data, bool staged) {
+	Entry& entry = entries[slot];
+	// a single uncompressed level gets a generated chain, compressed data only has the levels it came with
+	bool generateMipmaps = entry.sampler.usesMipmaps() && data.levels.size() == 1 && !data.compressed;
+	entry.streamed = streaming && data.levels.size() > 1;
+	int first = 0;
+	int tail = getTailLevel(data);
+	if (entry.streamed) {
+		// the coarse tail, or more if it was already requested while decoding
+		first = entry.requestedWidth > 0.0f ? std::min(tail, getLevelForSize(data, entry.requestedWidth, entry.requestedHeight)) : tail;
+	}
+	size_t bytes = getChainBytes(data, first);
+	// a full mip chain adds a third
+	bytes += generateMipmaps ? bytes / 3 : 0;
+	makeRoom(bytes, slot);
+	// a streamed texture that does not fit starts with fewer levels
+	while (entry.streamed && budget != 0 && first < tail && statistics.residentBytes - entry.bytes + bytes > budget) {
+		bytes -= getLevelBytes(data, first++);
+	}
+
+	// immutable storage can not be resized, every upload goes into a new texture that replaces the placeholder
+	unsigned int previous = entry.id;
+	createTexture(entry);
+	int levelCount = (int)data.levels.size() - first;
+	if (generateMipmaps) {
+		levelCount = 1;
+		while ((std::max(data.width, data.height) >> levelCount) > 0) {
+			levelCount++;
+		}
+	}
+	allocateStorage(data, first, levelCount);
+
+	// copying into a mapped pixel buffer returns as soon as the memcpy is done, glTexSubImage2D then only queues
+	// a transfer from it instead of copying the pixels out of client memory before it returns
+	size_t firstOffset = data.levels[first].offset;
+	size_t stagedBytes = data.bytes.size() - firstOffset;
+	const unsigned char* source = data.bytes.data() + firstOffset;
+	if (staged) {
+		if (pixelBuffer == 0) {
+			glGenBuffers(1, &pixelBuffer);
+		}
+		GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+		// orphaned, the previous upload may still be reading the old storage
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, stagedBytes, NULL, GL_STREAM_DRAW);
+		void* destination = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, stagedBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (destination != NULL) {
+			memcpy(destination, data.bytes.data() + firstOffset, stagedBytes);
+			if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE) {
+				// offsets into the bound buffer, which starts at the first level
+				source = NULL;
+			}
+		}
+		if (source != NULL) {
+			GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+	}
+	// decoded rows are tightly packed, RGB and grey rows are not always a multiple of 4 bytes
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (size_t level = first; level < data.levels.size(); level++) {
+		uploadLevel(data, level, (int)(level - first), source + (data.levels[level].offset - firstOffset));
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	if (generateMipmaps) {
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	if (previous != 0) {
+		GLState::deleteTexture(previous);
+	}
+
+	statistics.residentBytes = statistics.residentBytes - entry.bytes + bytes;
+	statistics.peakResidentBytes = std::max(statistics.peakResidentBytes, statistics.residentBytes);
+	entry.width = data.width;
+	entry.height = data.height;
+	entry.bytes = bytes;
+	entry.residentLevel = first;
+	entry.wantedLevel = first;
+	if (entry.streamed) {
+		// the finer levels are read from here when they are needed
+		statistics.sourceBytes = statistics.sourceBytes - entry.source.bytes.size() + data.bytes.size();
+		entry.source = std::move(data);
+	}
+}
+
+void TextureManager::setResidentLevel(unsigned int slot, int level) {
+	Entry& entry = entries[slot];
+	const TextureData& data = entry.source;
+	int previousLevel = entry.residentLevel;
+	if (level == previousLevel) {
+		return;
+	}
+	unsigned int previous = entry.id;
+	createTexture(entry);
+	allocateStorage(data, level, (int)data.levels.size() - level);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (int mip = level; mip < (int)data.levels.size(); mip++) {
+		if (mip >= previousLevel && hasCopyImage()) {
+			// already on the GPU, copied without a trip through system memory
+			glCopyImageSubData(previous, GL_TEXTURE_2D, mip - previousLevel, 0, 0, 0, entry.id, GL_TEXTURE_2D, mip - level, 0, 0, 0,
+				data.levels[mip].width, data.levels[mip].height, 1);
+		}
+		else {
+			uploadLevel(data, mip, mip - level, data.bytes.data() + data.levels[mip].offset);
+		}
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	GLState::deleteTexture(previous);
+	// sampling starts where it was and fades into the new levels
+	entry.minLod = std::max(0.0f, entry.minLod + (float)(previousLevel - level));
+	if (entry.minLod > 0.0f) {
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_LOD, entry.minLod);
+	}
+
+	size_t bytes = getChainBytes(data, level);
+	statistics.residentBytes = statistics.residentBytes - entry.bytes + bytes;
+	statistics.peakResidentBytes = std::max(statistics.peakResidentBytes, statistics.residentBytes);
+	if (level < previousLevel) {
+		statistics.levelsStreamed += previousLevel - level;
+	}
+	else {
+		statistics.levelsDropped += level - previousLevel;
+	}
+	entry.bytes = bytes;
+	entry.residentLevel = level;
+}
+
+void TextureManager::streamLevels(std::chrono::steady_clock::time_point start, double budgetMilliseconds) {
+	streamFrame++;
+	std::vector<unsigned int> wanting;
+	for (unsigned int slot = 0; slot < entries.size(); slot++) {
+		Entry& entry = entries[slot];
+		if (!entry.streamed || entry.id == 0) {
+			continue;
+		}
+		if (entry.requestedWidth > 0.0f) {
+			entry.wantedLevel = getLevelForSize(entry.source, entry.requestedWidth, entry.requestedHeight);
+			entry.lastRequest = streamFrame;
+			entry.requestedWidth = 0.0f;
+			entry.requestedHeight = 0.0f;
+		}
+		if (entry.minLod > 0.0f) {
+			entry.minLod = std::max(0.0f, entry.minLod - STREAM_FADE_PER_FRAME);
+			GLState::bindTexture(0, GL_TEXTURE_2D, entry.id);
+			glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_LOD, entry.minLod);
+		}
+		if (entry.wantedLevel < entry.residentLevel) {
+			wanting.push_back(slot);
+		}
+	}
+	// textures seen most recently first, then the ones missing the most levels
+	std::sort(wanting.begin(), wanting.end(), [&](unsigned int a, unsigned int b) {
+		if (entries[a].lastRequest != entries[b].lastRequest) {
+			return entries[a].lastRequest > entries[b].lastRequest;
+		}
+		return entries[a].residentLevel - entries[a].wantedLevel > entries[b].residentLevel - entries[b].wantedLevel;
+	});
+	size_t streamed = 0;
+	for (unsigned int slot : wanting) {
+		if (streamed > 0 && std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() >= budgetMilliseconds) {
+			// the rest is still wanted next frame
+			break;
+		}
+		Entry& entry = entries[slot];
+		// making room may have evicted or trimmed it
+		if (!entry.streamed || entry.id == 0 || entry.wantedLevel >= entry.residentLevel) {
+			continue;
+		}
+		int level = entry.wantedLevel;
+		makeRoom(getChainBytes(entry.source, level) - entry.bytes, slot);
+		// the levels that do not fit the budget are left out
+		while (budget != 0 && level < entry.residentLevel && statistics.residentBytes - entry.bytes + getChainBytes(entry.source, level) > budget) {
+			level++;
+		}
+		if (level < entry.residentLevel) {
+			setResidentLevel(slot, level);
+			streamed++;
+		}
+	}
+}
+
+unsigned int TextureManager::addEntry(Entry& entry, const std::string& key) {
+	unsigned int slot;
+	if (!freeSlots.empty()) {
+		slot = freeSlots.back();
+		freeSlots.pop_back();
+		entry.generation = entries[slot].generation;
+		entries[slot] = std::move(entry);
+	}
+	else {
+		slot = (unsigned int)entries.size();
+		entries.push_back(std::move(entry));
+	}
+	slotByKey[key] = slot;
+	return slot;
+}
+
+void TextureManager::evict(unsigned int slot) {
+	Entry& entry = entries[slot];
+	GLState::deleteTexture(entry.id);
+	statistics.residentBytes -= entry.bytes;
+	statistics.evictions++;
+	if (entry.pending) {
+		statistics.pending--;
+	}
+	statistics.sourceBytes -= entry.source.bytes.size();
+	slotByKey.erase(makeKey(entry.path, entry.sampler, entry.colorSpace));
+	unsigned int generation = entry.generation + 1;
+	entry = Entry();
+	entry.generation = generation;
+	freeSlots.push_back(slot);
+}
+
+void TextureManager::makeRoom(size_t incoming, unsigned int keep) {
+	if (budget == 0) {
+		return;
+	}
+	while (statistics.residentBytes + incoming > budget) {
+		// textures are counted in the tens, a linear scan for the oldest beats keeping a list in order
+		unsigned int oldest = (unsigned int)entries.size();
+		for (unsigned int slot = 0; slot < entries.size(); slot++) {
+			const Entry& entry = entries[slot];
+			if (slot != keep && entry.id != 0 && entry.references == 0 && (oldest == entries.size() || entry.lastUse < entries[oldest].lastUse)) {
+				oldest = slot;
+			}
+		}
+		if (oldest != entries.size()) {
+			evict(oldest);
+			continue;
+		}
+		// then levels finer than a streamed texture needs, a texture not requested in the last frame only keeps its tail
+		unsigned int trimmed = (unsigned int)entries.size();
+		int trimLevel = 0;
+		for (unsigned int slot = 0; slot < entries.size(); slot++) {
+			const Entry& entry = entries[slot];
+			if (slot == keep || !entry.streamed || entry.id == 0) {
+				continue;
+			}
+			int level = entry.lastRequest == streamFrame ? entry.wantedLevel : std::max(entry.wantedLevel, getTailLevel(entry.source));
+			if (level > entry.residentLevel && (trimmed == entries.size() || entry.lastRequest < entries[trimmed].lastRequest)) {
+				trimmed = slot;
+				trimLevel = level;
+			}
+		}
+		if (trimmed == entries.size()) {
+			// everything left is in use
+			return;
+		}
+		// it has to be requested again to get them back
+		entries[trimmed].wantedLevel = trimLevel;
+		setResidentLevel(trimmed, trimLevel);
+	}
+}
+
+TextureHandle TextureManager::load(const std::string& path, const SamplerState& sampler, ColorSpace colorSpace) {
+	std::string key = makeKey(path, sampler, colorSpace);
+	auto found = slotByKey.find(key);
+	if (found != slotByKey.end()) {
+		statistics.hits++;
+		return TextureHandle(this, found->second);
+	}
+
+	statistics.misses++;
+	if (!cacheChecked && !cacheDirectory.empty()) {
+		cacheChecked = true;
+		pruneCache();
+	}
+	auto start = std::chrono::steady_clock::now();
+	TextureData data;
+	std::string error;
+	CacheUse cache;
+	bool imageDecoded;
+	bool decoded = decode(path, sampler, colorSpace, data, error, cache, imageDecoded);
+	statistics.cacheHits += cache == CACHE_HIT ? 1 : 0;
+	statistics.cacheStores += cache == CACHE_STORED ? 1 : 0;
+	statistics.imagesDecoded += imageDecoded ? 1 : 0;
+	auto decodedTime = std::chrono::steady_clock::now();
+	double ms = std::chrono::duration<double, std::milli>(decodedTime - start).count();
+	if (cache == CACHE_HIT) {
+		statistics.cacheReadMilliseconds += ms;
+	}
+	else {
+		statistics.decodeMilliseconds += ms;
+	}
+	if (!decoded) {
+		std::cout << "ERROR::TEXTURE_MANAGER::LOAD_FAILED " << path << " (" << error << ")" << std::endl;
+		statistics.failures++;
+		return TextureHandle();
+	}
+	Entry entry;
+	entry.path = path;
+	entry.sampler = sampler;
+	entry.colorSpace = colorSpace;
+	unsigned int slot = addEntry(entry, key);
+	uploadData(slot, data, false);
+	statistics.uploadMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - decodedTime).count();
+	return TextureHandle(this, slot);
+}
+
+TextureHandle TextureManager::loadAsync(const std::string& path, const SamplerState& sampler, ColorSpace colorSpace) {
+	std::string key = makeKey(path, sampler, colorSpace);
+	auto found = slotByKey.find(key);
+	if (found != slotByKey.end()) {
+		statistics.hits++;
+		return TextureHandle(this, found->second);
+	}
+
+	statistics.misses++;
+	if (!cacheChecked && !cacheDirectory.empty()) {
+		cacheChecked = true;
+		pruneCache();
+	}
+	statistics.pending++;
+	Entry entry;
+	entry.path = path;
+	entry.sampler = sampler;
+	entry.colorSpace = colorSpace;
+	entry.pending = true;
+	createTexture(entry);
+	// a single texel is a complete mip chain on its own, so the placeholder works with any filter
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, PLACEHOLDER_PIXEL);
+	unsigned int slot = addEntry(entry, key);
+	unsigned int generation = entries[slot].generation;
+
+	pool.submit([this, path, sampler, colorSpace, slot, generation]() {
+		auto start = std::chrono::steady_clock::now();
+		DecodedImage image;
+		image.slot = slot;
+		image.generation = generation;
+		image.valid = decode(path, sampler, colorSpace, image.data, image.error, image.cache, image.imageDecoded);
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		std::lock_guard<std::mutex> lock(decodedMutex);
+		if (image.cache == CACHE_HIT) {
+			cacheReadMilliseconds += ms;
+		}
+		else {
+			decodeMilliseconds += ms;
+		}
+		decoded.push_back(std::move(image));
+	});
+	return TextureHandle(this, slot);
+}
+
+void TextureManager::uploadDecoded(DecodedImage& image) {
+	Entry& entry = entries[image.slot];
+	// evicted (and maybe reused) while it was decoding
+	if (entry.generation != image.generation || entry.id == 0) {
+		return;
+	}
+	entry.pending = false;
+	statistics.pending--;
+	statistics.cacheHits += image.cache == CACHE_HIT ? 1 : 0;
+	statistics.cacheStores += image.cache == CACHE_STORED ? 1 : 0;
+	statistics.imagesDecoded += image.imageDecoded ? 1 : 0;
+	if (!image.valid) {
+		// keeps showing the placeholder
+		std::cout << "ERROR::TEXTURE_MANAGER::LOAD_FAILED " << entry.path << " (" << image.error << ")" << std::endl;
+		statistics.failures++;
+		return;
+	}
+	uploadData(image.slot, image.data, true);
+}
+
+void TextureManager::update(double budgetMilliseconds) {
+	auto start = std::chrono::steady_clock::now();
+	std::vector<DecodedImage> ready;
+	{
+		std::lock_guard<std::mutex> lock(decodedMutex);
+		ready.swap(decoded);
+		statistics.decodeMilliseconds += decodeMilliseconds;
+		statistics.cacheReadMilliseconds += cacheReadMilliseconds;
+		decodeMilliseconds = 0.0;
+		cacheReadMilliseconds = 0.0;
+	}
+	size_t uploaded = 0;
+	double elapsed = 0.0;
+	while (uploaded < ready.size() && (uploaded == 0 || elapsed < budgetMilliseconds)) {
+		uploadDecoded(ready[uploaded++]);
+		elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+	if (uploaded < ready.size()) {
+		// out of time, the rest goes back in front of anything decoded meanwhile
+		statistics.deferredFrames++;
+		std::lock_guard<std::mutex> lock(decodedMutex);
+		decoded.insert(decoded.begin(), ready.begin() + uploaded, ready.end());
+	}
+	if (streaming) {
+		streamLevels(start, budgetMilliseconds);
+	}
+	statistics.uploadMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void TextureManager::finishAll() {
+	// runs queued decodes on this thread too, so it also works with a pool without workers
+	pool.wait();
+	update(1e30);
+}
+
+size_t TextureManager::getPendingCount() const {
+	return statistics.pending;
+}
+
+void TextureManager::setCompression(bool enabled) {
+	compressImages = enabled;
+}
+
+void TextureManager::setMipGeneration(bool enabled, MipGenerator::Filter filter) {
+	generateMips = enabled;
+	mipFilter = filter;
+}
+
+void TextureManager::setPremultiplyAlpha(bool enabled) {
+	premultiplyAlpha = enabled;
+}
+
+void TextureManager::setCacheDirectory(const std::string& directory) {
+	cacheDirectory = directory;
+	cacheChecked = false;
+}
+
+void TextureManager::setStreaming(bool enabled) {
+	streaming = enabled;
+}
+
+void TextureManager::setBudget(size_t budgetBytes) {
+	budget = budgetBytes;
+	makeRoom(0);
+}
+
+void TextureManager::evictUnused() {
+	for (unsigned int slot = 0; slot < entries.size(); slot++) {
+		if (entries[slot].id != 0 && entries[slot].references == 0) {
+			evict(slot);
+		}
+	}
+}
+
+const TextureManager::Statistics& TextureManager::getStatistics() const {
+	return statistics;
+}
+
+void TextureManager::printStatistics() const {
+	std::cout << "Textures: " << statistics.hits << " hits, " << statistics.misses << " misses, " << statistics.failures
+		<< " failed, " << statistics.evictions << " evicted, " << statistics.pending << " pending, "
+		<< statistics.residentBytes / 1024 << " KB resident (peak " << statistics.peakResidentBytes / 1024 << " KB";
+	if (budget != 0) {
+		std::cout << ", budget " << budget / 1024 << " KB";
+	}
+	std::cout << "), " << statistics.imagesDecoded << " images decoded, decode " << statistics.decodeMilliseconds
+		<< " ms, upload " << statistics.uploadMilliseconds << " ms";
+	if (!cacheDirectory.empty()) {
+		std::cout << ", cache " << statistics.cacheHits << " hits (" << statistics.cacheReadMilliseconds << " ms), "
+			<< statistics.cacheStores << " stored, " << statistics.cachePruned << " pruned";
+	}
+	if (statistics.deferredFrames > 0) {
+		std::cout << ", uploads deferred in " << statistics.deferredFrames << " frames";
+	}
+	if (streaming) {
+		std::cout << ", " << statistics.levelsStreamed << " levels streamed in, " << statistics.levelsDropped << " dropped, "
+			<< statistics.sourceBytes / 1024 << " KB in system memory";
+	}
+	std::cout << std::endl;
+}
@@ -0,0 +1,277 @@
+#ifndef TEXTURE_MANAGER_H
+#define TEXTURE_MANAGER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <chrono>
+#include <cstddef>
+
+#include <glad/glad.h>
+
+#include "TextureData.h"
+#include "MipGenerator.h"
+#include "PixelConverter.h"
+#include "../Utility/ThreadPool.h"
+
+// wrap and filter modes a texture is created with, part of the cache key
+struct SamplerState {
+	GLenum wrapS = GL_REPEAT;
+	GLenum wrapT = GL_REPEAT;
+	GLenum minFilter = GL_LINEAR_MIPMAP_LINEAR;
+	GLenum magFilter = GL_LINEAR;
+
+	bool operator==(const SamplerState& other) const;
+	// true if the min filter reads mip levels
+	bool usesMipmaps() const;
+};
+
+class TextureManager;
+
+// counted reference to a texture owned by a TextureManager. while any handle to a texture exists it is never
+// evicted. a default constructed handle (or one for an image that failed to load) has id 0. the id changes when
+// the texture is uploaded or streams levels in or out, so read it again every frame
+class TextureHandle {
+private:
+	TextureManager* manager;
+	unsigned int slot;
+
+	friend class TextureManager;
+	TextureHandle(TextureManager* manager, unsigned int slot);
+
+public:
+	// constructor
+	TextureHandle();
+	TextureHandle(const TextureHandle& other);
+	TextureHandle(TextureHandle&& other) noexcept;
+
+	// destructor
+	~TextureHandle();
+
+	TextureHandle& operator=(const TextureHandle& other);
+	TextureHandle& operator=(TextureHandle&& other) noexcept;
+
+	// drops the reference, the handle becomes empty
+	void reset();
+
+	// getters
+	unsigned int getID() const;
+	int getWidth() const;
+	int getHeight() const;
+	bool isValid() const;
+	// false while an asynchronously loaded texture still shows its placeholder
+	bool isResident() const;
+
+	// tells a streamed texture that this frame its whole [0, 1] range covers width x height pixels on screen.
+	// call it for every draw, the largest request since the last update() decides which levels it needs
+	void requestScreenSize(float width, float height);
+};
+
+// loads every image once per sampler state and hands out refcounted handles to it. textures nobody holds a handle
+// to stay resident so a later request is free, until the estimated GPU memory goes over the budget; then they are
+// deleted least recently released first. textures with handles are never evicted, even over budget.
+// loadAsync() decodes on the thread pool instead: the handle immediately refers to a texture holding a 1x1
+// placeholder, and update() streams the decoded pixels into it through a pixel buffer object, a few per frame.
+// decoded images are reshaped by PixelConverter in one pass: flipped bottom row first, expanded and swizzled into
+// what the driver reports it prefers and premultiplied by alpha when asked to.
+// .ktx2 and .dds paths keep their block compressed mip chains (see CompressedTexture), other images get their chain
+// from MipGenerator and are compressed at load time after setCompression(true). what that produces is kept in an
+// LZ4 compressed KTX2 file in the cache directory, keyed by a hash of the image file's contents and the settings, so
+// the next start decompresses the finished levels instead of decoding, filtering and compressing again.
+// textures live in immutable storage (glTexStorage2D) where the context has it. after setStreaming(true) textures
+// with a mip chain keep every level in system memory but only the ones their on-screen size needs in the texture:
+// update() streams finer levels in, fading them in through GL_TEXTURE_MIN_LOD, and drops the ones not needed
+// anymore when the budget runs out
+class TextureManager {
+public:
+	struct Statistics {
+		// requests served from the cache and requests that decoded an image
+		unsigned long hits = 0;
+		unsigned long misses = 0;
+		unsigned long failures = 0;
+		unsigned long evictions = 0;
+		// estimated GPU memory of every texture still alive, including the mip chain
+		size_t residentBytes = 0;
+		size_t peakResidentBytes = 0;
+		// summed over every decoding thread, loads that decoded an image or container and loads read from the cache
+		double decodeMilliseconds = 0.0;
+		double cacheReadMilliseconds = 0.0;
+		double uploadMilliseconds = 0.0;
+		// asynchronous loads waiting to be decoded or uploaded
+		unsigned long pending = 0;
+		// frames where update() ran out of time and left decoded images for the next frame
+		unsigned long deferredFrames = 0;
+		// images read from the cache directory instead of being decoded, filtered and compressed, and images written to it
+		unsigned long cacheHits = 0;
+		unsigned long cacheStores = 0;
+		// cache files pruneCache() deleted
+		unsigned long cachePruned = 0;
+		// JPG/PNG images run through ImageDecoder, a warm start with the cache has none
+		unsigned long imagesDecoded = 0;
+		// mip levels update() added to and removed from streamed textures
+		unsigned long levelsStreamed = 0;
+		unsigned long levelsDropped = 0;
+		// system memory copies the streamed textures read their levels from
+		size_t sourceBytes = 0;
+	};
+
+private:
+	struct Entry {
+		std::string path;
+		SamplerState sampler;
+		ColorSpace colorSpace = COLOR_SPACE_LINEAR;
+		unsigned int id = 0;
+		int width = 0;
+		int height = 0;
+		size_t bytes = 0;
+		unsigned int references = 0;
+		// use counter value of the last acquire or release, smallest is evicted first
+		unsigned long long lastUse = 0;
+		// the texture only holds the placeholder so far
+		bool pending = false;
+		// bumped whenever the slot is reused, decodes finishing for an older generation are dropped
+		unsigned int generation = 0;
+		// streamed textures keep every level here, the texture only holds the ones from residentLevel on
+		bool streamed = false;
+		TextureData source;
+		int residentLevel = 0;
+		// finest level the screen size requests need, and the largest request since the last update()
+		int wantedLevel = 0;
+		float requestedWidth = 0.0f;
+		float requestedHeight = 0.0f;
+		// stream frame of the last request, textures not seen for longest give up their levels first
+		unsigned long long lastRequest = 0;
+		// GL_TEXTURE_MIN_LOD while newly streamed levels fade in
+		float minLod = 0.0f;
+	};
+
+	// what decode() did with the cache directory
+	enum CacheUse {
+		CACHE_UNUSED,
+		CACHE_HIT,
+		CACHE_STORED
+	};
+
+	// an image finished by a decoding thread, waiting for update() to upload it
+	struct DecodedImage {
+		unsigned int slot = 0;
+		unsigned int generation = 0;
+		bool valid = false;
+		CacheUse cache = CACHE_UNUSED;
+		TextureData data;
+		std::string error;
+		// ImageDecoder ran
+		bool imageDecoded = false;
+	};
+
+	// slots are reused but never move, handles refer to them by index
+	std::vector<Entry> entries;
+	std::vector<unsigned int> freeSlots;
+	std::unordered_map<std::string, unsigned int> slotByKey;
+	size_t budget;
+	unsigned long long useCounter;
+	bool streaming;
+	// counts update() calls
+	unsigned long long streamFrame;
+	Statistics statistics;
+
+	ThreadPool& pool;
+	// everything below is shared with the decoding threads
+	std::mutex decodedMutex;
+	std::vector<DecodedImage> decoded;
+	double decodeMilliseconds;
+	double cacheReadMilliseconds;
+	// staging buffer the decoded pixels are copied into, orphaned for every upload
+	unsigned int pixelBuffer;
+	// JPG/PNG images are encoded to BC1/BC3/BC4/BC5 after decoding
+	bool compressImages;
+	// mip chains of JPG/PNG images are filtered on the CPU instead of by glGenerateMipmap
+	bool generateMips;
+	MipGenerator::Filter mipFilter;
+	// empty when the cache is off
+	std::string cacheDirectory;
+	// the directory is pruned once, before the first image of the run is decoded
+	bool cacheChecked;
+	// queried once by the constructor
+	PixelConverter::UploadFormat uploadFormat;
+	bool premultiplyAlpha;
+
+	friend class TextureHandle;
+	void acquire(unsigned int slot);
+	void release(unsigned int slot);
+
+	static std::string makeKey(const std::string& path, const SamplerState& sampler, ColorSpace colorSpace);
+	// file in the cache directory for an image file with these contents and the current settings
+	std::string getCachePath(const unsigned char* bytes, size_t size, const SamplerState& sampler, ColorSpace colorSpace, bool cpuMips) const;
+	// deletes cache files of other CACHE_VERSIONs, temporary files of crashed writers and the least recently used
+	// files beyond the cache's size cap. runs before any decode is queued, nothing reads the directory meanwhile
+	void pruneCache();
+	// reads KTX2/DDS containers or decodes the image with ImageDecoder, filtering the mip chain and block compressing
+	// the latter when enabled, or reading the result of that from the cache. thread safe
+	bool decode(const std::string& path, const SamplerState& sampler, ColorSpace colorSpace, TextureData& data, std::string& error, CacheUse& cache, bool& imageDecoded) const;
+	// creates the texture name with the entry's sampler state
+	void createTexture(Entry& entry);
+	// replaces the texture of the slot with one holding the levels of data (from the streaming level on for streamed
+	// textures), uploaded through the pixel buffer when staged is set. single images get a generated chain
+	void uploadData(unsigned int slot, TextureData& data, bool staged);
+	// moves a streamed texture to the levels from level on, copying the ones it already has on the GPU
+	void setResidentLevel(unsigned int slot, int level);
+	// applies the requests of the last frame and streams the needed levels in until the time is used up
+	void streamLevels(std::chrono::steady_clock::time_point start, double budgetMilliseconds);
+	unsigned int addEntry(Entry& entry, const std::string& key);
+	void uploadDecoded(DecodedImage& image);
+	void evict(unsigned int slot);
+	// evicts unreferenced textures, oldest first, then drops the levels streamed textures do not need anymore,
+	// least recently requested first, until incoming more bytes fit into the budget. keep is left alone
+	void makeRoom(size_t incoming, unsigned int keep = ~0u);
+
+public:
+	// constructor, budgetBytes of 0 means unlimited. needs the context current, it asks for the preferred upload format
+	explicit TextureManager(size_t budgetBytes = 0, ThreadPool& pool = ThreadPool::shared());
+
+	// destructor, waits for the decodes still queued and deletes every texture. handles must not outlive the manager
+	~TextureManager();
+
+	TextureManager(const TextureManager&) = delete;
+	TextureManager& operator=(const TextureManager&) = delete;
+
+	// the texture for this image and sampler state, decoding and uploading it only if it is not known yet.
+	// one still loading asynchronously is returned as it is. colorSpace tells MipGenerator how to filter the colour
+	// channels, pass COLOR_SPACE_SRGB for colour images; the linear default suits data like normal maps
+	TextureHandle load(const std::string& path, const SamplerState& sampler = SamplerState(), ColorSpace colorSpace = COLOR_SPACE_LINEAR);
+	// returns at once with a placeholder texture, the image is decoded on the pool and uploaded by update()
+	TextureHandle loadAsync(const std::string& path, const SamplerState& sampler = SamplerState(), ColorSpace colorSpace = COLOR_SPACE_LINEAR);
+
+	// call once per frame on the GL thread: uploads decoded images, then streams levels of streamed textures in,
+	// until budgetMilliseconds are used up. at least one of each is done per call so loading always makes progress
+	void update(double budgetMilliseconds);
+	// blocks until every asynchronous load is decoded and uploaded
+	void finishAll();
+	size_t getPendingCount() const;
+
+	// encodes images without precompressed data with BlockEncoder, a quarter (RGBA) or sixth (RGB) of the memory.
+	// set it before loading, textures already decoded stay as they are
+	void setCompression(bool enabled);
+	// filters mip chains with MipGenerator (on by default) or leaves them to glGenerateMipmap. compressed textures
+	// always get theirs from MipGenerator, glGenerateMipmap can not write compressed levels
+	void setMipGeneration(bool enabled, MipGenerator::Filter filter = MipGenerator::FILTER_KAISER);
+	// multiplies the colour of RGBA images by their alpha when they are decoded, for GL_ONE, GL_ONE_MINUS_SRC_ALPHA
+	// blending and filtering without dark fringes. containers are left as they are
+	void setPremultiplyAlpha(bool enabled);
+	// where processed images are kept between runs, "texturecache" by default. empty turns the cache off.
+	// the first load of a run prunes it to 512 MB, least recently used files first
+	void setCacheDirectory(const std::string& directory);
+	// streams the levels of textures with a mip chain by their requested screen size, set it before loading
+	void setStreaming(bool enabled);
+
+	// applies immediately, evicting unreferenced textures that no longer fit
+	void setBudget(size_t budgetBytes);
+	// deletes every texture without handles
+	void evictUnused();
+
+	const Statistics& getStatistics() const;
+	void printStatistics() const;
+};
+
+#endif // TEXTURE_MANAGER_H
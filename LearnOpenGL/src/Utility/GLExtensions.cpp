@@ -0,0 +1,41 @@
+#include <string>
+#include <unordered_set>
+
+#include "GLExtensions.h"
+
+namespace GLExtensions {
+
+	static GLADloadproc procLoader = NULL;
+	static std::unordered_set<std::string> extensions;
+
+	// remember the loader and read the extension list, call right after gladLoadGLLoader
+	void initialize(GLADloadproc loader) {
+		procLoader = loader;
+		extensions.clear();
+		int count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (int i = 0; i < count; i++) {
+			const char* name = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+			if (name) {
+				extensions.insert(name);
+			}
+		}
+		return;
+	}
+
+	// true if the context reports the extension, e.g. "GL_ARB_get_program_binary"
+	bool has(const char* name) {
+		return extensions.count(name) != 0;
+	}
+
+	// true if the context version is at least major.minor
+	bool hasVersion(int major, int minor) {
+		return GLVersion.major > major || (GLVersion.major == major && GLVersion.minor >= minor);
+	}
+
+	// look an entry point up through the loader used for glad
+	void* getProcAddress(const char* name) {
+		return procLoader ? procLoader(name) : NULL;
+	}
+
+}
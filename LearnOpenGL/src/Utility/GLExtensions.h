@@ -0,0 +1,35 @@
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include <glad/glad.h>
+
+// glad is generated for core 4.6 without extensions, and only loads the entry points of the
+// version the context actually reports. these helpers find extensions at runtime and load
+// the entry points of core extensions (ARB_get_program_binary, ARB_buffer_storage, ...)
+// into glad's function pointers when the context version is older than the feature.
+namespace GLExtensions {
+
+	// remember the loader and read the extension list, call right after gladLoadGLLoader
+	void initialize(GLADloadproc loader);
+
+	// true if the context reports the extension, e.g. "GL_ARB_get_program_binary"
+	bool has(const char* name);
+
+	// true if the context version is at least major.minor
+	bool hasVersion(int major, int minor);
+
+	// look an entry point up through the loader used for glad
+	void* getProcAddress(const char* name);
+
+	// load "name" into glad's pointer if it is still null, returns false if it stays null
+	template <typename T>
+	bool loadProc(T& pointer, const char* name) {
+		if (pointer == NULL) {
+			pointer = (T)getProcAddress(name);
+		}
+		return pointer != NULL;
+	}
+
+}
+
+#endif // GL_EXTENSIONS_H
@@ -0,0 +1,267 @@
+#include <cstring>
+#include <cstdlib>
+
+#include "Json.h"
+
+namespace Json {
+
+	const Value* Value::find(const char* key) const {
+		for (const std::pair<std::string, Value>& member : members) {
+			if (member.first == key) {
+				return &member.second;
+			}
+		}
+		return NULL;
+	}
+
+	double Value::getNumber(const char* key, double fallback) const {
+		const Value* value = find(key);
+		return value != NULL && value->type == TYPE_NUMBER ? value->number : fallback;
+	}
+
+	std::string Value::getString(const char* key, const char* fallback) const {
+		const Value* value = find(key);
+		return value != NULL && value->type == TYPE_STRING ? value->string : std::string(fallback);
+	}
+
+	size_t Value::size() const {
+		return items.size();
+	}
+
+	const Value& Value::operator[](size_t index) const {
+		return items[index];
+	}
+
+	// recursive descent over the text, depth is limited so a hostile file can not overflow the stack
+	class Parser {
+	private:
+		const char* cursor;
+		const char* end;
+		const char* begin;
+		std::string& error;
+
+		static const int MAX_DEPTH = 256;
+
+		bool fail(const char* message) {
+			error = std::string(message) + " at byte " + std::to_string(cursor - begin);
+			return false;
+		}
+
+		void skipWhitespace() {
+			while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r')) {
+				cursor++;
+			}
+		}
+
+		bool expect(const char* literal) {
+			size_t length = strlen(literal);
+			if ((size_t)(end - cursor) < length || memcmp(cursor, literal, length) != 0) {
+				return fail("unexpected token");
+			}
+			cursor += length;
+			return true;
+		}
+
+		static void appendUtf8(std::string& out, unsigned int codePoint) {
+			if (codePoint < 0x80) {
+				out += (char)codePoint;
+			}
+			else if (codePoint < 0x800) {
+				out += (char)(0xC0 | (codePoint >> 6));
+				out += (char)(0x80 | (codePoint & 0x3F));
+			}
+			else if (codePoint < 0x10000) {
+				out += (char)(0xE0 | (codePoint >> 12));
+				out += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+				out += (char)(0x80 | (codePoint & 0x3F));
+			}
+			else {
+				out += (char)(0xF0 | (codePoint >> 18));
+				out += (char)(0x80 | ((codePoint >> 12) & 0x3F));
+				out += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+				out += (char)(0x80 | (codePoint & 0x3F));
+			}
+		}
+
+		bool parseHex4(unsigned int& value) {
+			if (end - cursor < 4) {
+				return fail("truncated escape");
+			}
+			value = 0;
+			for (int i = 0; i < 4; i++) {
+				char c = *cursor++;
+				value <<= 4;
+				if (c >= '0' && c <= '9') value |= c - '0';
+				else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+				else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+				else return fail("bad escape");
+			}
+			return true;
+		}
+
+		bool parseString(std::string& out) {
+			// opening quote
+			cursor++;
+			while (cursor < end && *cursor != '"') {
+				if (*cursor != '\\') {
+					out += *cursor++;
+					continue;
+				}
+				cursor++;
+				if (cursor >= end) {
+					break;
+				}
+				char escape = *cursor++;
+				switch (escape) {
+				case '"': out += '"'; break;
+				case '\\': out += '\\'; break;
+				case '/': out += '/'; break;
+				case 'b': out += '\b'; break;
+				case 'f': out += '\f'; break;
+				case 'n': out += '\n'; break;
+				case 'r': out += '\r'; break;
+				case 't': out += '\t'; break;
+				case 'u': {
+					unsigned int codePoint = 0;
+					if (!parseHex4(codePoint)) {
+						return false;
+					}
+					// surrogate pair
+					if (codePoint >= 0xD800 && codePoint < 0xDC00 && end - cursor >= 6 && cursor[0] == '\\' && cursor[1] == 'u') {
+						cursor += 2;
+						unsigned int low = 0;
+						if (!parseHex4(low)) {
+							return false;
+						}
+						if (low < 0xDC00 || low >= 0xE000) {
+							return fail("bad surrogate pair");
+						}
+						codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+					}
+					appendUtf8(out, codePoint);
+					break;
+				}
+				default:
+					return fail("bad escape");
+				}
+			}
+			if (cursor >= end) {
+				return fail("unterminated string");
+			}
+			// closing quote
+			cursor++;
+			return true;
+		}
+
+		bool parseNumber(Value& value) {
+			// strtod needs a terminated string, numbers are short so copy them out
+			const char* start = cursor;
+			while (cursor < end && (strchr("+-0123456789.eE", *cursor) != NULL)) {
+				cursor++;
+			}
+			std::string text(start, cursor);
+			char* parsedEnd = NULL;
+			value.type = TYPE_NUMBER;
+			value.number = strtod(text.c_str(), &parsedEnd);
+			if (text.empty() || parsedEnd != text.c_str() + text.size()) {
+				cursor = start;
+				return fail("bad number");
+			}
+			return true;
+		}
+
+		bool parseValue(Value& value, int depth) {
+			if (depth > MAX_DEPTH) {
+				return fail("nested too deeply");
+			}
+			skipWhitespace();
+			if (cursor >= end) {
+				return fail("unexpected end");
+			}
+			switch (*cursor) {
+			case '{': {
+				value.type = TYPE_OBJECT;
+				cursor++;
+				skipWhitespace();
+				if (cursor < end && *cursor == '}') {
+					cursor++;
+					return true;
+				}
+				while (true) {
+					skipWhitespace();
+					if (cursor >= end || *cursor != '"') {
+						return fail("expected a key");
+					}
+					value.members.emplace_back();
+					if (!parseString(value.members.back().first)) {
+						return false;
+					}
+					skipWhitespace();
+					if (!expect(":") || !parseValue(value.members.back().second, depth + 1)) {
+						return false;
+					}
+					skipWhitespace();
+					if (cursor < end && *cursor == ',') {
+						cursor++;
+						continue;
+					}
+					return expect("}");
+				}
+			}
+			case '[': {
+				value.type = TYPE_ARRAY;
+				cursor++;
+				skipWhitespace();
+				if (cursor < end && *cursor == ']') {
+					cursor++;
+					return true;
+				}
+				while (true) {
+					value.items.emplace_back();
+					if (!parseValue(value.items.back(), depth + 1)) {
+						return false;
+					}
+					skipWhitespace();
+					if (cursor < end && *cursor == ',') {
+						cursor++;
+						continue;
+					}
+					return expect("]");
+				}
+			}
+			case '"':
+				value.type = TYPE_STRING;
+				return parseString(value.string);
+			case 't':
+				value.type = TYPE_BOOLEAN;
+				value.boolean = true;
+				return expect("true");
+			case 'f':
+				value.type = TYPE_BOOLEAN;
+				return expect("false");
+			case 'n':
+				return expect("null");
+			default:
+				return parseNumber(value);
+			}
+		}
+
+	public:
+		// constructor
+		Parser(const char* text, size_t length, std::string& error) : cursor(text), end(text + length), begin(text), error(error) {}
+
+		bool parseDocument(Value& root) {
+			if (!parseValue(root, 0)) {
+				return false;
+			}
+			skipWhitespace();
+			return cursor == end || fail("trailing characters");
+		}
+	};
+
+	bool parse(const char* text, size_t length, Value& root, std::string& error) {
+		root = Value();
+		Parser parser(text, length, error);
+		return parser.parseDocument(root);
+	}
+}
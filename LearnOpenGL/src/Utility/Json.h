@@ -0,0 +1,45 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+// small DOM style JSON reader, enough for model and texture descriptions (glTF, KTX metadata)
+namespace Json {
+
+	enum Type {
+		TYPE_NULL,
+		TYPE_BOOLEAN,
+		TYPE_NUMBER,
+		TYPE_STRING,
+		TYPE_ARRAY,
+		TYPE_OBJECT
+	};
+
+	struct Value {
+		Type type = TYPE_NULL;
+		bool boolean = false;
+		double number = 0.0;
+		std::string string;
+		std::vector<Value> items;
+		// kept in file order, objects in the formats read here are small so lookups are linear
+		std::vector<std::pair<std::string, Value>> members;
+
+		// NULL when this is not an object or has no such member
+		const Value* find(const char* key) const;
+		// the member as a number or string, fallback when it is missing or of another type
+		double getNumber(const char* key, double fallback) const;
+		std::string getString(const char* key, const char* fallback) const;
+		// items of an array, empty for anything else
+		size_t size() const;
+		const Value& operator[](size_t index) const;
+	};
+
+	// parses UTF-8 text, on failure error holds the byte offset and what went wrong
+	bool parse(const char* text, size_t length, Value& root, std::string& error);
+
+}
+
+#endif // JSON_H
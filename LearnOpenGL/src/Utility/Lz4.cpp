@@ -0,0 +1,161 @@
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#include "Lz4.h"
+
+namespace Lz4 {
+
+	static const size_t MIN_MATCH = 4;
+	// the format ends with at least 5 literals, and the last match starts at least 12 bytes before the end
+	static const size_t LAST_LITERALS = 5;
+	static const size_t MATCH_LIMIT = 12;
+	static const size_t MAX_OFFSET = 65535;
+	static const int HASH_BITS = 16;
+	// every 64 bytes without a match the search steps one byte further
+	static const int SKIP_SHIFT = 6;
+
+	static inline unsigned int read32(const unsigned char* bytes) {
+		unsigned int value;
+		memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+
+	static inline unsigned int hash(unsigned int sequence) {
+		return (sequence * 2654435761u) >> (32 - HASH_BITS);
+	}
+
+	// the part of a literal or match length that does not fit the token's 4 bits
+	static inline unsigned char* writeLength(unsigned char* out, size_t length) {
+		for (; length >= 255; length -= 255) {
+			*out++ = 255;
+		}
+		*out++ = (unsigned char)length;
+		return out;
+	}
+
+	static inline bool readLength(const unsigned char*& in, const unsigned char* end, size_t& length) {
+		unsigned char byte;
+		do {
+			if (in >= end) {
+				return false;
+			}
+			byte = *in++;
+			length += byte;
+		} while (byte == 255);
+		return true;
+	}
+
+	// one sequence: the literals since anchor, then a match of matchLength at offset (none for the last one)
+	static unsigned char* writeSequence(unsigned char* out, const unsigned char* literals, size_t literalLength, size_t offset, size_t matchLength) {
+		unsigned char* token = out++;
+		*token = (unsigned char)(std::min<size_t>(literalLength, 15) << 4);
+		if (literalLength >= 15) {
+			out = writeLength(out, literalLength - 15);
+		}
+		if (literalLength > 0) {
+			memcpy(out, literals, literalLength);
+			out += literalLength;
+		}
+		if (matchLength == 0) {
+			return out;
+		}
+		*out++ = (unsigned char)(offset & 0xFF);
+		*out++ = (unsigned char)(offset >> 8);
+		size_t extra = matchLength - MIN_MATCH;
+		*token |= (unsigned char)std::min<size_t>(extra, 15);
+		if (extra >= 15) {
+			out = writeLength(out, extra - 15);
+		}
+		return out;
+	}
+
+	size_t getBound(size_t size) {
+		return size + size / 255 + 16;
+	}
+
+	size_t compress(const unsigned char* source, size_t size, unsigned char* target, size_t capacity) {
+		if (capacity < getBound(size)) {
+			return 0;
+		}
+		unsigned char* out = target;
+		size_t anchor = 0;
+		if (size > MATCH_LIMIT) {
+			// last position each hash was seen at. a stale or colliding entry is caught by comparing the bytes
+			std::vector<unsigned int> table((size_t)1 << HASH_BITS, 0);
+			size_t limit = size - MATCH_LIMIT;
+			size_t matchEnd = size - LAST_LITERALS;
+			size_t position = 1;
+			while (position < limit) {
+				unsigned int sequence = read32(source + position);
+				unsigned int& entry = table[hash(sequence)];
+				size_t candidate = entry;
+				entry = (unsigned int)position;
+				if (candidate >= position || position - candidate > MAX_OFFSET || read32(source + candidate) != sequence) {
+					position += 1 + ((position - anchor) >> SKIP_SHIFT);
+					continue;
+				}
+				// grow the match backwards over the pending literals, then forwards
+				while (position > anchor && candidate > 0 && source[position - 1] == source[candidate - 1]) {
+					position--;
+					candidate--;
+				}
+				size_t end = position + MIN_MATCH;
+				while (end < matchEnd && source[end] == source[candidate + (end - position)]) {
+					end++;
+				}
+				out = writeSequence(out, source + anchor, position - anchor, position - candidate, end - position);
+				anchor = position = end;
+			}
+		}
+		out = writeSequence(out, source + anchor, size - anchor, 0, 0);
+		return (size_t)(out - target);
+	}
+
+	bool decompress(const unsigned char* source, size_t size, unsigned char* target, size_t targetSize) {
+		const unsigned char* in = source;
+		const unsigned char* end = source + size;
+		size_t written = 0;
+		while (in < end) {
+			unsigned char token = *in++;
+			size_t literalLength = token >> 4;
+			if (literalLength == 15 && !readLength(in, end, literalLength)) {
+				return false;
+			}
+			if (literalLength > (size_t)(end - in) || literalLength > targetSize - written) {
+				return false;
+			}
+			memcpy(target + written, in, literalLength);
+			in += literalLength;
+			written += literalLength;
+			// the last sequence has no match
+			if (in == end) {
+				break;
+			}
+			if (end - in < 2) {
+				return false;
+			}
+			size_t offset = in[0] | ((size_t)in[1] << 8);
+			in += 2;
+			size_t matchLength = token & 15;
+			if (matchLength == 15 && !readLength(in, end, matchLength)) {
+				return false;
+			}
+			matchLength += MIN_MATCH;
+			if (offset == 0 || offset > written || matchLength > targetSize - written) {
+				return false;
+			}
+			// a match may overlap its own output (runs have offsets smaller than their length), copied in pieces of
+			// offset bytes every piece reads bytes that are already written
+			unsigned char* out = target + written;
+			const unsigned char* match = out - offset;
+			for (size_t copied = 0; copied < matchLength;) {
+				size_t piece = std::min(offset, matchLength - copied);
+				memcpy(out + copied, match + copied, piece);
+				copied += piece;
+			}
+			written += matchLength;
+		}
+		return written == targetSize;
+	}
+}
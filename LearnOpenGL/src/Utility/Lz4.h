@@ -0,0 +1,23 @@
+#ifndef LZ4_H
+#define LZ4_H
+
+#include <cstddef>
+
+// the LZ4 block format (no frame header or checksums), compatible with the reference implementation's
+// LZ4_compress_default / LZ4_decompress_safe. greedy matching over a hash of 4 byte sequences: a few hundred MB/s
+// compressing and GB/s decompressing, for data that is written once and read on every start
+namespace Lz4 {
+
+	// largest compressed size of size bytes, incompressible data grows a little
+	size_t getBound(size_t size);
+
+	// compresses size bytes into target, which must hold getBound(size). returns the compressed size
+	size_t compress(const unsigned char* source, size_t size, unsigned char* target, size_t capacity);
+
+	// decompresses a block that must expand to exactly targetSize bytes. false on corrupt or truncated input,
+	// never reads or writes out of bounds
+	bool decompress(const unsigned char* source, size_t size, unsigned char* target, size_t targetSize);
+
+}
+
+#endif // LZ4_H
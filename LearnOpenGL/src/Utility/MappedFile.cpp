@@ -0,0 +1,118 @@
+#include <iostream>
+
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// constructor
+#if defined(_WIN32)
+MappedFile::MappedFile() : bytes(NULL), length(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(NULL) {}
+#else
+MappedFile::MappedFile() : bytes(NULL), length(0), descriptor(-1) {}
+#endif
+
+// destructor
+MappedFile::~MappedFile() {
+	close();
+}
+
+// maps the file, sequential tells the OS to read ahead aggressively
+bool MappedFile::open(const char* path, bool sequential) {
+	close();
+#if defined(_WIN32)
+	DWORD flags = sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL;
+	fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, flags, NULL);
+	if (fileHandle == INVALID_HANDLE_VALUE) {
+		std::cout << "ERROR::MAPPED_FILE::OPEN_FAILED " << path << std::endl;
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(fileHandle, &fileSize);
+	length = (size_t)fileSize.QuadPart;
+	if (length == 0) {
+		return true;
+	}
+	mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mappingHandle != NULL) {
+		bytes = (const unsigned char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	}
+#else
+	descriptor = ::open(path, O_RDONLY);
+	if (descriptor < 0) {
+		std::cout << "ERROR::MAPPED_FILE::OPEN_FAILED " << path << std::endl;
+		return false;
+	}
+	struct stat status;
+	fstat(descriptor, &status);
+	length = (size_t)status.st_size;
+	if (length == 0) {
+		return true;
+	}
+	void* mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+	if (mapping != MAP_FAILED) {
+		bytes = (const unsigned char*)mapping;
+		if (sequential) {
+			// the advice values are not flags, read ahead and start reading right away are two calls
+			madvise(mapping, length, MADV_SEQUENTIAL);
+			madvise(mapping, length, MADV_WILLNEED);
+		}
+	}
+#endif
+	if (bytes == NULL) {
+		std::cout << "ERROR::MAPPED_FILE::MAP_FAILED " << path << std::endl;
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close() {
+#if defined(_WIN32)
+	if (bytes != NULL) {
+		UnmapViewOfFile(bytes);
+	}
+	if (mappingHandle != NULL) {
+		CloseHandle(mappingHandle);
+	}
+	if (fileHandle != INVALID_HANDLE_VALUE) {
+		CloseHandle(fileHandle);
+	}
+	mappingHandle = NULL;
+	fileHandle = INVALID_HANDLE_VALUE;
+#else
+	if (bytes != NULL) {
+		munmap((void*)bytes, length);
+	}
+	if (descriptor >= 0) {
+		::close(descriptor);
+	}
+	descriptor = -1;
+#endif
+	bytes = NULL;
+	length = 0;
+}
+
+const unsigned char* MappedFile::data() const {
+	return bytes;
+}
+
+size_t MappedFile::size() const {
+	return length;
+}
+
+bool MappedFile::isOpen() const {
+#if defined(_WIN32)
+	return fileHandle != INVALID_HANDLE_VALUE;
+#else
+	return descriptor >= 0;
+#endif
+}
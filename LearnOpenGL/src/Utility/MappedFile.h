@@ -0,0 +1,40 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+
+// read only memory mapping of a whole file, pages are read in by the OS as they are touched
+// so a file can be handed to the GPU (or parsed) without first copying it onto the heap
+class MappedFile {
+private:
+	const unsigned char* bytes;
+	size_t length;
+#if defined(_WIN32)
+	void* fileHandle;
+	void* mappingHandle;
+#else
+	int descriptor;
+#endif
+
+public:
+	// constructor
+	MappedFile();
+
+	// destructor
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// maps the file, sequential tells the OS to read ahead aggressively. returns false if it can not be opened,
+	// empty files open successfully with a NULL data pointer
+	bool open(const char* path, bool sequential = true);
+	void close();
+
+	// getters
+	const unsigned char* data() const;
+	size_t size() const;
+	bool isOpen() const;
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,130 @@
+#include <atomic>
+#include <algorithm>
+
+#include "ThreadPool.h"
+
+// constructor
+ThreadPool::ThreadPool(unsigned int threadCount) : pending(0), stopping(false) {
+	if (threadCount == 0) {
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	// the caller is the first thread
+	workers.reserve(threadCount - 1);
+	for (unsigned int i = 1; i < threadCount; i++) {
+		workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+}
+
+// destructor
+ThreadPool::~ThreadPool() {
+	wait();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	jobAvailable.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+void ThreadPool::workerLoop() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		jobAvailable.wait(lock, [this]() { return stopping || !jobs.empty(); });
+		if (jobs.empty()) {
+			return;
+		}
+		runOne(lock);
+	}
+}
+
+bool ThreadPool::runOne(std::unique_lock<std::mutex>& lock) {
+	if (jobs.empty()) {
+		return false;
+	}
+	std::function<void()> job = std::move(jobs.front());
+	jobs.pop_front();
+	lock.unlock();
+	job();
+	lock.lock();
+	if (--pending == 0) {
+		jobsFinished.notify_all();
+	}
+	return true;
+}
+
+void ThreadPool::submit(std::function<void()> job) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(std::move(job));
+		pending++;
+	}
+	jobAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (pending > 0) {
+		if (!runOne(lock)) {
+			jobsFinished.wait(lock, [this]() { return pending == 0 || !jobs.empty(); });
+		}
+	}
+}
+
+// every participant pulls task numbers from a shared counter, so uneven tasks still balance out
+void ThreadPool::run(size_t taskCount, const std::function<void(size_t task)>& job) {
+	if (taskCount == 0) {
+		return;
+	}
+	std::atomic<size_t> nextTask(0);
+	auto drain = [&]() {
+		size_t task;
+		while ((task = nextTask.fetch_add(1)) < taskCount) {
+			job(task);
+		}
+	};
+	size_t helpers = std::min<size_t>(workers.size(), taskCount - 1);
+	std::mutex doneMutex;
+	std::condition_variable done;
+	size_t helpersRunning = helpers;
+	for (size_t i = 0; i < helpers; i++) {
+		submit([&]() {
+			drain();
+			std::lock_guard<std::mutex> lock(doneMutex);
+			if (--helpersRunning == 0) {
+				done.notify_all();
+			}
+		});
+	}
+	drain();
+	// the helpers reference locals of this frame, so wait for all of them to return, not just for the tasks.
+	// helpers that have not started yet are run here instead of waiting for a free worker
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		{
+			std::lock_guard<std::mutex> doneLock(doneMutex);
+			if (helpersRunning == 0) {
+				break;
+			}
+		}
+		if (!runOne(lock)) {
+			lock.unlock();
+			{
+				std::unique_lock<std::mutex> doneLock(doneMutex);
+				done.wait(doneLock, [&]() { return helpersRunning == 0; });
+			}
+			lock.lock();
+		}
+	}
+}
+
+unsigned int ThreadPool::concurrency() const {
+	return (unsigned int)workers.size() + 1;
+}
+
+ThreadPool& ThreadPool::shared() {
+	// at least one worker, submitted jobs have to run even while nobody waits for them
+	static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 2u));
+	return pool;
+}
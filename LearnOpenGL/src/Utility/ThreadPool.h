@@ -0,0 +1,56 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// fixed set of worker threads pulling jobs from one queue. the calling thread helps out while it waits,
+// so a pool with a single thread (or none at all) still makes progress
+class ThreadPool {
+private:
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> jobs;
+	std::mutex mutex;
+	// signalled when a job is queued or the pool shuts down
+	std::condition_variable jobAvailable;
+	// signalled whenever the last pending job finished
+	std::condition_variable jobsFinished;
+	// queued plus currently running jobs
+	size_t pending;
+	bool stopping;
+
+	void workerLoop();
+	// pops and runs one job, false if the queue was empty
+	bool runOne(std::unique_lock<std::mutex>& lock);
+
+public:
+	// constructor, threadCount includes the calling thread so ThreadPool(1) runs everything on the caller.
+	// 0 means one per hardware thread
+	explicit ThreadPool(unsigned int threadCount = 0);
+
+	// destructor, finishes the queued jobs first
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// without worker threads the job only runs inside wait() or run()
+	void submit(std::function<void()> job);
+	// blocks until every submitted job ran, running jobs on the calling thread meanwhile
+	void wait();
+
+	// calls job(0) ... job(taskCount - 1) spread over the pool and the calling thread, returns once all of them ran
+	void run(size_t taskCount, const std::function<void(size_t task)>& job);
+
+	// worker threads plus the calling thread
+	unsigned int concurrency() const;
+
+	// pool shared by everything that does not need its own, created on first use with at least one worker
+	static ThreadPool& shared();
+};
+
+#endif // THREAD_POOL_H
@@ -1,12 +1,15 @@
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
 
 #include "Utility.h"
+#include "../Window/Window.h"
 
 namespace Utility {
 	
 	void increaseTextureDiff(GLFWwindow* window, float* diff) {
 
-		if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) {
+		if (Window::isKeyPressed(window, GLFW_KEY_UP)) {
 			if (*diff >= 1.0f) {
 				*diff = 1.0f;
 				std::cout << "Can not go over 1.0 for mixing textures!" << std::endl;
@@ -15,7 +18,7 @@ namespace Utility {
 				*diff += 0.001f;
 			}
 		}
-		else if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) {
+		else if (Window::isKeyPressed(window, GLFW_KEY_DOWN)) {
 			if (*diff <= 0.0f) {
 				*diff = 0.0f;
 				std::cout << "Can not go under 0.0 for mixing textures!" << std::endl;
@@ -27,4 +30,51 @@ namespace Utility {
 		return;
 	}
 
-}
\ No newline at end of file
+	// returns true if the flag was passed on the command line
+	bool hasArgument(int argc, char* argv[], const char* name) {
+		for (int i = 1; i < argc; i++) {
+			if (std::strcmp(argv[i], name) == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// returns the integer following the flag, e.g. "--frames 600"
+	int getIntArgument(int argc, char* argv[], const char* name, int fallback) {
+		const char* value = getStringArgument(argc, argv, name, NULL);
+		return value ? std::atoi(value) : fallback;
+	}
+
+	// returns the string following the flag, e.g. "--output frame.ppm"
+	const char* getStringArgument(int argc, char* argv[], const char* name, const char* fallback) {
+		for (int i = 1; i < argc - 1; i++) {
+			if (std::strcmp(argv[i], name) == 0) {
+				return argv[i + 1];
+			}
+		}
+		return fallback;
+	}
+
+	// the pieces between separators, empty ones dropped, e.g. for "--atlas a.png,b.png"
+	std::vector<std::string> splitString(const char* text, char separator) {
+		std::vector<std::string> pieces;
+		std::string piece;
+		for (const char* c = text; *c; c++) {
+			if (*c == separator) {
+				if (!piece.empty()) {
+					pieces.push_back(piece);
+				}
+				piece.clear();
+			}
+			else {
+				piece += *c;
+			}
+		}
+		if (!piece.empty()) {
+			pieces.push_back(piece);
+		}
+		return pieces;
+	}
+
+}
@@ -1,12 +1,22 @@
 #ifndef UTILITY_H
 #define UTILITY_H
 
+#include <string>
+#include <vector>
+
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
 namespace Utility {
 
 	void increaseTextureDiff(GLFWwindow* window, float* diff);
+
+	// command line helpers
+	bool hasArgument(int argc, char* argv[], const char* name);
+	int getIntArgument(int argc, char* argv[], const char* name, int fallback);
+	const char* getStringArgument(int argc, char* argv[], const char* name, const char* fallback);
+	// the pieces between separators, empty ones dropped, e.g. for "--atlas a.png,b.png"
+	std::vector<std::string> splitString(const char* text, char separator);
 	
 }
 
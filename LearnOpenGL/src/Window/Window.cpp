@@ -1,25 +1,53 @@
 #include <iostream>
 
 #include "Window.h"
+#include "../Utility/GLExtensions.h"
+
+#if defined(__linux__)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
 
 namespace Window {
 
+#if defined(__linux__)
+	// EGL handles for the headless context
+	static EGLDisplay headlessDisplay = EGL_NO_DISPLAY;
+	static EGLContext headlessContext = EGL_NO_CONTEXT;
+#else
+	// hidden glfw window that owns the headless context
+	static GLFWwindow* headlessWindow = NULL;
+#endif
+
 	// window size should change when user resizes the screen
 	void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+		(void)window;
 		glViewport(0, 0, width, height);
 		return;
 	}
 
 	// if the escape key has been pressed, close the glfw window
 	void processInput(GLFWwindow* window) {
+#ifdef WINDOW_NO_GLFW
+		(void)window;
+#else
 		if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
 			glfwSetWindowShouldClose(window, true);
 		}
+#endif
 		return;
 	}
 
 	// Initializes glfw window
 	GLFWwindow* initializeWindow(int width, int height, const char* title, int version) {
+#ifdef WINDOW_NO_GLFW
+		(void)width;
+		(void)height;
+		(void)title;
+		(void)version;
+		std::cout << "ERROR: Built without GLFW, only --headless is available!" << std::endl;
+		return NULL;
+#else
 		// glfw configuration, uses OpenGL version 3 and set profile to core
 		glfwInit();
 		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, version);
@@ -40,6 +68,163 @@ namespace Window {
 		if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
 			std::cout << "ERROR: Failed to initialize GLAD!" << std::endl;
 		}
+		else {
+			GLExtensions::initialize((GLADloadproc)glfwGetProcAddress);
+		}
 		return window;
+#endif
+	}
+
+	bool shouldClose(GLFWwindow* window) {
+#ifdef WINDOW_NO_GLFW
+		(void)window;
+		return true;
+#else
+		return glfwWindowShouldClose(window) != 0;
+#endif
+	}
+
+	bool isKeyPressed(GLFWwindow* window, int key) {
+#ifdef WINDOW_NO_GLFW
+		(void)window;
+		(void)key;
+		return false;
+#else
+		return glfwGetKey(window, key) == GLFW_PRESS;
+#endif
+	}
+
+	void getFramebufferSize(GLFWwindow* window, int* width, int* height) {
+#ifdef WINDOW_NO_GLFW
+		// there is no framebuffer, callers still read the size
+		(void)window;
+		*width = 0;
+		*height = 0;
+#else
+		glfwGetFramebufferSize(window, width, height);
+#endif
+		return;
+	}
+
+	void swapBuffers(GLFWwindow* window) {
+#ifdef WINDOW_NO_GLFW
+		(void)window;
+#else
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+#endif
+		return;
+	}
+
+	void terminateWindow() {
+#ifndef WINDOW_NO_GLFW
+		glfwTerminate();
+#endif
+		return;
+	}
+
+	// Initializes an OpenGL context that has no visible window
+	bool initializeHeadless(int width, int height, int version) {
+#if defined(__linux__)
+		// prefer Mesa's surfaceless platform so no X11/Wayland display is needed at all
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+			(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (getPlatformDisplay) {
+			headlessDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+		}
+		if (headlessDisplay == EGL_NO_DISPLAY) {
+			headlessDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		}
+		EGLint eglMajor, eglMinor;
+		if (headlessDisplay == EGL_NO_DISPLAY || !eglInitialize(headlessDisplay, &eglMajor, &eglMinor)) {
+			std::cout << "ERROR: Failed to initialize the EGL display!" << std::endl;
+			return false;
+		}
+		eglBindAPI(EGL_OPENGL_API);
+
+		// the context never presents anything, so any OpenGL capable config will do
+		// (the default surface type is EGL_WINDOW_BIT, which surfaceless displays never offer)
+		const EGLint configAttribs[] = {
+			EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+			EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+			EGL_NONE
+		};
+		EGLConfig config = (EGLConfig)0;
+		EGLint numConfigs = 0;
+		if (!eglChooseConfig(headlessDisplay, configAttribs, &config, 1, &numConfigs) || numConfigs == 0) {
+			// EGL_KHR_no_config_context lets us create the context without any config
+			config = (EGLConfig)0;
+		}
+
+		// same version and core profile as the windowed context
+		const EGLint contextAttribs[] = {
+			EGL_CONTEXT_MAJOR_VERSION, version,
+			EGL_CONTEXT_MINOR_VERSION, version,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE
+		};
+		headlessContext = eglCreateContext(headlessDisplay, config, EGL_NO_CONTEXT, contextAttribs);
+		if (headlessContext == EGL_NO_CONTEXT) {
+			std::cout << "ERROR: Failed to create the EGL context!" << std::endl;
+			terminateHeadless();
+			return false;
+		}
+		// bind without a surface, everything is drawn into framebuffer objects
+		if (!eglMakeCurrent(headlessDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, headlessContext)) {
+			std::cout << "ERROR: EGL surfaceless contexts are not supported!" << std::endl;
+			terminateHeadless();
+			return false;
+		}
+		if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+			std::cout << "ERROR: Failed to initialize GLAD!" << std::endl;
+			terminateHeadless();
+			return false;
+		}
+		GLExtensions::initialize((GLADloadproc)eglGetProcAddress);
+#else
+		// other platforms fall back to an invisible glfw window
+		glfwInit();
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, version);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, version);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		headlessWindow = glfwCreateWindow(width, height, "LearnOpenGL (headless)", NULL, NULL);
+		if (headlessWindow == NULL) {
+			std::cout << "ERROR: Failed to create the hidden GLFW window!" << std::endl;
+			glfwTerminate();
+			return false;
+		}
+		glfwMakeContextCurrent(headlessWindow);
+		if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+			std::cout << "ERROR: Failed to initialize GLAD!" << std::endl;
+			terminateHeadless();
+			return false;
+		}
+		GLExtensions::initialize((GLADloadproc)glfwGetProcAddress);
+#endif
+		glViewport(0, 0, width, height);
+		return true;
+	}
+
+	// Destroys the headless context
+	void terminateHeadless() {
+#if defined(__linux__)
+		if (headlessDisplay != EGL_NO_DISPLAY) {
+			eglMakeCurrent(headlessDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+			if (headlessContext != EGL_NO_CONTEXT) {
+				eglDestroyContext(headlessDisplay, headlessContext);
+			}
+			eglTerminate(headlessDisplay);
+		}
+		headlessDisplay = EGL_NO_DISPLAY;
+		headlessContext = EGL_NO_CONTEXT;
+#else
+		if (headlessWindow != NULL) {
+			glfwDestroyWindow(headlessWindow);
+			headlessWindow = NULL;
+		}
+		glfwTerminate();
+#endif
+		return;
 	}
-}
\ No newline at end of file
+}
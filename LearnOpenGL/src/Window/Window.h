@@ -4,6 +4,8 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+// builds without GLFW (WINDOW_NO_GLFW, set by the CMake build when it can not find the library) only have the
+// headless context, initializeWindow() fails and the other window functions do nothing
 namespace Window {
 
 	// window size should change when user resizes the screen
@@ -15,6 +17,21 @@ namespace Window {
 	// Initializes glfw window
 	GLFWwindow* initializeWindow(int width, int height, const char* title, int version);
 
+	// thin wrappers so the render loop does not call glfw directly
+	bool shouldClose(GLFWwindow* window);
+	bool isKeyPressed(GLFWwindow* window, int key);
+	void getFramebufferSize(GLFWwindow* window, int* width, int* height);
+	// presents the frame and handles the window events
+	void swapBuffers(GLFWwindow* window);
+	// Destroys the window and terminates glfw
+	void terminateWindow();
+
+	// Initializes an OpenGL context that has no visible window (EGL surfaceless on Linux)
+	bool initializeHeadless(int width, int height, int version);
+
+	// Destroys the headless context
+	void terminateHeadless();
+
 }
 
 #endif // INIT_H
@@ -0,0 +1,30 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <iostream>
+#include <string>
+
+// the checks every test in this directory is built from: failed ones are printed and counted, report() turns the
+// count into the exit code ctest reads
+namespace Test {
+
+	inline int failures = 0;
+
+	inline void check(bool condition, const std::string& what) {
+		if (!condition) {
+			std::cout << "FAILED: " << what << std::endl;
+			failures++;
+		}
+	}
+
+	// the exit code of the test
+	inline int report(const char* name) {
+		if (failures == 0) {
+			std::cout << name << " passed" << std::endl;
+		}
+		return failures == 0 ? 0 : 1;
+	}
+
+}
+
+#endif // CHECK_H
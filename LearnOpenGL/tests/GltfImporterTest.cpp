@@ -0,0 +1,79 @@
+#include <fstream>
+#include <string>
+#include <filesystem>
+#include <cstdio>
+
+#include "Mesh/GltfImporter.h"
+#include "Check.h"
+
+// buffer view strides that would divide by zero or overlap elements, and indices or counts that are negative,
+// fractional or out of range, are refused instead of crashing the import
+
+// one triangle, three float positions in a data: URI buffer. the view, accessor and scene parts can be replaced
+static bool importDocument(const std::string& view, const std::string& accessor, const std::string& scene, Mesh& mesh) {
+	std::string document =
+		"{ \"asset\": { \"version\": \"2.0\" },\n"
+		"  \"buffers\": [ { \"byteLength\": 36, \"uri\": \"data:application/octet-stream;base64,AAAAAAAAAAAAAAAAAACAPwAAAAAAAAAAAAAAAAAAgD8AAAAA\" } ],\n"
+		"  \"bufferViews\": [ " + view + " ],\n"
+		"  \"accessors\": [ " + accessor + " ],\n"
+		"  \"meshes\": [ { \"primitives\": [ { \"attributes\": { \"POSITION\": 0 } } ] } ]" + scene + " }\n";
+	std::string path = (std::filesystem::temp_directory_path() / "GltfImporterTest.gltf").string();
+	std::ofstream(path) << document;
+	bool loaded = GltfImporter::load(path.c_str(), mesh);
+	std::remove(path.c_str());
+	return loaded;
+}
+
+static const char* VIEW = "{ \"buffer\": 0, \"byteLength\": 36 }";
+static const char* ACCESSOR = "{ \"bufferView\": 0, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\" }";
+
+// byteStride left out when it is negative
+static bool importTriangle(int byteStride, Mesh& mesh) {
+	std::string view = "{ \"buffer\": 0, \"byteLength\": 36";
+	if (byteStride >= 0) {
+		view += ", \"byteStride\": " + std::to_string(byteStride);
+	}
+	view += " }";
+	return importDocument(view, ACCESSOR, "", mesh);
+}
+
+static bool importAccessor(const std::string& accessor) {
+	Mesh mesh;
+	return importDocument(VIEW, accessor, "", mesh);
+}
+
+static bool importScene(const std::string& scene) {
+	Mesh mesh;
+	return importDocument(VIEW, ACCESSOR, scene, mesh);
+}
+
+int main() {
+	{
+		Mesh mesh;
+		Test::check(importTriangle(-1, mesh), "tightly packed view without byteStride");
+		Test::check(mesh.vertices.size() == 3 && mesh.indices.size() == 3, "triangle imported");
+	}
+	{
+		Mesh mesh;
+		Test::check(importTriangle(12, mesh), "byteStride equal to the element size");
+	}
+	{
+		Mesh mesh;
+		Test::check(!importTriangle(0, mesh), "byteStride 0 is rejected");
+	}
+	{
+		Mesh mesh;
+		Test::check(!importTriangle(4, mesh), "byteStride shorter than an element is rejected");
+	}
+	Test::check(!importAccessor("{ \"bufferView\": 0, \"componentType\": 5126, \"count\": -3, \"type\": \"VEC3\" }"), "negative count is rejected");
+	Test::check(!importAccessor("{ \"bufferView\": 0, \"componentType\": 5126, \"count\": 1e300, \"type\": \"VEC3\" }"), "count beyond size_t is rejected");
+	Test::check(!importAccessor("{ \"bufferView\": 0, \"componentType\": 5126, \"count\": 3, \"byteOffset\": 0.5, \"type\": \"VEC3\" }"), "fractional byteOffset is rejected");
+	Test::check(!importAccessor("{ \"bufferView\": 0.5, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\" }"), "fractional bufferView is rejected");
+	Test::check(!importAccessor("{ \"bufferView\": 0, \"componentType\": 4294972422, \"count\": 3, \"type\": \"VEC3\" }"), "componentType beyond 32 bits is rejected");
+	Test::check(importScene(", \"nodes\": [ { \"mesh\": 0 } ], \"scenes\": [ { \"nodes\": [ 0 ] } ]"), "scene with one node");
+	Test::check(!importScene(", \"nodes\": [ { \"mesh\": 0 } ], \"scenes\": [ { \"nodes\": [ -1 ] } ]"), "negative scene node is rejected");
+	Test::check(!importScene(", \"nodes\": [ { \"mesh\": 0, \"children\": [ 0.5 ] } ], \"scenes\": [ { \"nodes\": [ 0 ] } ]"), "fractional child is rejected");
+	Test::check(!importScene(", \"nodes\": [ { \"mesh\": -1 } ], \"scenes\": [ { \"nodes\": [ 0 ] } ]"), "negative mesh is rejected");
+	Test::check(!importScene(", \"nodes\": [ { \"mesh\": 0 } ], \"scene\": -1, \"scenes\": [ { \"nodes\": [ 0 ] } ]"), "negative scene is rejected");
+	return Test::report("GltfImporterTest");
+}
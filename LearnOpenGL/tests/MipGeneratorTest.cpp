@@ -0,0 +1,60 @@
+#include <string>
+#include <cstdlib>
+
+#include "Texture/MipGenerator.h"
+#include "Check.h"
+
+// the colour space of the request decides how colour is averaged, and transparent texels lend their neighbours no colour
+
+// a 2x1 image of two texels, the generated 1x1 level is their average
+static const unsigned char* averageOf(TextureData& data, GLenum format, int channels, const unsigned char* texels,
+	const MipGenerator::Options& options) {
+	data.width = 2;
+	data.height = 1;
+	data.format = format;
+	data.internalFormat = channels == 4 ? GL_RGBA8 : GL_RGB8;
+	data.compressed = false;
+	data.bytes.assign(texels, texels + 2 * channels);
+	data.levels.assign(1, TextureLevel{ 0, (size_t)(2 * channels), 2, 1 });
+	if (!MipGenerator::generate(data, options) || data.levels.size() != 2) {
+		return NULL;
+	}
+	return data.bytes.data() + data.levels[1].offset;
+}
+
+static bool near(int value, int expected) {
+	return std::abs(value - expected) <= 1;
+}
+
+int main() {
+	MipGenerator::Options options;
+	options.filter = MipGenerator::FILTER_BOX;
+	{
+		// black and white average to mid grey as stored values, and to 188 when they are sRGB encoded light
+		const unsigned char texels[] = { 0, 0, 0, 255, 255, 255 };
+		TextureData data;
+		const unsigned char* linear = averageOf(data, GL_RGB, 3, texels, options);
+		Test::check(linear != NULL && near(linear[0], 128), "linear data is averaged as stored");
+		MipGenerator::Options srgbOptions = options;
+		srgbOptions.colorSpace = COLOR_SPACE_SRGB;
+		TextureData srgbData;
+		const unsigned char* srgb = averageOf(srgbData, GL_RGB, 3, texels, srgbOptions);
+		Test::check(srgb != NULL && near(srgb[0], 188), "sRGB colour is averaged in linear light");
+	}
+	{
+		// an opaque red texel next to a transparent green one keeps its colour at half coverage
+		const unsigned char texels[] = { 255, 0, 0, 255, 0, 255, 0, 0 };
+		TextureData data;
+		const unsigned char* cutout = averageOf(data, GL_RGBA, 4, texels, options);
+		Test::check(cutout != NULL && cutout[0] == 255 && cutout[1] == 0 && cutout[2] == 0, "transparent texels add no colour");
+		Test::check(cutout != NULL && near(cutout[3], 128), "alpha is averaged");
+		// already premultiplied data is filtered as it is
+		MipGenerator::Options premultipliedOptions = options;
+		premultipliedOptions.premultiplied = true;
+		const unsigned char premultipliedTexels[] = { 255, 0, 0, 255, 0, 0, 0, 0 };
+		TextureData premultipliedData;
+		const unsigned char* premultiplied = averageOf(premultipliedData, GL_RGBA, 4, premultipliedTexels, premultipliedOptions);
+		Test::check(premultiplied != NULL && near(premultiplied[0], 128) && near(premultiplied[3], 128), "premultiplied data stays premultiplied");
+	}
+	return Test::report("MipGeneratorTest");
+}
@@ -0,0 +1,71 @@
+#include <string>
+
+#include "Window/Window.h"
+#include "ShaderManager/Shader.h"
+#include "Check.h"
+
+// the uniform table of Shader against the driver's own glGetUniformLocation, and hash collisions being refused
+
+static const char* vertexCode =
+	"#version 330 core\n"
+	"layout (location = 0) in vec3 aPos;\n"
+	"uniform mat4 transforms[2];\n"
+	"uniform float scale;\n"
+	"void main() {\n"
+	"	gl_Position = transforms[0] * transforms[1] * vec4(aPos * scale, 1.0);\n"
+	"}\n";
+
+static const char* fragmentCode =
+	"#version 330 core\n"
+	"uniform vec4 colors[3];\n"
+	"uniform struct Light { vec3 direction; float intensities[2]; } light;\n"
+	"out vec4 FragColor;\n"
+	"void main() {\n"
+	"	FragColor = colors[0] + colors[1] + colors[2] + vec4(light.direction * (light.intensities[0] + light.intensities[1]), 0.0);\n"
+	"}\n";
+
+// "uhcxtwv" and "uwuofah" have the same 32 bit FNV-1a hash
+static const char* collidingFragmentCode =
+	"#version 330 core\n"
+	"uniform float uhcxtwv;\n"
+	"uniform float uwuofah;\n"
+	"out vec4 FragColor;\n"
+	"void main() {\n"
+	"	FragColor = vec4(uhcxtwv, uwuofah, 0.0, 1.0);\n"
+	"}\n";
+
+int main() {
+	if (!Window::initializeHeadless(64, 64, 3)) {
+		return 1;
+	}
+	{
+		Shader shader(Shader::compileProgram(vertexCode, fragmentCode));
+		Test::check(shader.getID() != 0, "program links");
+		const char* names[] = {
+			"scale",
+			"transforms", "transforms[0]", "transforms[1]",
+			"colors", "colors[0]", "colors[1]", "colors[2]",
+			"light.direction", "light.intensities", "light.intensities[0]", "light.intensities[1]"
+		};
+		for (const char* name : names) {
+			int expected = glGetUniformLocation(shader.getID(), name);
+			Test::check(expected >= 0, std::string("driver has ") + name);
+			Test::check(shader.getUniformLocation(UniformId(name)) == expected, std::string("location of ") + name);
+		}
+		Test::check(shader.getUniformLocation(UniformId("colors[3]")) == -1, "element past the end of an array");
+		Test::check(shader.getUniformLocation(UniformId("missing")) == -1, "unknown uniform");
+
+		// a value set through an element's id lands in that element
+		shader.use();
+		shader.setFloat(UniformId("light.intensities[1]"), 0.75f);
+		float value = 0.0f;
+		glGetUniformfv(shader.getID(), glGetUniformLocation(shader.getID(), "light.intensities[1]"), &value);
+		Test::check(value == 0.75f, "setFloat on an array element");
+	}
+	{
+		Shader colliding(Shader::compileProgram(vertexCode, collidingFragmentCode));
+		Test::check(colliding.getID() == 0, "colliding uniform names are rejected");
+	}
+	Window::terminateHeadless();
+	return Test::report("UniformTableTest");
+}
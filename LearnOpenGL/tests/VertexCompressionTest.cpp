@@ -0,0 +1,57 @@
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cmath>
+
+#include "Renderer/VertexCompression.h"
+#include "Check.h"
+
+// the compact vertex format keeps every attribute within its precision at the edges of its range, and the SIMD
+// encoder writes the same bytes as the scalar one
+
+static StandardVertex makeVertex(float x, float y, float z, float r, float g, float b, float u, float v) {
+	StandardVertex vertex = { { x, y, z }, { r, g, b }, { u, v } };
+	return vertex;
+}
+
+int main() {
+	// largest half, smallest normal half and half denormals (2^-24 is the smallest)
+	const float largest = 65504.0f;
+	const float smallestNormal = std::ldexp(1.0f, -14);
+	const float denormal = std::ldexp(1.0f, -20);
+	const float smallestDenormal = std::ldexp(1.0f, -24);
+	std::vector<StandardVertex> vertices = {
+		makeVertex(0.0f, -0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+		makeVertex(largest, -largest, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f),
+		makeVertex(smallestNormal, -smallestNormal, denormal, 0.5f, 0.25f, 1.0f, 0.0f, 1.0f),
+		makeVertex(-denormal, smallestDenormal, -smallestDenormal, 1.0f / 255.0f, 254.0f / 255.0f, 0.5f, 1.0f, 0.0f),
+		makeVertex(0.5f, -0.5f, 1024.0f, 0.1f, 0.9f, 0.3f, 0.5f, 1.0f / 65535.0f),
+	};
+	// fills the SIMD batches and leaves a tail the scalar loop finishes
+	for (int i = 0; i < 37; i++) {
+		float t = i / 36.0f;
+		vertices.push_back(makeVertex(std::sin(i * 1.7f) * 300.0f, std::cos(i * 0.3f) * 0.01f, (t - 0.5f) * 2.0f * largest,
+			t, 1.0f - t, std::fmod(t * 7.0f, 1.0f), t, std::fmod(t * 3.0f, 1.0f)));
+	}
+
+	VertexCompression::RoundTripError error;
+	Test::check(VertexCompression::checkRoundTrip(vertices.data(), vertices.size(), error),
+		"round trip within the format's precision (position " + std::to_string(error.position) + ", colour " +
+		std::to_string(error.color) + ", texture coordinate " + std::to_string(error.texCoord) + ")");
+
+	// padding bytes included, both start out zeroed
+	std::vector<CompactVertex> simd(vertices.size());
+	std::vector<CompactVertex> scalar(vertices.size());
+	std::memset(simd.data(), 0, simd.size() * sizeof(CompactVertex));
+	std::memset(scalar.data(), 0, scalar.size() * sizeof(CompactVertex));
+	VertexCompression::encodeVertices(vertices.data(), simd.data(), vertices.size());
+	VertexCompression::encodeVerticesScalar(vertices.data(), scalar.data(), vertices.size());
+	Test::check(std::memcmp(simd.data(), scalar.data(), simd.size() * sizeof(CompactVertex)) == 0,
+		std::string("encodeVertices (") + (VertexCompression::isSimd() ? "SSE2" : "scalar") + ") matches encodeVerticesScalar");
+
+	// the largest half survives unchanged, anything larger is out of range
+	Test::check(VertexCompression::halfToFloat(VertexCompression::floatToHalf(largest)) == largest, "65504 is exact");
+	Test::check(std::isinf(VertexCompression::halfToFloat(VertexCompression::floatToHalf(70000.0f))), "overflow becomes infinity");
+	Test::check(VertexCompression::halfToFloat(VertexCompression::floatToHalf(smallestDenormal)) == smallestDenormal, "smallest denormal is exact");
+	return Test::report("VertexCompressionTest");
+}